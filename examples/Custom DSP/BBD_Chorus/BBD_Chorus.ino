@@ -5,35 +5,9 @@ ESP32Synth synth;
 // ==============================================================================
 // 1. ENGINE "BBD CHORUS SUAVE"
 // ==============================================================================
-#define CHORUS_LEN 1024
-#define CHORUS_MASK 1023
-
-int32_t chorusTape[CHORUS_LEN] = {0};
-int cHead = 0;
-uint32_t lfoPhase = 0;
-
-void IRAM_ATTR chorusDSP(int32_t* mixBuffer, int numSamples) {
-    for (int i = 0; i < numSamples; i++) {
-        int32_t dry = mixBuffer[i];
-        
-        // 1. LFO TRIANGULAR LENTO (~1.5Hz)
-        lfoPhase += 2;
-        int32_t lfoTri = (lfoPhase & 0x7FFF);
-        if (lfoPhase & 0x8000) lfoTri = 32767 - lfoTri;
-        
-        // 2. ATRASO SUAVE (Entre 50 e 200 samples = ~1ms a ~4ms)
-        int delayOffset = 50 + ((lfoTri * 150) >> 15);
-        
-        int readHead = (cHead - delayOffset) & CHORUS_MASK;
-        int32_t wet = chorusTape[readHead];
-        
-        chorusTape[cHead] = dry;
-        cHead = (cHead + 1) & CHORUS_MASK;
-        
-        // Mixa 50% / 50% sem estourar o volume
-        mixBuffer[i] = (dry >> 1) + (wet >> 1);
-    }
-}
+// SynthChorus: duas vozes moduladas por canal, com leitura fracionária (sem os
+// degraus do atraso inteiro). Atraso entre ~1 ms e ~4 ms, LFO de ~1.5 Hz.
+SynthChorus chorus;
 
 // ==============================================================================
 // 2. GERADOR DE ACORDES
@@ -79,12 +53,19 @@ void setup() {
         synth.setEnv(i, 2000, 1000, 255, 3000); 
     }
 
-    synth.setCustomDSP(chorusDSP);
     synth.setCustomControl(dreamControl);
 
     // Ajuste seus pinos aqui! (BCLK, WS, DATA)
     if (synth.begin(4, 15, 2, I2S_32BIT)) {
         Serial.println("Dream Pads (Chorus Corrigido) Operantes.");
+
+        // Mixa 50% / 50% sem estourar o volume
+        if (chorus.begin(synth.getSampleRate())) {
+            chorus.setDelay(1000, 3000);
+            chorus.setRate(150);
+            chorus.setMix(128, 128);
+            synth.addEffect(&chorus);
+        }
     }
 }
 
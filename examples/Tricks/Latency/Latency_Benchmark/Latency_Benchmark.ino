@@ -0,0 +1,156 @@
+#include <Arduino.h>
+#include <ESP32Synth.h>
+
+// ====================================================================================
+// == LATENCY PROFILE BENCHMARK
+// ====================================================================================
+// For each latency profile (setLatencyProfile) this sketch prints:
+//   - the DMA queue latency, dmaLen * dmaCount / sampleRate (getLatencyUs)
+//   - the round-trip latency from noteOn() to the sound reaching an ADC pin
+//   - the maximum number of sine voices before the render task passes LOAD_LIMIT %
+//
+// Round-trip wiring: jumper the audio output into LOOPBACK_PIN (an ADC1 pin).
+//   - DAC mode (classic ESP32): GPIO25 -> GPIO34, nothing else needed.
+//   - I2S DAC boards (PCM5102 etc.): line out -> 10k -> GPIO34, 10k GPIO34 -> GND.
+// Without the jumper the round-trip column reads "no loopback" and the rest still runs.
+//
+// The round trip is measured from the noteOn() call to the first ADC reading that leaves
+// the noise floor, so it includes the time until the next render block starts, the DMA
+// queue and the ADC polling (~10 us per analogRead). Eight runs give min / avg / max.
+// Compare the measured voice counts with the expected latency to pick a profile; the
+// results depend on the chip, the clock, MAX_VOICES and the output mode.
+
+#define DAC_PIN      25
+#define I2S_BCLK     4
+#define I2S_LRCK     15
+#define I2S_DOUT     2
+#define LOOPBACK_PIN 34
+
+#define USE_DAC 0
+#define USE_I2S 1
+#define OUT_MODE USE_DAC
+// #define OUT_MODE USE_I2S
+
+#define LOAD_LIMIT   90.0f // % of the block budget
+#define TRIP_RUNS    8
+#define ADC_THRESH   200   // ADC counts above the idle level
+
+ESP32Synth synth;
+
+static const char* PROFILE_NAMES[] = { "PLAYBACK", "BALANCED", "LIVE" };
+
+bool startEngine() {
+#if OUT_MODE == USE_DAC
+    return synth.begin(DAC_PIN);
+#else
+    return synth.begin(I2S_BCLK, I2S_LRCK, I2S_DOUT);
+#endif
+}
+
+void silenceAll() {
+    for (int v = 0; v < MAX_VOICES; v++) synth.noteOff(v);
+    delay(100);
+}
+
+int idleLevel() {
+    int32_t sum = 0;
+    for (int i = 0; i < 64; i++) sum += analogRead(LOOPBACK_PIN);
+    return sum / 64;
+}
+
+// noteOn -> first ADC sample away from the idle level, in microseconds (0 = timed out)
+uint32_t measureRoundTrip(int idle) {
+    // 20 Hz square at full scale: the first half-period holds the output high for 25 ms.
+    synth.setWave(0, WAVE_PULSE);
+    synth.setEnv(0, 0, 0, 255, 0);
+
+    uint32_t t0 = micros();
+    synth.noteOn(0, 2000, 255);
+    uint32_t dt = 0;
+    while (micros() - t0 < 500000) {
+        if (abs(analogRead(LOOPBACK_PIN) - idle) > ADC_THRESH) {
+            dt = micros() - t0;
+            break;
+        }
+    }
+    synth.noteOff(0);
+    delay(150);
+    return dt;
+}
+
+// Adds sine voices four at a time until the render load passes LOAD_LIMIT.
+int measureMaxVoices() {
+    int voices = 0;
+    while (voices < MAX_VOICES) {
+        for (int k = 0; k < 4 && voices < MAX_VOICES; k++, voices++) {
+            synth.setWave(voices, WAVE_SINE);
+            synth.setEnv(voices, 0, 0, 255, 0);
+            synth.noteOn(voices, 11000 + voices * 700, 255 / (1 + MAX_VOICES / 16));
+        }
+        delay(300); // Let the load meter settle over several blocks
+
+        float peak = 0;
+        for (int i = 0; i < 10; i++) {
+            float load = synth.getCPULoad();
+            if (load > peak) peak = load;
+            delay(20);
+        }
+        if (peak > LOAD_LIMIT) {
+            voices -= 4;
+            break;
+        }
+    }
+    silenceAll();
+    return (voices < 0) ? 0 : voices;
+}
+
+void runProfile(SynthLatencyProfile profile) {
+    synth.end(); // Stopped, the new profile just waits for begin()
+    synth.setLatencyProfile(profile);
+    if (!startEngine()) {
+        Serial.println("ERROR: could not start the audio engine!");
+        while (1) delay(1000);
+    }
+    synth.setMasterVolume(255);
+    delay(300);
+
+    int idle = idleLevel();
+    uint32_t tripMin = 0xFFFFFFFF, tripMax = 0, tripSum = 0;
+    int hits = 0;
+    for (int i = 0; i < TRIP_RUNS; i++) {
+        uint32_t dt = measureRoundTrip(idle);
+        if (dt == 0) continue;
+        hits++;
+        tripSum += dt;
+        if (dt < tripMin) tripMin = dt;
+        if (dt > tripMax) tripMax = dt;
+    }
+
+    int maxVoices = measureMaxVoices();
+
+    Serial.printf("%-9s | %8.2f ms | ", PROFILE_NAMES[profile], synth.getLatencyUs() / 1000.0f);
+    if (hits) Serial.printf("%6.2f / %6.2f / %6.2f ms | ", tripMin / 1000.0f, tripSum / (1000.0f * hits), tripMax / 1000.0f);
+    else      Serial.printf("      no loopback      | ");
+    Serial.printf("%3d\n", maxVoices);
+}
+
+void setup() {
+    Serial.begin(115200);
+    delay(1000);
+
+    analogReadResolution(12);
+
+    Serial.println("\n--- ESP32Synth: Latency Profile Benchmark ---");
+    Serial.printf("Chip: %s | MAX_VOICES: %d\n", synth.getChipModel(), MAX_VOICES);
+    Serial.println("Profile   | DMA queue   | Round trip min / avg / max | Max voices");
+
+    runProfile(LATENCY_PLAYBACK);
+    runProfile(LATENCY_BALANCED);
+    runProfile(LATENCY_LIVE);
+
+    Serial.println("Done.");
+}
+
+void loop() {
+    delay(1000);
+}
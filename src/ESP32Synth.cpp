@@ -18,15 +18,34 @@ typedef uint32_t v4u32 __attribute__((vector_size(16)));
 // Shared sine LUT
 int16_t sineLUT[SINE_LUT_SIZE] __attribute__((aligned(16)));
 
+// Envelope curve LUT
+uint16_t envCurveLUT[ENV_CURVE_LUT_SIZE + 1];
+
+#if SYNTH_ENABLE_FILTER
+// Filter cutoff LUT
+uint32_t svfTanLUT[SVF_TAN_LUT_SIZE];
+#endif
+
 // Sample storage
 SampleData registeredSamples[MAX_SAMPLES];
 
 // --- Other Modules includes ---
+#include "ESP32Synth_Profiler.hpp"
+#include "ESP32Synth_DualCore.hpp"
 #include "ESP32Synth_Begins.hpp"
 #include "ESP32Synth_Core.hpp"
 #include "ESP32Synth_Core_Getters.hpp"
 #include "ESP32Synth_Renders.hpp"
+#include "ESP32Synth_Filter.hpp"
+#include "ESP32Synth_Master.hpp"
 #include "ESP32Synth_SDStream.hpp"
+#include "ESP32Synth_Commands.hpp"
+#include "ESP32Synth_Alloc.hpp"
+#include "ESP32Synth_Effects.hpp"
+#include "ESP32Synth_Buses.hpp"
+#include "ESP32Synth_DelayLine.hpp"
+#include "ESP32Synth_DelayFx.hpp"
+#include "ESP32Synth_Reverb.hpp"
 // -------------------------------
 
 // --- Constructor & Destructor ---
@@ -58,11 +77,22 @@ ESP32Synth::ESP32Synth() {
         wavetables[i].depth = BITS_8;
     }
 
+    for (int b = 1; b <= SYNTH_MAX_BUSES; b++) {
+        _buses[b].gain  = 256;
+        _buses[b].quiet = SYNTH_FX_TAIL_FOREVER; // Nothing to ring out yet
+    }
+
     controlRateHz = 100;
 }
 
 ESP32Synth::~ESP32Synth() {
     end();
+    if (_alloc)      { heap_caps_free(_alloc);      _alloc      = nullptr; }
+    if (_allocFree)  { heap_caps_free(_allocFree);  _allocFree  = nullptr; }
+    if (_cmdRing)    { heap_caps_free(_cmdRing);    _cmdRing    = nullptr; }
+    if (_cmdBatches) { heap_caps_free(_cmdBatches); _cmdBatches = nullptr; }
+    if (_fxScratch)  { heap_caps_free(_fxScratch);  _fxScratch  = nullptr; }
+    if (_busMix)     { heap_caps_free(_busMix);     _busMix     = nullptr; }
 }
 
 // --- Other Methods ---
@@ -113,6 +143,12 @@ void ESP32Synth::setCustomDSP(SynthDSPCallback dspFunc) {
     _customDSP = dspFunc;
 }
 
+#if SYNTH_ENABLE_STEREO
+void ESP32Synth::setCustomDSPStereo(SynthStereoDSPCallback dspFunc) {
+    _customDSPStereo = dspFunc;
+}
+#endif
+
 void ESP32Synth::setCustomControl(SynthControlCallback ctrlFunc) {
     _customControl = ctrlFunc;
 }
@@ -147,13 +183,13 @@ void ESP32Synth::audioTask(void* param) {
  * It continuously generates audio blocks and sends them to the configured output.
  */
 void ESP32Synth::renderLoop() {
-    int blockSamples = SYNTH_DMA_BUF_LEN;
+    int blockSamples = _dmaBufLen;
     if (_sampleRate <= 8000) {
-        blockSamples = SYNTH_DMA_BUF_LEN / 8;
+        blockSamples = _dmaBufLen / 8;
     } else if (_sampleRate <= 16000) {
-        blockSamples = SYNTH_DMA_BUF_LEN / 4;
+        blockSamples = _dmaBufLen / 4;
     } else if (_sampleRate <= 32000) {
-        blockSamples = SYNTH_DMA_BUF_LEN / 2;
+        blockSamples = _dmaBufLen / 2;
     }
 
     if (blockSamples < 16) blockSamples = 16;
@@ -162,15 +198,20 @@ void ESP32Synth::renderLoop() {
     // This prevents loops (v4i32) from writing outside memory if the user uses exotic buffers.
     blockSamples = (blockSamples + 3) & ~3;
 
-    int32_t* buf = (int32_t*)heap_caps_aligned_alloc(16, blockSamples * sizeof(int32_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
-    void* stereoBuf = heap_caps_aligned_alloc(16, blockSamples * 2 * sizeof(int32_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
-    int32_t* mixBuf = (int32_t*)heap_caps_aligned_alloc(16, blockSamples * sizeof(int32_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    // The block written to the driver is rendered in sub-blocks of this size. A multiple of
+    // 8 frames keeps every sub-block's mix and output 16-byte aligned for the SIMD kernels.
+    int subSamples = _renderBlock ? _renderBlock : blockSamples;
+    subSamples = (subSamples + 7) & ~7;
+    if (subSamples > blockSamples) subSamples = blockSamples;
 
-    if (!buf || !stereoBuf || !mixBuf) {
+    // One block buffer: voices mix into it as int32 and the master stage packs the output
+    // layout over it in place (see masterBlock). Only I2S 32-bit frames outgrow a mono mix;
+    // a stereo mix is already as wide as any output frame.
+    size_t frameBytes = (SYNTH_ENABLE_STEREO || (currentMode == SMODE_I2S && _i2sDepth == I2S_32BIT)) ? 2 * sizeof(int32_t) : sizeof(int32_t);
+    int32_t* blockBuf = (int32_t*)heap_caps_aligned_alloc(16, blockSamples * frameBytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+
+    if (!blockBuf) {
         _running = false;
-        if (buf) heap_caps_free(buf);
-        if (stereoBuf) heap_caps_free(stereoBuf);
-        if (mixBuf) heap_caps_free(mixBuf);
         audioTaskHandle = NULL;
         vTaskDelete(NULL);
         return;
@@ -180,12 +221,15 @@ void ESP32Synth::renderLoop() {
 
     if (currentMode == SMODE_PWM) {
         pwm_block_samples = blockSamples;
-        pwm_ping_pong_buf[0] = (int16_t*)heap_caps_aligned_alloc(16, blockSamples * sizeof(int16_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
-        pwm_ping_pong_buf[1] = (int16_t*)heap_caps_aligned_alloc(16, blockSamples * sizeof(int16_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        pwm_ping_pong_buf[0] = (uint16_t*)heap_caps_aligned_alloc(16, blockSamples * sizeof(uint16_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        pwm_ping_pong_buf[1] = (uint16_t*)heap_caps_aligned_alloc(16, blockSamples * sizeof(uint16_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
         pwm_active_buf = 0;
         pwm_read_idx = 0;
-        if (pwm_ping_pong_buf[0]) memset(pwm_ping_pong_buf[0], 0, blockSamples * sizeof(int16_t));
-        if (pwm_ping_pong_buf[1]) memset(pwm_ping_pong_buf[1], 0, blockSamples * sizeof(int16_t));
+        // Mid-scale duty (silence) until the first block lands
+        for (int b = 0; b < 2; b++) {
+            if (!pwm_ping_pong_buf[b]) continue;
+            for (int i = 0; i < blockSamples; i++) pwm_ping_pong_buf[b][i] = (32768 >> 6) << 4;
+        }
 
         // GPTimer completely deleted from here. We no longer initialize it; the LEDC ISR handles everything and calls itself!
         
@@ -195,10 +239,30 @@ void ESP32Synth::renderLoop() {
     uint32_t cpu_freq = SYNTH_GET_CPU_FREQ_MHZ() * 1000000;
     uint32_t max_cycles_per_block = (cpu_freq / _sampleRate) * blockSamples;
 
+    MasterFormat fmt = MASTER_MONO16;
+    if      (currentMode == SMODE_I2S) fmt = (_i2sDepth == I2S_32BIT) ? MASTER_STEREO32 : MASTER_STEREO16;
+    else if (currentMode == SMODE_DAC) fmt = MASTER_DAC8;
+    else if (currentMode == SMODE_PWM) fmt = MASTER_PWM10;
+    size_t outFrameBytes = masterFrameBytes(fmt);
+
     while (_running) {
+        // PWM packs straight into the ping-pong half the ISR has just finished playing.
+        void* out = blockBuf;
+        if (currentMode == SMODE_PWM) {
+            xSemaphoreTake(pwm_sema, portMAX_DELAY);
+            out = pwm_ping_pong_buf[1 - pwm_active_buf];
+            if (!_running || !out) break; // Woken by end()
+        }
+
         uint32_t start_cycles = esp_cpu_get_cycle_count();
 
-        render(buf, mixBuf, blockSamples);
+        // Sub-block k is mixed at the start of its own output range: the packed frames before
+        // it are never overwritten, and its mix still ends inside blockBuf (see masterPack).
+        for (int pos = 0; pos < blockSamples; pos += subSamples) {
+            int   n      = (blockSamples - pos < subSamples) ? blockSamples - pos : subSamples;
+            void* subOut = (uint8_t*)out + pos * outFrameBytes;
+            render(subOut, (out == blockBuf) ? (int32_t*)subOut : blockBuf, n, fmt);
+        }
 
         uint32_t end_cycles = esp_cpu_get_cycle_count();
         uint32_t used_cycles = end_cycles - start_cycles;
@@ -207,43 +271,17 @@ void ESP32Synth::renderLoop() {
 
         if (currentMode == SMODE_DAC) {
 #if defined(CONFIG_IDF_TARGET_ESP32) || defined(CONFIG_IDF_TARGET_ESP32S2)
-            int16_t* buf16 = (int16_t*)buf;
-            uint16_t* dacBuf = (uint16_t*)stereoBuf;
-            for (int i = 0; i < blockSamples; i++) {
-                uint32_t smp = (uint32_t)(buf16[i] + 32768) >> 8;
-                dacBuf[i] = (uint16_t)((smp << 8) | smp);
-            }
-            dac_continuous_write(dac_handle, (uint8_t*)dacBuf, blockSamples * 2, &written, portMAX_DELAY);
+            dac_continuous_write(dac_handle, (uint8_t*)blockBuf, blockSamples * 2, &written, portMAX_DELAY);
 #endif
         } else if (currentMode == SMODE_I2S) {
-            if (_i2sDepth == I2S_32BIT) {
-                uint64_t* out64 = (uint64_t*)stereoBuf;
-                for (int i = 0; i < blockSamples; i++) {
-                    uint64_t s = (uint32_t)buf[i];
-                    out64[i] = (s << 32) | s;
-                }
-                i2s_channel_write(tx_handle, stereoBuf, blockSamples * 2 * sizeof(int32_t), &written, portMAX_DELAY);
-            } else {
-                int16_t* buf16 = (int16_t*)buf;
-                uint32_t* out32 = (uint32_t*)stereoBuf;
-                for (int i = 0; i < blockSamples; i++) {
-                    uint32_t s = (uint16_t)buf16[i];
-                    out32[i] = (s << 16) | s;
-                }
-                i2s_channel_write(tx_handle, stereoBuf, blockSamples * 2 * sizeof(int16_t), &written, portMAX_DELAY);
-            }
-        } else if (currentMode == SMODE_PWM) {
-            xSemaphoreTake(pwm_sema, portMAX_DELAY);
-            int render_target = 1 - pwm_active_buf;
-            int16_t* buf16 = (int16_t*)buf;
-            memcpy(pwm_ping_pong_buf[render_target], buf16, blockSamples * sizeof(int16_t));
+            i2s_channel_write(tx_handle, blockBuf, blockSamples * outFrameBytes, &written, portMAX_DELAY);
 
         } else if (currentMode == SMODE_PDM) {
-            i2s_channel_write(tx_handle, buf, blockSamples * sizeof(int16_t), &written, portMAX_DELAY);
+            i2s_channel_write(tx_handle, blockBuf, blockSamples * sizeof(int16_t), &written, portMAX_DELAY);
 
         } else if (currentMode == SMODE_CUSTOM) {
             if (_customOutput) {
-                int16_t* buf16 = (int16_t*)buf;
+                int16_t* buf16 = (int16_t*)blockBuf;
                 _customOutput(buf16, blockSamples);
 
                 // SMART PACING: Prevents 100% CPU usage in case the user's callback does not block/yield.
@@ -258,90 +296,123 @@ void ESP32Synth::renderLoop() {
                 }
             }
         }
+
+        SYNTH_PROF_END_BLOCK(blockSamples);
     }
 
-    if (buf) heap_caps_free(buf);
-    if (stereoBuf) heap_caps_free(stereoBuf);
-    if (mixBuf) heap_caps_free(mixBuf);
+    heap_caps_free(blockBuf);
     audioTaskHandle = NULL;
     vTaskDelete(NULL);
 }
 
-// Core mixer
-void IRAM_ATTR ESP32Synth::render(void* buffer, int32_t* mixBuffer, int samples) {
-    // Zero the aligned buffer ensuring thread safety
-    memset(mixBuffer, 0, samples * sizeof(int32_t));
-
-    controlSampleCounter += (uint32_t)samples;
-    while (controlSampleCounter >= controlIntervalSamples) {
-        processControl();
-        controlSampleCounter -= controlIntervalSamples;
-    }
-
-    for (int v = 0; v < MAX_VOICES; v++) {
+// Envelopes, classification and the voice kernels for one span of the block
+void IRAM_ATTR ESP32Synth::renderVoiceSpan(int32_t* mixBuffer, int samples) {
+    // Pass 1: advance envelopes and sort each sounding voice into its kernel's bucket.
+    // Walk only the sounding voices (see _activeMask) instead of all MAX_VOICES slots.
+    uint16_t* bucketStart = _bucketStart;
+    memset(bucketStart, 0, sizeof(_bucketStart));
+    int numBlockVoices = 0;
+    uint32_t usedBuses = 0;
+    const bool routing = _busRouting;
+    for (int v = nextActiveVoice(-1); v >= 0; v = nextActiveVoice(v)) {
         Voice* vo = &voices[v];
-        if (!vo->active) continue;
+        // A voice stolen by noteOnAuto() stays indexed through its fade and starts the
+        // waiting note here, on the first span after it went silent.
+        if (UNLIKELY(!vo->active) && !(vo->stealFade && startStolenVoice(v))) { clearVoiceActive(v); continue; }
 
         int32_t startEnv, envStep;
-        updateAdsrBlock(vo, samples, startEnv, envStep);
+        updateAdsrBlock(vo, samples, startEnv, envStep, _sampleRate);
+        if (UNLIKELY(!vo->active) && !vo->stealFade) clearVoiceActive(v);
         if (startEnv == 0 && vo->currEnvVal == 0 && vo->envState != ENV_ATTACK) continue;
 
-        if (!vo->inst) {
-            switch (vo->type) {
-                case WAVE_SAMPLE:    renderBlockSample(vo, mixBuffer, samples, startEnv, envStep); break;
-                case WAVE_STREAM:    renderBlockStream(vo, this->streams, mixBuffer, samples, startEnv, envStep); break;
-                case WAVE_WAVETABLE: renderBlockWavetable(vo, mixBuffer, samples, startEnv, envStep); break;
-                case WAVE_NOISE:     renderBlockNoise(vo, mixBuffer, samples, startEnv, envStep); break;
-                case WAVE_CUSTOM:    if (vo->customWaveFunc) vo->customWaveFunc(vo, mixBuffer, samples, startEnv, envStep); break;
-                default:             renderBlockBasic(vo, mixBuffer, samples, startEnv, envStep); break;
-            }
-        } else {
-            if (vo->currWaveIsBasic) {
-                WaveType dynamicType = (WaveType)vo->currWaveType;
-                if (dynamicType == WAVE_NOISE) {
-                    renderBlockNoise(vo, mixBuffer, samples, startEnv, envStep);
-                } else {
-                    WaveType original = vo->type;
-                    vo->type = dynamicType;
-                    renderBlockBasic(vo, mixBuffer, samples, startEnv, envStep);
-                    vo->type = original;
-                }
-            } else {
-                renderBlockWavetable(vo, mixBuffer, samples, startEnv, envStep);
-            }
-        }
+        uint8_t kernel = classifyVoiceKernel(vo);
+        if (kernel == RK_SKIP) continue;
+#if SYNTH_ENABLE_FILTER
+        if (VOICE_FILTERED(vo)) updateFilterBlock(vo, samples);
+#endif
+
+        BlockVoice* bv = &_blockVoices[numBlockVoices++];
+        bv->voice    = (uint16_t)v;
+        bv->kernel   = kernel;
+        bv->bus      = routing ? vo->bus : 0;
+        bv->startEnv = startEnv;
+        bv->envStep  = envStep;
+        usedBuses   |= 1u << bv->bus;
+        bucketStart[kernel + 1]++;
     }
 
-    if (_customDSP) {
-        _customDSP(mixBuffer, samples);
+    // Pass 2: counting sort, voice order inside a bucket is preserved.
+    for (int k = 0; k < RK_NUM_KERNELS; k++) bucketStart[k + 1] += bucketStart[k];
+    {
+        uint16_t fill[RK_NUM_KERNELS];
+        memcpy(fill, bucketStart, sizeof(fill));
+        for (int i = 0; i < numBlockVoices; i++) _blockOrder[fill[_blockVoices[i].kernel]++] = (uint16_t)i;
     }
 
-    int32_t mVol = _masterVolume;
-    uint32_t mask32 = 0xFFFFFFFFUL;
-    uint32_t mask16 = 0xFFFFFFFFUL;
+    // Pass 3: render the buckets into their buses, split across both cores when dual-core
+    // mode is on.
+    _busOut[0] = mixBuffer;
+    _spanBuses = usedBuses;
+    if (usedBuses > 1) routeBuses(mixBuffer, usedBuses);
+#if SYNTH_ENABLE_DUAL_CORE
+    if (!_dualCore || !renderVoicesDual(samples, numBlockVoices))
+#endif
+        renderBuckets(_busOut, samples, 0, numBlockVoices, nullptr, false);
+}
+
+// Core mixer
+void IRAM_ATTR ESP32Synth::render(void* buffer, int32_t* mixBuffer, int samples, MasterFormat fmt) {
+    SYNTH_PROF_MARK(tControl);
+    // Apply the voice API calls other tasks queued since the last block (setCommandQueue).
+    _renderTask = xTaskGetCurrentTaskHandle();
+    if (_cmdRing) drainCommands();
 
-    if (_bitcrush > 0) {
-        mask32 = (_bitcrush >= 32) ? 0 : (0xFFFFFFFFUL << (32 - _bitcrush));
-        mask16 = (_bitcrush >= 16) ? 0 : (0xFFFFFFFFUL << (16 - _bitcrush));
+    controlSampleCounter += (uint32_t)samples;
+    while (controlSampleCounter >= controlIntervalSamples) {
+        processControl();
+        controlSampleCounter -= controlIntervalSamples;
     }
+    SYNTH_PROF_STAGE(PROF_CONTROL, tControl);
 
-    if (currentMode == SMODE_I2S && _i2sDepth == I2S_32BIT) {
-        int32_t* buf32 = (int32_t*)buffer;
-        for (int i = 0; i < samples; i++) {
-            int64_t val = (int64_t)mixBuffer[i] * mVol;
-            if (val > 2147483647LL) val = 2147483647LL;
-            else if (val < -2147483648LL) val = -2147483648LL;
-            buf32[i] = (int32_t)val & mask32;
-        }
-    } else {
-        int16_t* buf16 = (int16_t*)buffer;
-        for (int i = 0; i < samples; i++) {
-            int32_t val = (int32_t)(((int64_t)mixBuffer[i] * mVol) >> 16);
-            if (val > 32767) val = 32767;
-            else if (val < -32768) val = -32768;
-            buf16[i] = (int16_t)(val & mask16);
-        }
+    SYNTH_PROF_MARK(tVoices);
+    // Zero the aligned buffer ensuring thread safety
+    memset(mixBuffer, 0, samples * SYNTH_MIX_CHANNELS * sizeof(int32_t));
+
+    // Voices on the other buses go to the bus buffers once they exist (setVoiceBus) and
+    // hold the block; each bus buffer is cleared by the first span that uses it.
+    _busRouting   = __atomic_load_n(&_busMix, __ATOMIC_ACQUIRE) && samples <= _busLen;
+    _blockMix     = mixBuffer;
+    _blockSamples = samples;
+    _blockBuses   = 0;
+
+    // Timed events (noteOnAt/noteOffAt) cut the block into spans; without any pending the
+    // whole block is a single span.
+    int pos = 0;
+    while (pos < samples) {
+        int end = (_numEvents > 0) ? applyDueEvents(pos, samples) : samples;
+        renderVoiceSpan(mixBuffer + pos * SYNTH_MIX_CHANNELS, end - pos);
+        pos = end;
+    }
+    _sampleClock += (uint32_t)samples;
+    SYNTH_PROF_STAGE(PROF_VOICES, tVoices);
+
+    SYNTH_PROF_MARK(tDsp);
+    if (_busRouting) mixBuses(mixBuffer, samples);
+    runFxChain(_fxChain, mixBuffer, samples);
+    // A mono DSP hook on a stereo build sees the interleaved L/R words as one flat buffer.
+#if SYNTH_ENABLE_STEREO
+    if (_customDSPStereo) {
+        _customDSPStereo(mixBuffer, samples);
+    }
+#endif
+    if (_customDSP) {
+        _customDSP(mixBuffer, samples * SYNTH_MIX_CHANNELS);
     }
+    SYNTH_PROF_STAGE(PROF_DSP, tDsp);
+
+    SYNTH_PROF_MARK(tMaster);
+    masterBlock(mixBuffer, buffer, samples, _masterVolume, _bitcrush, fmt);
+    SYNTH_PROF_STAGE(PROF_MASTER, tMaster);
 }
 
 // WAV Header Parser
@@ -419,6 +490,17 @@ bool ESP32Synth::parseWavHeader(SYNTH_FILE_REF file, uint32_t& outSampleRate, ui
     return false;
 }
 
+// One decoded stereo frame into the ring: the stereo engine keeps both channels, the mono
+// engine stores the downmix.
+static FORCE_INLINE void streamPutFrame(StreamTrack* trk, uint16_t head, int32_t l, int32_t r) {
+#if SYNTH_ENABLE_STEREO
+    trk->buffer[head]  = (int16_t)l;
+    trk->bufferR[head] = (int16_t)r;
+#else
+    trk->buffer[head] = (int16_t)((l + r) >> 1);
+#endif
+}
+
 // SD Background Loader
 void ESP32Synth::sdLoaderTask(void* param) {
     ESP32Synth* synth = (ESP32Synth*)param;
@@ -486,11 +568,11 @@ void ESP32Synth::sdLoaderTask(void* param) {
                 uint8_t* ptr = tempBuf;
                 uint16_t head = trk->head;
 
-                // Decode & Downmix to 16-bit Mono
+                // Decode to 16-bit (stereo kept or downmixed, see streamPutFrame)
                 if (trk->bitsPerSample == 16) {
                     if (trk->numChannels == 2) { // Stereo 16-bit
                         for (uint16_t f = 0; f < framesRead; f++, ptr += 4) {
-                            trk->buffer[head] = (int16_t)(((int32_t)((int16_t*)ptr)[0] + (int32_t)((int16_t*)ptr)[1]) >> 1); // Mix to mono
+                            streamPutFrame(trk, head, ((int16_t*)ptr)[0], ((int16_t*)ptr)[1]);
                             head = (head + 1) & STREAM_BUF_MASK;
                         }
                     } else { // Mono 16-bit
@@ -511,7 +593,7 @@ void ESP32Synth::sdLoaderTask(void* param) {
                         for (uint16_t f = 0; f < framesRead; f++, ptr += 6) {
                             int32_t l = (ptr[1] | ((int8_t)ptr[2] << 8));
                             int32_t r = (ptr[4] | ((int8_t)ptr[5] << 8));
-                            trk->buffer[head] = (int16_t)((l + r) >> 1);
+                            streamPutFrame(trk, head, l, r);
                             head = (head + 1) & STREAM_BUF_MASK;
                         }
                     } else { // Mono 24-bit
@@ -525,7 +607,7 @@ void ESP32Synth::sdLoaderTask(void* param) {
                         for (uint16_t f = 0; f < framesRead; f++, ptr += 8) {
                             int32_t l = ((int32_t*)ptr)[0] >> 16;
                             int32_t r = ((int32_t*)ptr)[1] >> 16;
-                            trk->buffer[head] = (int16_t)((l + r) >> 1);
+                            streamPutFrame(trk, head, l, r);
                             head = (head + 1) & STREAM_BUF_MASK;
                         }
                     } else { // Mono 32-bit
@@ -539,7 +621,7 @@ void ESP32Synth::sdLoaderTask(void* param) {
                         for (uint16_t f = 0; f < framesRead; f++, ptr += 2) {
                             int32_t l = ((int16_t)ptr[0] - 128) << 8;
                             int32_t r = ((int16_t)ptr[1] - 128) << 8;
-                            trk->buffer[head] = (int16_t)((l + r) >> 1);
+                            streamPutFrame(trk, head, l, r);
                             head = (head + 1) & STREAM_BUF_MASK;
                         }
                     } else { // Mono 8-bit
@@ -588,8 +670,7 @@ void ESP32Synth::generateSamples(int16_t* outBuffer, int numSamples) {
 
     // Extremely fast and safe allocation on local stack, preventing heap fragmentation
     const int CHUNK_SIZE = 128;
-    int32_t mixBuffer[CHUNK_SIZE] __attribute__((aligned(16)));
-    int16_t tempOut[CHUNK_SIZE] __attribute__((aligned(16)));
+    int32_t mixBuffer[CHUNK_SIZE * SYNTH_MIX_CHANNELS] __attribute__((aligned(16))); // Packed to int16 in place by render()
 
     int samplesRendered = 0;
     while (samplesRendered < numSamples) {
@@ -601,14 +682,17 @@ void ESP32Synth::generateSamples(int16_t* outBuffer, int numSamples) {
 
         uint32_t start_cycles = esp_cpu_get_cycle_count();
 
-        render(tempOut, mixBuffer, simdRender);
+        render(mixBuffer, mixBuffer, simdRender, MASTER_MONO16);
 
         uint32_t used_cycles = esp_cpu_get_cycle_count() - start_cycles;
         uint32_t max_cycles = (SYNTH_GET_CPU_FREQ_MHZ() * 1000000 / _sampleRate) * simdRender;
         if (max_cycles > 0) _dspLoad = ((float)used_cycles / (float)max_cycles) * 100.0f;
 
         // Copies strictly the requested samples to prevent overflow in the user's memory
-        memcpy(outBuffer + samplesRendered, tempOut, toRender * sizeof(int16_t));
+        SYNTH_PROF_MARK(tOutput);
+        memcpy(outBuffer + samplesRendered, mixBuffer, toRender * sizeof(int16_t));
+        SYNTH_PROF_STAGE(PROF_OUTPUT, tOutput);
+        SYNTH_PROF_END_BLOCK(simdRender);
         samplesRendered += toRender;
     }
 }
@@ -617,8 +701,7 @@ void ESP32Synth::generateSamplesStereo(int16_t* outBufferLR, int numSamplePairs)
     if (!outBufferLR || numSamplePairs <= 0 || !_running) return;
 
     const int CHUNK_SIZE = 128;
-    int32_t mixBuffer[CHUNK_SIZE] __attribute__((aligned(16)));
-    int16_t tempOut[CHUNK_SIZE] __attribute__((aligned(16)));
+    int32_t mixBuffer[CHUNK_SIZE * SYNTH_MIX_CHANNELS] __attribute__((aligned(16))); // Packed to L/R pairs in place by render()
 
     int samplesRendered = 0;
     while (samplesRendered < numSamplePairs) {
@@ -629,30 +712,104 @@ void ESP32Synth::generateSamplesStereo(int16_t* outBufferLR, int numSamplePairs)
 
         uint32_t start_cycles = esp_cpu_get_cycle_count();
 
-        render(tempOut, mixBuffer, simdRender);
+        // Interleaved stereo (L, R, L, R) ideal for Bluetooth (A2DP) / Wi-Fi, packed by the master stage
+        render(mixBuffer, mixBuffer, simdRender, MASTER_STEREO16);
 
         uint32_t used_cycles = esp_cpu_get_cycle_count() - start_cycles;
         uint32_t max_cycles = (SYNTH_GET_CPU_FREQ_MHZ() * 1000000 / _sampleRate) * simdRender;
         if (max_cycles > 0) _dspLoad = ((float)used_cycles / (float)max_cycles) * 100.0f;
 
-        // Duplicates to interleaved stereo (L, R, L, R) ideal for Bluetooth (A2DP) / Wi-Fi
-        for (int i = 0; i < toRender; i++) {
-            int16_t smp = tempOut[i];
-            outBufferLR[(samplesRendered + i) * 2] = smp;     // Left Channel
-            outBufferLR[(samplesRendered + i) * 2 + 1] = smp; // Right Channel
-        }
+        SYNTH_PROF_MARK(tOutput);
+        memcpy(outBufferLR + samplesRendered * 2, mixBuffer, toRender * 2 * sizeof(int16_t));
+        SYNTH_PROF_STAGE(PROF_OUTPUT, tOutput);
+        SYNTH_PROF_END_BLOCK(simdRender);
 
         samplesRendered += toRender;
     }
 }
 
+// Renders bucketed voices [from, to) of _blockOrder: one tight loop per kernel with the
+// waveform / bit depth as a constant. Optionally accumulates per-kernel cycles for the
+// dual-core load balancer.
+void IRAM_ATTR ESP32Synth::renderBuckets(int32_t* const* busOut, int samples, int from, int to, KernelTiming* timing, bool onWorker) {
+#if SYNTH_ENABLE_PROFILER
+    ProfAccum* profAcc = onWorker ? _profKernelAccWorker : _profKernelAcc;
+#endif
+
+    // Each voice mixes into its bus's span (busOut[BlockVoice::bus], ESP32Synth_Buses.hpp).
+    // A filtered voice (ESP32Synth_Filter.hpp) runs its kernel in SVF_CHUNK pieces: inside
+    // the loop 'mixBuffer', 'samples' and the envelope start are rebound to the scratch
+    // buffer and the piece, which is then filtered and added to the span's mix. Any other
+    // voice takes a single pass straight into the mix. One call site keeps each inlined
+    // kernel in IRAM once.
+    const int      span   = samples;
+    int32_t        filterBuf[SVF_CHUNK * SYNTH_MIX_CHANNELS] __attribute__((aligned(16)));
+
+    #define RENDER_BUCKET(profKernel, call) \
+        for (int i = lo; i < hi; i++) { \
+            const BlockVoice* bv = &_blockVoices[_blockOrder[i]]; \
+            Voice* vo = &voices[bv->voice]; \
+            int32_t* const mixOut = busOut[bv->bus]; \
+            const bool filtered = VOICE_FILTERED(vo); \
+            const int  piece    = filtered ? SVF_CHUNK : span; \
+            SYNTH_PROF_MARK(tKernel); \
+            for (int pos = 0; pos < span; pos += piece) { \
+                const int samples = (span - pos < piece) ? span - pos : piece; \
+                int32_t* const mixBuffer = filtered ? filterBuf : mixOut; \
+                const int32_t startEnv = bv->startEnv + bv->envStep * pos, envStep = bv->envStep; \
+                if (filtered) memset(filterBuf, 0, samples * SYNTH_MIX_CHANNELS * sizeof(int32_t)); \
+                call; \
+                if (filtered) svfRenderChunk(vo, filterBuf, mixOut + pos * SYNTH_MIX_CHANNELS, samples); \
+            } \
+            SYNTH_PROF_KERNEL(profAcc, profKernel, tKernel); \
+        }
+
+    for (int k = 0; k < RK_NUM_KERNELS; k++) {
+        const int lo = (from > _bucketStart[k]) ? from : _bucketStart[k];
+        const int hi = (to < _bucketStart[k + 1]) ? to : _bucketStart[k + 1];
+        if (lo >= hi) continue;
+
+        uint32_t t0 = timing ? esp_cpu_get_cycle_count() : 0;
+        switch (k) {
+            case RK_SINE:         RENDER_BUCKET(PROF_K_SINE,      renderBlockBasic(vo, mixBuffer, samples, startEnv, envStep, WAVE_SINE)); break;
+            case RK_TRIANGLE:     RENDER_BUCKET(PROF_K_TRIANGLE,  renderBlockBasic(vo, mixBuffer, samples, startEnv, envStep, WAVE_TRIANGLE)); break;
+            case RK_SAW:          RENDER_BUCKET(PROF_K_SAW,       renderBlockBasic(vo, mixBuffer, samples, startEnv, envStep, WAVE_SAW)); break;
+            case RK_PULSE:        RENDER_BUCKET(PROF_K_PULSE,     renderBlockBasic(vo, mixBuffer, samples, startEnv, envStep, WAVE_PULSE)); break;
+            case RK_NOISE:        RENDER_BUCKET(PROF_K_NOISE,     renderBlockNoise(vo, mixBuffer, samples, startEnv, envStep)); break;
+            case RK_SAW_BL:       RENDER_BUCKET(PROF_K_SAW_BL,    renderBlockPolyBlep(vo, mixBuffer, samples, startEnv, envStep, WAVE_SAW_BL)); break;
+            case RK_PULSE_BL:     RENDER_BUCKET(PROF_K_PULSE_BL,  renderBlockPolyBlep(vo, mixBuffer, samples, startEnv, envStep, WAVE_PULSE_BL)); break;
+            case RK_WAVETABLE_16: RENDER_BUCKET(PROF_K_WAVETABLE, renderBlockWavetable(vo, mixBuffer, samples, startEnv, envStep, BITS_16)); break;
+            case RK_WAVETABLE_8:  RENDER_BUCKET(PROF_K_WAVETABLE, renderBlockWavetable(vo, mixBuffer, samples, startEnv, envStep, BITS_8)); break;
+            case RK_WAVETABLE_4:  RENDER_BUCKET(PROF_K_WAVETABLE, renderBlockWavetable(vo, mixBuffer, samples, startEnv, envStep, BITS_4)); break;
+            case RK_WAVETABLE_LERP_16: RENDER_BUCKET(PROF_K_WAVETABLE_LERP, renderBlockWavetableLerp(vo, mixBuffer, samples, startEnv, envStep, BITS_16)); break;
+            case RK_WAVETABLE_LERP_8:  RENDER_BUCKET(PROF_K_WAVETABLE_LERP, renderBlockWavetableLerp(vo, mixBuffer, samples, startEnv, envStep, BITS_8)); break;
+            case RK_WAVETABLE_LERP_4:  RENDER_BUCKET(PROF_K_WAVETABLE_LERP, renderBlockWavetableLerp(vo, mixBuffer, samples, startEnv, envStep, BITS_4)); break;
+            case RK_SAMPLE_16:    RENDER_BUCKET(PROF_K_SAMPLE,    renderBlockSample(vo, mixBuffer, samples, startEnv, envStep, BITS_16)); break;
+            case RK_SAMPLE_8:     RENDER_BUCKET(PROF_K_SAMPLE,    renderBlockSample(vo, mixBuffer, samples, startEnv, envStep, BITS_8)); break;
+            case RK_SAMPLE_4:     RENDER_BUCKET(PROF_K_SAMPLE,    renderBlockSample(vo, mixBuffer, samples, startEnv, envStep, BITS_4)); break;
+            case RK_SAMPLE_LERP_16:    RENDER_BUCKET(PROF_K_SAMPLE_INTERP, renderBlockSampleInterp(vo, mixBuffer, samples, startEnv, envStep, BITS_16, INTERP_LINEAR)); break;
+            case RK_SAMPLE_LERP_8:     RENDER_BUCKET(PROF_K_SAMPLE_INTERP, renderBlockSampleInterp(vo, mixBuffer, samples, startEnv, envStep, BITS_8,  INTERP_LINEAR)); break;
+            case RK_SAMPLE_LERP_4:     RENDER_BUCKET(PROF_K_SAMPLE_INTERP, renderBlockSampleInterp(vo, mixBuffer, samples, startEnv, envStep, BITS_4,  INTERP_LINEAR)); break;
+            case RK_SAMPLE_HERMITE_16: RENDER_BUCKET(PROF_K_SAMPLE_INTERP, renderBlockSampleInterp(vo, mixBuffer, samples, startEnv, envStep, BITS_16, INTERP_HERMITE)); break;
+            case RK_SAMPLE_HERMITE_8:  RENDER_BUCKET(PROF_K_SAMPLE_INTERP, renderBlockSampleInterp(vo, mixBuffer, samples, startEnv, envStep, BITS_8,  INTERP_HERMITE)); break;
+            case RK_SAMPLE_HERMITE_4:  RENDER_BUCKET(PROF_K_SAMPLE_INTERP, renderBlockSampleInterp(vo, mixBuffer, samples, startEnv, envStep, BITS_4,  INTERP_HERMITE)); break;
+            case RK_STREAM:       RENDER_BUCKET(PROF_K_STREAM,    renderBlockStream(vo, this->streams, mixBuffer, samples, startEnv, envStep)); break;
+            case RK_CUSTOM:       RENDER_BUCKET(PROF_K_CUSTOM,    renderBlockCustom(vo, mixBuffer, samples, startEnv, envStep)); break;
+        }
+        if (timing) {
+            timing->cycles[k] += esp_cpu_get_cycle_count() - t0;
+            timing->voices[k] += (uint16_t)(hi - lo);
+        }
+    }
+    #undef RENDER_BUCKET
+}
+
 // Control Rate Logic (LFOs, Envelopes, Arps). Runs at ~100Hz.
 void IRAM_ATTR ESP32Synth::processControl() {
-    for (int v = 0; v < MAX_VOICES; v++) {
+    // RAW OPTIMIZATION: Only voices in the active index are visited, so idle slots
+    // cost nothing even when MAX_VOICES is in the hundreds.
+    for (int v = nextActiveVoice(-1); v >= 0; v = nextActiveVoice(v)) {
         Voice* vo = &voices[v];
-
-        // RAW OPTIMIZATION: If the voice is not active, skip everything.
-        // Recovers significant processing power when not all voices are in use.
         if (!vo->active) continue;
 
         // --- LFOs (Vibrato and Tremolo) ---
@@ -817,6 +974,7 @@ void IRAM_ATTR ESP32Synth::processControl() {
                 len = inst->relLen;
                 if (len == 0) {
                     vo->active = false; // No release sequence, just deactivate
+                    clearVoiceActive(v);
                     break;
                 }
                 if (vo->controlTick == 0) {
@@ -835,7 +993,10 @@ void IRAM_ATTR ESP32Synth::processControl() {
                 if (vo->controlTick > 0) vo->controlTick--;
                 if (vo->controlTick == 0) {
                     vo->stageIdx++;
-                    if (vo->stageIdx >= len) vo->active = false; // End of release sequence
+                    if (vo->stageIdx >= len) { // End of release sequence
+                        vo->active = false;
+                        clearVoiceActive(v);
+                    }
                 }
                 break;
             default: break;
@@ -864,6 +1025,8 @@ void IRAM_ATTR ESP32Synth::processControl() {
                     vo->wtData = wavetables[vo->currWaveId].data;
                     vo->wtSize = wavetables[vo->currWaveId].size;
                     vo->depth = wavetables[vo->currWaveId].depth;
+                    vo->wtInterp = wavetables[vo->currWaveId].interp;
+                    vo->wtMip = wavetables[vo->currWaveId].mip;
                     if (vo->depth == 0) vo->depth = BITS_8;
                 }
             }
@@ -34,6 +34,7 @@
 #else
     #include <stdint.h>
     #include <stddef.h>
+    #include <stdlib.h>
     #include <string.h>
     #include <math.h>
     #include <stdio.h>
@@ -52,6 +53,10 @@
     #define SYNTH_MICROS()           (uint32_t)esp_timer_get_time()
     #define SYNTH_DELAY_US(us)       esp_rom_delay_us(us)
 
+    #ifndef PI
+    #define PI 3.1415926535897932384626433832795
+    #endif
+
     // Filesystem Abstraction - Pure ESP-IDF C
     #define SYNTH_FILE               FILE*
     #define SYNTH_FILE_REF           FILE*
@@ -127,6 +132,8 @@ enum WaveType : int8_t {
     WAVE_SAW       = -3,
     WAVE_PULSE     = -4,
     WAVE_NOISE     = -5,
+    WAVE_SAW_BL    = -6, // Band-limited (PolyBLEP) saw: far less aliasing on high notes
+    WAVE_PULSE_BL  = -7, // Band-limited (PolyBLEP) pulse, uses setPulseWidth()
     WAVE_WAVETABLE = 1,
     WAVE_SAMPLE    = 2,
     WAVE_STREAM    = 3,
@@ -147,6 +154,21 @@ enum EnvState : uint8_t {
     ENV_RELEASE
 };
 
+// Shape of an envelope segment (setEnvCurve, EnvSegment)
+enum EnvCurve : uint8_t {
+    ENV_CURVE_LINEAR, // Constant slope
+    ENV_CURVE_EXP,    // Fast at first, easing into the target level (analog RC: natural decays / releases)
+    ENV_CURVE_LOG     // Slow at first, fast at the end (swells)
+};
+
+// Per-voice filter response (setFilter)
+enum FilterType : uint8_t {
+    FILTER_OFF,
+    FILTER_LP, // Low-pass, 12 dB/oct
+    FILTER_BP, // Band-pass
+    FILTER_HP  // High-pass, 12 dB/oct
+};
+
 enum I2S_Depth : uint8_t {
     I2S_16BIT,
     I2S_32BIT
@@ -159,6 +181,46 @@ enum LoopMode : uint8_t {
     LOOP_REVERSE
 };
 
+// PCM sample playback interpolation (setSampleInterp / Instrument_Sample::interp)
+enum SampleInterp : uint8_t {
+    INTERP_NONE,    // Nearest frame (cheapest, stepped when pitched down)
+    INTERP_LINEAR,  // 2-point linear
+    INTERP_HERMITE  // 4-point cubic Hermite (Catmull-Rom)
+};
+
+// Fractional DelayLine reads (readLinear / readAllpass, SynthChorus / SynthFlanger::setInterp)
+enum DelayInterp : uint8_t {
+    DELAY_LINEAR,  // 2-point linear: dulls the highs a little between whole samples
+    DELAY_ALLPASS  // 1st-order allpass: flat response, one state word per tap
+};
+
+// Output latency presets for setLatencyProfile(). Latency (ms) = dmaLen * dmaCount / rate * 1000.
+enum SynthLatencyProfile : uint8_t {
+    LATENCY_PLAYBACK, // DMA 512 x 6, render block 512 (~64 ms @ 48 kHz, highest polyphony)
+    LATENCY_BALANCED, // DMA 256 x 4, render block 256 (~21 ms, good for most MIDI keyboards)
+    LATENCY_LIVE      // DMA 128 x 2, render block 128 (~5 ms, playing live)
+};
+
+// Which voice noteOnAuto() takes over when every voice of the pool is busy
+enum SynthStealMode : uint8_t {
+    STEAL_OLDEST,         // The note started longest ago
+    STEAL_QUIETEST,       // Lowest envelope * volume right now
+    STEAL_RELEASED_FIRST, // The oldest released note, else the oldest held one
+    STEAL_NONE            // Never steal: noteOnAuto() fails while the pool is full
+};
+
+// Band-limited wavetable pyramid (exported by tools/Wavetables/WavetableMaker.py).
+// levels[0] holds the waveform with 'harmonics' partials; each next level keeps half of
+// them (one octave less) and may use a smaller table. All levels share the same depth.
+// The render kernel picks the highest level whose top partial stays below Nyquist.
+struct WavetableMip {
+    const void* const* levels;
+    const uint32_t*    sizes;
+    uint16_t           harmonics;
+    uint8_t            numLevels;
+    BitDepth           depth;
+};
+
 struct Instrument {
     const uint8_t* seqVolumes;
     const int16_t* seqWaves;
@@ -195,11 +257,42 @@ struct Instrument_Sample {
     LoopMode          loopMode;
     uint32_t          loopStart;
     uint32_t          loopEnd;
+    SampleInterp      interp;    // INTERP_NONE keeps the voice's own setSampleInterp() mode
+};
+
+// Voice setup applied by noteOnAuto() / setPatch() before the note starts
+struct SynthPatch {
+    WaveType           wave;       // Oscillator (ignored when 'inst' is set)
+    uint16_t           attackMs;
+    uint16_t           decayMs;
+    uint8_t            sustain;    // 0-255
+    uint16_t           releaseMs;
+    Instrument*        inst;       // Optional tracker instrument, replaces wave and ADSR
+    Instrument_Sample* instSample; // Optional multi-sample instrument, ADSR still applies
+};
+
+// One stage of a multi-stage envelope
+struct EnvSegment {
+    uint8_t  level;  // Target level 0-255
+    uint16_t timeMs; // Time to get there from wherever the previous stage ended (0 = jump)
+    EnvCurve curve;
+};
+
+// N-stage envelope (setEnvelope): noteOn() runs the stages up to 'sustainSeg' and holds its
+// level, noteOff() continues with the stage after it. The voice stops after the last stage,
+// which should therefore end at level 0. With sustainSeg >= numSegs it plays through once.
+struct SynthEnvelope {
+    const EnvSegment* segs;
+    uint8_t           numSegs;
+    uint8_t           sustainSeg;
 };
 
 struct StreamTrack {
     SYNTH_FILE        file;
-    int16_t           buffer[STREAM_BUF_SAMPLES];
+    int16_t           buffer[STREAM_BUF_SAMPLES];  // Mono, or the left channel of a stereo track
+#if SYNTH_ENABLE_STEREO
+    int16_t           bufferR[STREAM_BUF_SAMPLES]; // Right channel, shares head / tail with 'buffer'
+#endif
     volatile uint16_t head;
     volatile uint16_t tail;
     uint32_t          sampleRate;
@@ -212,11 +305,106 @@ struct StreamTrack {
     uint32_t          loopStartBytes;
     uint32_t          loopEndBytes;
     uint32_t          rootFreqCentiHz;
+    uint16_t          voice;    // Voice the track was set up for
     bool              active;
     volatile bool     playing;
+    volatile bool     detached; // Set once no voice reads the track, so the file may close
     bool              loop;
 };
 
+// Layout the master stage writes for each output path (see ESP32Synth_Master.hpp)
+enum MasterFormat : uint8_t {
+    MASTER_MONO16,   // int16 mono: PDM, custom output, generateSamples()
+    MASTER_STEREO16, // I2S 16-bit: one 32-bit L/R frame per sample
+    MASTER_STEREO32, // I2S 32-bit: two int32 slots per sample
+    MASTER_DAC8,     // built-in DAC: the 8-bit code in both bytes of a uint16
+    MASTER_PWM10     // LEDC: 10-bit duty, already in the duty register layout
+};
+
+// --- Render Profiler (compiled in only with SYNTH_ENABLE_PROFILER, see ESP32Synth_Config.hpp) ---
+enum SynthProfileStage : uint8_t {
+    PROF_CONTROL,   // processControl() ticks run inside render()
+    PROF_VOICES,    // mix clear + envelopes + every voice kernel
+    PROF_DSP,       // user _customDSP hook
+    PROF_MASTER,    // master volume, clip, bitcrush and output-format packing
+    PROF_OUTPUT,    // copies / reformatting outside render() (generateSamples*)
+    PROF_TOTAL,     // sum of all the above for one block
+    PROF_NUM_STAGES
+};
+
+// One entry per oscillator family; wavetable and sample bit depths are reported together.
+enum SynthProfileKernel : uint8_t {
+    PROF_K_SINE,
+    PROF_K_TRIANGLE,
+    PROF_K_SAW,
+    PROF_K_PULSE,
+    PROF_K_NOISE,
+    PROF_K_SAW_BL,
+    PROF_K_PULSE_BL,
+    PROF_K_WAVETABLE,
+    PROF_K_WAVETABLE_LERP,
+    PROF_K_SAMPLE,
+    PROF_K_SAMPLE_INTERP,
+    PROF_K_STREAM,
+    PROF_K_CUSTOM,
+    PROF_NUM_KERNELS
+};
+
+struct SynthProfileStat {
+    uint32_t minCycles;
+    uint32_t avgCycles;
+    uint32_t maxCycles;
+};
+
+struct SynthKernelStat {
+    uint32_t         voiceRenders;     // Voice blocks rendered by this kernel during the window
+    uint32_t         avgVoices;        // Average voices using this kernel per block
+    uint32_t         avgCyclesPerBlock;// Average total kernel cost per block
+    SynthProfileStat perVoice;         // Cost of one voice for one block
+};
+
+struct SynthRenderProfile {
+    bool             enabled;          // false when the profiler is compiled out
+    uint32_t         windowId;         // Increments every time a new window is published
+    uint32_t         blocks;           // Blocks aggregated in this window
+    uint32_t         samplesPerBlock;
+    uint32_t         budgetCycles;     // CPU cycles available per block at the current sample rate
+    float            avgLoad;          // PROF_TOTAL avg / budget, in %
+    float            peakLoad;         // PROF_TOTAL max / budget, in %
+    SynthProfileStat stage[PROF_NUM_STAGES];
+    SynthKernelStat  kernel[PROF_NUM_KERNELS];
+};
+
+// Internal: the kernel render() buckets a voice into for one block (see classifyVoiceKernel).
+enum RenderKernel : uint8_t {
+    RK_SINE,
+    RK_TRIANGLE,
+    RK_SAW,
+    RK_PULSE,
+    RK_NOISE,
+    RK_SAW_BL,
+    RK_PULSE_BL,
+    RK_WAVETABLE_16,
+    RK_WAVETABLE_8,
+    RK_WAVETABLE_4,
+    RK_WAVETABLE_LERP_16, // Linear-interpolated wavetables (setWavetable(..., true))
+    RK_WAVETABLE_LERP_8,
+    RK_WAVETABLE_LERP_4,
+    RK_SAMPLE_16,
+    RK_SAMPLE_8,
+    RK_SAMPLE_4,
+    RK_SAMPLE_LERP_16,
+    RK_SAMPLE_LERP_8,
+    RK_SAMPLE_LERP_4,
+    RK_SAMPLE_HERMITE_16,
+    RK_SAMPLE_HERMITE_8,
+    RK_SAMPLE_HERMITE_4,
+    RK_STREAM,
+    RK_CUSTOM,      // Always last: user callbacks stay on the calling core in dual-core mode
+    RK_NUM_KERNELS,
+    RK_SKIP = 0xFF  // Nothing to render this block (missing data, finished sample, ...)
+};
+
 struct Voice;
 typedef void (*SynthCustomWaveCallback)(Voice* vo, int32_t* mixBuffer, int samples, int32_t startEnv, int32_t envStep);
 
@@ -243,6 +431,7 @@ struct Voice {
         struct {
             const void* wtData;
             uint32_t    wtSize;
+            const WavetableMip* wtMip; // Optional pyramid; wtData/wtSize then follow the pitch
         };
         // Modo: Tracker Instrument (Sequenciador de passos)
         struct {
@@ -257,6 +446,7 @@ struct Voice {
     Instrument*        inst;
     Instrument_Sample* instSample;
     SynthCustomWaveCallback customWaveFunc;
+    const SynthEnvelope* envTable;
 
     // 32-bit (4 bytes) - ADSR isolado e seguro contra corrupção
     uint32_t           rateAttack;
@@ -264,6 +454,34 @@ struct Voice {
     uint32_t           rateRelease;
     uint32_t           levelSustain;
 
+    // Curved / multi-stage envelope: the running segment (see updateShapedEnvBlock)
+    uint32_t           envFrom;
+    uint32_t           envTarget;
+    uint32_t           envPos;         // Segment progress, 0 .. ENV_MAX
+    uint32_t           envPosRate;     // Progress per sample
+
+#if SYNTH_ENABLE_FILTER
+    // Per-voice SVF (ESP32Synth_Filter.hpp): state per mix channel, Q30 coefficients ramped
+    // across the block, and a linear filter envelope stepped once per block
+    int32_t            svfIc1[SYNTH_MIX_CHANNELS];
+    int32_t            svfIc2[SYNTH_MIX_CHANNELS];
+    int32_t            svfA[3];
+    int32_t            svfDA[3];       // Coefficient step per sample
+    int32_t            svfK;           // Damping 1 / Q, Q24
+    int32_t            svfCutPitch;    // Cutoff in cents relative to the sample rate, key tracking reference folded in
+    uint32_t           svfCutoff;      // centiHz, as set
+    uint32_t           fenvVal;        // 0 .. ENV_MAX
+    uint32_t           fenvRateA;
+    uint32_t           fenvRateD;
+    uint32_t           fenvRateR;
+    uint32_t           fenvSustain;
+    int16_t            fenvAmount;     // Cutoff offset in cents at full envelope
+    uint8_t            svfType;        // FilterType
+    uint8_t            svfKeyTrack;    // 0 .. 255 = 1:1
+    EnvState           fenvState;
+    bool               svfInit;        // Jump to the first block's coefficients instead of ramping
+#endif
+
     // Outros campos de 32-bit (4 bytes)
     uint32_t           phase;
     uint32_t           phaseInc;
@@ -306,6 +524,7 @@ struct Voice {
     int16_t            noiseSample;
     int16_t            streamTrackId;
     int16_t            lastStreamSample;
+    int16_t            pan;            // -SYNTH_PAN_MAX (left) .. 0 (centre) .. SYNTH_PAN_MAX (right)
 
     // 8-bit, Bools e Enums (1 byte)
     EnvState           envState;
@@ -318,8 +537,16 @@ struct Voice {
     uint8_t            currWaveIsBasic;
     uint8_t            nextWaveIsBasic;
     uint8_t            morph;
+    uint8_t            wtInterp;       // Wavetable read: 0 = nearest, 1 = linear interpolation
+    SampleInterp       sampleInterp;   // PCM sample read: nearest, linear or Hermite
     uint8_t            arpLen;
     uint8_t            arpIdx;
+    uint8_t            noteCount;      // noteOn() calls applied so far (voice allocator bookkeeping)
+    uint8_t            envCurves;      // EnvCurve of attack / decay / release, 2 bits each
+    uint8_t            envCurve;       // EnvCurve of the running segment
+    uint8_t            envSeg;         // envTable stage
+    uint8_t            envSegState;    // envState the running segment belongs to, or ENV_SEG_RESTART
+    uint8_t            bus;            // Mix bus (setVoiceBus), 0 = main mix
     bool               active;
     bool               slideFreqActive;
     bool               slideVolActive;
@@ -327,6 +554,248 @@ struct Voice {
     bool               sampleDirection;
     bool               sampleFinished;
     bool               smoothEnv;
+    bool               envShaped;      // Curves or envTable set: updateShapedEnvBlock
+    bool               stealFade;      // Fading out for noteOnAuto(); the new note starts once silent
+};
+
+// ====================================================================================
+//    EFFECT CHAIN STAGE
+// ====================================================================================
+// Base class of an effect stage (addEffect, ESP32Synth_Effects.hpp). process() transforms
+// the int32 mix in place, at most SYNTH_FX_BLOCK frames per call, interleaved L/R in
+// stereo builds. It runs on the audio task: no allocation, no blocking.
+#define SYNTH_FX_TAIL_FOREVER 0xFFFFFFFFUL
+#define SYNTH_BUS_RETURN      255 // Bus number of the shared return bus (setBusGain, addBusEffect)
+
+class SynthEffect {
+public:
+    virtual ~SynthEffect() {}
+    virtual void process(int32_t* mix, int frames) = 0;
+
+    // How long the output keeps sounding once the input is silent, in samples. After that
+    // long a silent input puts the stage to sleep (skipped) until sound comes back. The
+    // default never sleeps: right for stages that make sound on their own.
+    virtual uint32_t tailSamples() { return SYNTH_FX_TAIL_FOREVER; }
+
+    // Clears delay lines and filter state. Called from the task that switches the stage on
+    // (addEffect, setEffectBypass(false)), never while the audio task runs it.
+    virtual void reset() {}
+
+    bool  isBypassed() const { return !_fxEnabled; }
+    bool  isSleeping() const { return _fxSleeping; }
+    float getCyclesPerSample() const { return _fxCyclesQ8 / 256.0f; } // Smoothed, falls to 0 while skipped
+
+protected:
+    int32_t* scratch = nullptr; // SYNTH_FX_BLOCK frames of 16-byte aligned int32, free to use inside process()
+
+private:
+    friend class ESP32Synth;
+    enum : uint8_t { FX_OFF, FX_FADE_IN, FX_ON, FX_FADE_OUT };
+    volatile bool    _fxEnabled  = false; // In a chain and not bypassed
+    volatile uint8_t _fxState    = FX_OFF;
+    volatile bool    _fxSleeping = false;
+    uint32_t         _fxIdle     = 0;     // Silent input samples seen since the last sound
+    uint32_t         _fxCyclesQ8 = 0;
+};
+
+// ====================================================================================
+//    FDN REVERB
+// ====================================================================================
+// Built-in reverb stage (ESP32Synth_Reverb.hpp): SYNTH_REVERB_LINES int16 delay lines fed
+// back through a Hadamard matrix, with a damping low-pass and a slowly modulated read tap
+// per line. The lines live in PSRAM when the board has it; each slice is copied through a
+// small internal-RAM cache, so the per-sample loop never touches PSRAM or wraps a pointer.
+class SynthReverb : public SynthEffect {
+public:
+    ~SynthReverb();
+
+    // Allocates the delay lines (~32 KB at 48 kHz, size 100). size scales the room, 25..200 %.
+    // Call before addEffect(); false if there is no memory.
+    bool begin(uint32_t sampleRate = 48000, uint8_t size = 100);
+    void end();
+    bool isPsram() const { return _psram; }
+
+    void setDecay(uint16_t rt60Ms);                      // Time for the tail to fall by 60 dB
+    void setDamping(uint32_t cutoffCentiHz);             // Low-pass in the feedback loop
+    void setMix(uint8_t wet, uint8_t dry = 255);         // 0..255 each
+    void setModulation(uint16_t rateCentiHz, uint8_t depth); // depth: samples, up to SYNTH_REVERB_MOD_MAX
+
+    void     process(int32_t* mix, int frames) override;
+    uint32_t tailSamples() override;
+    void     reset() override;
+
+private:
+    void processSlice(int32_t* mix, int frames);
+
+    int16_t* _mem        = nullptr;
+    bool     _psram      = false;
+    uint32_t _sampleRate = 48000;
+    uint32_t _tail       = 0;
+    uint16_t _rt60Ms     = 2000;
+    uint32_t _dampCentiHz = 600000;
+
+    uint32_t _base[SYNTH_REVERB_LINES] = {}; // Line start in _mem
+    uint16_t _len[SYNTH_REVERB_LINES]  = {}; // Storage: delay + modulation margin
+    uint16_t _pos[SYNTH_REVERB_LINES]  = {}; // Write index
+    int32_t  _gain[SYNTH_REVERB_LINES] = {}; // Q15 feedback, matrix normalisation included
+    int32_t  _lp[SYNTH_REVERB_LINES]   = {}; // Damping state
+    int32_t  _dampA = 32767;                 // Q15 one-pole coefficient
+    int32_t  _wet   = 64, _dry = 256;        // Q8
+    uint32_t _lfoPhase = 0, _lfoInc = 0;     // Per-sample increment of a 32-bit phase
+    uint16_t _modRateCentiHz = 70;
+    int32_t  _modDepth = 6;                  // Samples
+
+    // Block cache: each line's reads for one slice, then its writes
+    int16_t _rd[SYNTH_REVERB_LINES][SYNTH_FX_BLOCK + 2 * SYNTH_REVERB_MOD_MAX + 1] __attribute__((aligned(4)));
+    int16_t _wr[SYNTH_REVERB_LINES][SYNTH_FX_BLOCK] __attribute__((aligned(4)));
+};
+
+// ====================================================================================
+//    DELAY LINE
+// ====================================================================================
+// int16 ring with a power-of-two length, so every index is one AND (ESP32Synth_DelayLine.hpp).
+// Delays count back from the write position: read(1) is the last sample written.
+// Fractional delays are 24.8 fixed point (256 = one sample) and must be >= 256.
+// The block reads copy 'n' consecutive samples, oldest first, starting 'delay' back:
+//   no feedback:     writeBlock(x, n); readBlock(y, d + n, n);   // y[i] = x[i] delayed by d
+//   feedback, d >= n: readBlock(y, d, n); ... writeBlock(x, n);
+class DelayLine {
+public:
+    ~DelayLine();
+
+    // Room for delays up to maxDelay samples (rounded up to a power of two). Lines of
+    // SYNTH_DELAY_PSRAM_MIN bytes or more go to PSRAM when the board has it.
+    bool     begin(uint32_t maxDelay);
+    void     end();
+    void     clear();
+    uint32_t length() const { return _buf ? _mask + 1 : 0; }
+    bool     isPsram() const { return _psram; }
+
+    void    write(int16_t x) { _buf[_w] = x; _w = (_w + 1) & _mask; }
+    int16_t read(uint32_t delay) const { return _buf[(_w - delay) & _mask]; }
+    int32_t readLinear(uint32_t delayQ8) const {
+        const uint32_t p = _w - (delayQ8 >> 8);
+        const int32_t  a = _buf[p & _mask];
+        return a + (((_buf[(p - 1) & _mask] - a) * (int32_t)(delayQ8 & 0xFF)) >> 8);
+    }
+    // 'state' is the tap's previous output (start it at 0). delayQ8 >= 384 (1.5 samples).
+    int32_t readAllpass(uint32_t delayQ8, int32_t& state) const;
+
+    void writeBlock(const int16_t* src, int n);
+    void readBlock(int16_t* dst, uint32_t delay, int n) const;
+    // Modulated: sample i is read 'delayQ8 + i * stepQ8' back from where it would be at delay 0
+    void readBlock(int32_t* dst, uint32_t delayQ8, int32_t stepQ8, int n, DelayInterp interp = DELAY_LINEAR, int32_t* state = nullptr) const;
+
+private:
+    int16_t* _buf   = nullptr;
+    uint32_t _mask  = 0;
+    uint32_t _w     = 0;
+    bool     _psram = false;
+};
+
+// ====================================================================================
+//    DELAY EFFECTS
+// ====================================================================================
+// Stages built on DelayLine (ESP32Synth_DelayFx.hpp), one line per mix channel. Times
+// can follow a tempo: setTempo(bpm, num, den) sets the time (SynthDelay) or the LFO
+// period (chorus, flanger) to num/den beats, e.g. (120, 3, 4) for a dotted eighth.
+
+// Echo with a low-passed feedback path. Time changes glide like a tape delay.
+class SynthDelay : public SynthEffect {
+public:
+    bool begin(uint32_t sampleRate = 48000, uint16_t maxMs = 1000); // ~2 bytes / sample / channel, PSRAM when large
+    void end();
+
+    void setTime(uint16_t ms);
+    void setTempo(float bpm, uint8_t num = 1, uint8_t den = 1);
+    void setFeedback(uint8_t feedback);          // 0..255 (255 = ~0.996)
+    void setTone(uint32_t cutoffCentiHz);        // Feedback low-pass: each repeat gets darker
+    void setMix(uint8_t wet, uint8_t dry = 255); // 0..255 each
+
+    void     process(int32_t* mix, int frames) override;
+    uint32_t tailSamples() override { return _tail; }
+    void     reset() override;
+
+private:
+    void updateTime();
+
+    DelayLine _line[SYNTH_MIX_CHANNELS];
+    uint32_t  _sampleRate  = 48000;
+    uint32_t  _maxQ8       = 0;                 // 0 until begin()
+    uint32_t  _timeUs      = 250000;
+    uint32_t  _delayQ8     = 0, _targetQ8 = 0;  // Current (gliding) and set delay
+    uint32_t  _tail        = 0;
+    int32_t   _feedback    = 128;               // Q8
+    int32_t   _toneA       = 32767;             // Q15 one-pole coefficient
+    uint32_t  _toneCentiHz = 400000;
+    int32_t   _lp[SYNTH_MIX_CHANNELS] = {};
+    int32_t   _wet = 96, _dry = 256;            // Q8
+};
+
+// Chorus: two modulated taps per channel around a 5-30 ms delay, no feedback.
+class SynthChorus : public SynthEffect {
+public:
+    bool begin(uint32_t sampleRate = 48000); // ~4 KB per channel at 48 kHz
+    void end();
+
+    void setDelay(uint16_t baseUs, uint16_t depthUs); // Centre delay and LFO swing, up to 40 ms together
+    void setRate(uint16_t centiHz);
+    void setTempo(float bpm, uint8_t num = 1, uint8_t den = 1);
+    void setMix(uint8_t wet, uint8_t dry = 255);
+    void setInterp(DelayInterp interp) { _interp = interp; }
+
+    void     process(int32_t* mix, int frames) override;
+    uint32_t tailSamples() override { return _tail; }
+    void     reset() override;
+
+private:
+    void update();
+
+    DelayLine   _line[SYNTH_MIX_CHANNELS];
+    uint32_t    _sampleRate = 48000;
+    uint32_t    _tail       = 0;
+    uint32_t    _baseQ8     = 0, _depthQ8 = 0;
+    uint16_t    _baseUs     = 12000, _depthUs = 4000;
+    float       _rateHz     = 0.8f;
+    uint32_t    _lfoPhase   = 0, _lfoInc = 0;
+    int32_t     _ap[SYNTH_MIX_CHANNELS][2] = {};
+    int32_t     _wet = 128, _dry = 256;          // Q8
+    DelayInterp _interp = DELAY_LINEAR;
+    int16_t     _in[SYNTH_FX_BLOCK];             // One channel of a slice, then its two taps
+    int32_t     _tap[2][SYNTH_FX_BLOCK];
+};
+
+// Flanger: one swept tap per channel over 0.1-10 ms, with positive or negative feedback.
+class SynthFlanger : public SynthEffect {
+public:
+    bool begin(uint32_t sampleRate = 48000); // ~1 KB per channel at 48 kHz
+    void end();
+
+    void setDelay(uint16_t baseUs, uint16_t depthUs); // Shortest delay and sweep, up to 10 ms together
+    void setRate(uint16_t centiHz);
+    void setTempo(float bpm, uint8_t num = 1, uint8_t den = 1);
+    void setFeedback(int8_t feedback);           // -127..127: negative hollows the comb
+    void setMix(uint8_t wet, uint8_t dry = 255);
+    void setInterp(DelayInterp interp) { _interp = interp; }
+
+    void     process(int32_t* mix, int frames) override;
+    uint32_t tailSamples() override { return _tail; }
+    void     reset() override;
+
+private:
+    void update();
+
+    DelayLine   _line[SYNTH_MIX_CHANNELS];
+    uint32_t    _sampleRate = 48000;
+    uint32_t    _tail       = 0;
+    uint32_t    _baseQ8     = 0, _depthQ8 = 0;
+    uint16_t    _baseUs     = 500, _depthUs = 3000;
+    float       _rateHz     = 0.25f;
+    uint32_t    _lfoPhase   = 0, _lfoInc = 0;
+    int32_t     _feedback   = 64;                // Q7
+    int32_t     _ap[SYNTH_MIX_CHANNELS] = {};
+    int32_t     _wet = 182, _dry = 182;          // Q8
+    DelayInterp _interp = DELAY_LINEAR;
 };
 
 class ESP32Synth {
@@ -336,6 +805,7 @@ public:
 
     // --- Custom Hooks Definitions ---
     typedef void (*SynthDSPCallback)(int32_t* mixBuffer, int numSamples);
+    typedef void (*SynthStereoDSPCallback)(int32_t* mixLR, int numFrames); // Interleaved L/R int32 frames
     typedef void (*SynthControlCallback)();
     typedef void (*SynthCustomOutputCallback)(int16_t* samples, int numSamples);
 
@@ -350,6 +820,13 @@ public:
 
     bool beginCustom(uint32_t sampleRate = 48000, SynthCustomOutputCallback customOutput = nullptr);
 
+    // DMA queue depth and render block size (default: SYNTH_DMA_BUF_LEN x SYNTH_DMA_BUF_COUNT).
+    // Takes effect at the next begin(); while running, the output is restarted on the same
+    // pins, which cuts any sounding notes. renderBlock = 0 renders whole DMA frames.
+    bool setLatencyProfile(SynthLatencyProfile profile);
+    bool setLatency(uint16_t dmaFrameLen, uint8_t dmaBufCount, uint16_t renderBlock = 0);
+    uint32_t getLatencyUs(); // DMA queue length in microseconds at the current sample rate
+
     void setSampleRate(uint32_t rate); // EXPERIMENTAL, Use at your own risk. Changing sample rate may cause instability.
     void setControlRateHz(uint16_t hz);
     void setMasterVolume(uint16_t volume);
@@ -361,9 +838,36 @@ public:
 
     // --- Custom Hooks ---
     void setCustomDSP(SynthDSPCallback dspFunc);
+#if SYNTH_ENABLE_STEREO
+    void setCustomDSPStereo(SynthStereoDSPCallback dspFunc);
+#endif
     void setCustomControl(SynthControlCallback ctrlFunc);
     void setCustomOutput(SynthCustomOutputCallback outFunc);
 
+    // --- Effect Chain (ESP32Synth_Effects.hpp) ---
+    // Stages run in order over the mix, before the setCustomDSP hooks. Edit the chain from
+    // one task; the effect objects must outlive their place in it. An edit the audio task
+    // does not pick up in time (a stalled pull-mode render loop) returns false and changes nothing.
+    bool    addEffect(SynthEffect* fx, int8_t position = -1); // -1 = last; false when full or already in
+    bool    removeEffect(SynthEffect* fx);  // Fades it out; returns once the audio task has let go of it
+    bool    clearEffects();
+    bool    setEffectBypass(SynthEffect* fx, bool bypass);
+    uint8_t getEffectCount();
+
+    // --- Mix Buses (ESP32Synth_Buses.hpp) ---
+    // Bus 0 is the main mix. Buses 1 .. SYNTH_MAX_BUSES - 1 each run their own chain, then
+    // feed the main mix (gain) and SYNTH_BUS_RETURN (send); the return runs its chain and
+    // joins the main mix too, all before the main chain. A bus without sounding voices is
+    // skipped once its effects' tails have died away. An effect sits in one chain at a time.
+    void    setVoiceBus(uint16_t voice, uint8_t bus);
+    uint8_t getVoiceBus(uint16_t voice);
+    void    setBusGain(uint8_t bus, uint8_t gain);  // 0..255 (255 = unity), bus 1.. or SYNTH_BUS_RETURN
+    void    setBusSend(uint8_t bus, uint8_t level); // To SYNTH_BUS_RETURN, after the bus chain and before its gain
+    bool    addBusEffect(uint8_t bus, SynthEffect* fx, int8_t position = -1); // Bus 0 = addEffect()
+    bool    removeBusEffect(uint8_t bus, SynthEffect* fx);
+    bool    clearBusEffects(uint8_t bus);
+    bool    isBusActive(uint8_t bus);               // Processed in the last block
+
     // --- Custom Output ---
     void generateSamples(int16_t* outBuffer, int numSamples);
     void generateSamplesStereo(int16_t* outBufferLR, int numSamplePairs);
@@ -377,10 +881,28 @@ public:
     void setPulseWidthBitDepth(uint8_t bits);
     void setPulseWidth(uint16_t voice, uint32_t width);
     void setCustomWave(uint16_t voice, SynthCustomWaveCallback cb);
+    void setPan(uint16_t voice, int8_t pan); // -127 left .. 0 centre .. 127 right (SYNTH_ENABLE_STEREO)
+
+    // --- Voice Allocator (ESP32Synth_Alloc.hpp) ---
+    // noteOnAuto() picks a free voice of the pool, or steals one (see SynthStealMode), and
+    // returns a handle for noteOffAuto(). Call both from one task, or guard them.
+    int32_t noteOnAuto(uint32_t freqCentiHz, uint16_t volume, const SynthPatch* patch = nullptr);
+    void    noteOffAuto(int32_t handle);
+    int16_t getAutoVoice(int32_t handle); // Voice the handle still owns, -1 once it was stolen
+    bool    setVoicePool(uint16_t firstVoice, uint16_t numVoices); // Default: every voice
+    void    setVoiceStealing(SynthStealMode mode, bool retriggerSameNote = false);
+    void    setPatch(uint16_t voice, const SynthPatch* patch);
 
     // --- Envelope ---
     void setEnv(uint16_t voice, uint16_t a, uint16_t d, uint8_t s, uint16_t r);
     void setSmoothEnv(uint16_t voice, bool enable);
+    void setEnvCurve(uint16_t voice, EnvCurve attack, EnvCurve decay, EnvCurve release);
+    void setEnvelope(uint16_t voice, const SynthEnvelope* env); // nullptr: back to setEnv()'s ADSR
+
+    // --- Filter (ESP32Synth_Filter.hpp, SYNTH_ENABLE_FILTER) ---
+    void setFilter(uint16_t voice, FilterType type, uint32_t cutoffCentiHz, uint8_t resonance = 0); // resonance 0 .. 255
+    void setFilterEnv(uint16_t voice, uint16_t a, uint16_t d, uint8_t s, uint16_t r, int16_t amountCents);
+    void setFilterKeyTrack(uint16_t voice, uint8_t amount); // 0 = fixed cutoff .. 255 = follows the note from C4
 
     // --- Phase Control ---
     void setStartPhase(uint16_t voice, uint16_t phaseDegrees);
@@ -397,8 +919,10 @@ public:
     void slideVolTo(uint16_t voice, uint16_t endVol, uint32_t durationMs);
 
     // --- Wavetable & Instruments ---
-    void setWavetable(uint16_t voice, const void* data, uint32_t size, BitDepth depth);
-    void registerWavetable(uint16_t id, const void* data, uint32_t size, BitDepth depth);
+    void setWavetable(uint16_t voice, const void* data, uint32_t size, BitDepth depth, bool interpolate = false);
+    void registerWavetable(uint16_t id, const void* data, uint32_t size, BitDepth depth, bool interpolate = false);
+    void setWavetableMip(uint16_t voice, const WavetableMip* mip, bool interpolate = false);
+    void registerWavetableMip(uint16_t id, const WavetableMip* mip, bool interpolate = false);
     void setInstrument(uint16_t voice, Instrument* inst);
     void setInstrument(uint16_t voice, Instrument_Sample* inst);
     void detachInstrument(uint16_t voice, WaveType newWaveType);
@@ -407,6 +931,7 @@ public:
     bool registerSample(uint16_t sampleId, const void* data, uint32_t length, uint32_t sampleRate, uint32_t rootFreqCentiHz, BitDepth depth = BITS_16);
     void setSample(uint16_t voice, uint16_t sampleId, LoopMode loopMode = LOOP_OFF, uint32_t loopStart = 0, uint32_t loopEnd = 0);
     void setSampleLoop(uint16_t voice, LoopMode loopMode, uint32_t loopStart, uint32_t loopEnd);
+    void setSampleInterp(uint16_t voice, SampleInterp mode);
 
     // --- Arpeggiator ---
     template <typename... Args>
@@ -447,10 +972,27 @@ public:
 
     // --- Performance & Debug ---
     float getCPULoad(); // Returns 0.0 to 100.0%
+    bool setDualCore(bool enable); // Split voice rendering across both cores (see SYNTH_ENABLE_DUAL_CORE)
+    bool isDualCore();
+
+    // --- Command Queue (thread-safe voice API, see ESP32Synth_Config.hpp) ---
+    bool setCommandQueue(bool enable);
+    bool isCommandQueueEnabled();
+    bool beginBatch();  // Commands from this task are held back...
+    void commitBatch(); // ...and published together, landing in the same block
+
+    // --- Sample-Accurate Events ---
+    // sampleTime is on the engine's sample clock (getSampleTime()); the event takes effect on
+    // that exact sample even inside a DMA block. Times already past play at the next block.
+    bool noteOnAt(uint16_t voice, uint32_t freqCentiHz, uint16_t volume, uint32_t sampleTime);
+    bool noteOffAt(uint16_t voice, uint32_t sampleTime);
+    uint32_t getSampleTime(); // First sample of the next block to be rendered
+    SynthRenderProfile getRenderProfile(); // Last published window (enabled == false if compiled out)
+    void resetRenderProfile();
 
     // --- PWM ---
     volatile bool _running = false;
-    int16_t* pwm_ping_pong_buf[2] = {nullptr, nullptr};
+    uint16_t* pwm_ping_pong_buf[2] = {nullptr, nullptr}; // LEDC duty values (MASTER_PWM10)
     volatile int pwm_active_buf = 0;
     volatile int pwm_read_idx = 0;
     uint32_t pwm_block_samples = 0;
@@ -463,16 +1005,208 @@ private:
         const void* data;
         uint32_t    size;
         BitDepth    depth;
+        bool        interp;
+        const WavetableMip* mip;
     };
 
     StreamTrack   streams[MAX_STREAMS];
     TaskHandle_t  streamTaskHandle = NULL;
     TaskHandle_t  audioTaskHandle = NULL;
     static void   sdLoaderTask(void* param);
+    void          startStream(uint16_t voice, int8_t streamId, uint16_t volume, bool play);
+    void          detachStream(uint16_t voice, int8_t streamId);
+    void          applyArpeggio(uint16_t voice, uint16_t durationMs, const uint32_t* notes, size_t count);
     bool parseWavHeader(SYNTH_FILE_REF file, uint32_t& outSampleRate, uint32_t& outDataPos, uint32_t& outDataSize, uint16_t& outChannels, uint16_t& outBits);
 
     Voice          voices[MAX_VOICES];
     WavetableEntry wavetables[MAX_WAVETABLES];
+
+    // --- Command Queue (ESP32Synth_Commands.hpp) ---
+    enum CommandOp : uint8_t {
+        CMD_NOTE_ON, CMD_NOTE_OFF, CMD_SET_FREQUENCY, CMD_SET_VOLUME, CMD_SET_WAVE,
+        CMD_SET_PULSE_WIDTH, CMD_SET_CUSTOM_WAVE, CMD_SET_ENV, CMD_SET_SMOOTH_ENV,
+        CMD_SET_START_PHASE, CMD_SET_CURRENT_PHASE, CMD_SET_VIBRATO, CMD_SET_VIBRATO_PHASE,
+        CMD_SET_TREMOLO, CMD_SET_TREMOLO_PHASE, CMD_SLIDE_FREQ, CMD_SLIDE_FREQ_TO,
+        CMD_SLIDE_VOL, CMD_SLIDE_VOL_TO, CMD_SET_WAVETABLE, CMD_SET_INSTRUMENT,
+        CMD_SET_INSTRUMENT_SAMPLE, CMD_DETACH_INSTRUMENT, CMD_SET_SAMPLE, CMD_SET_SAMPLE_LOOP,
+        CMD_DETACH_ARPEGGIO, CMD_SET_ARP_NOTES, CMD_SET_ARPEGGIO, CMD_SETUP_STREAM,
+        CMD_PLAY_STREAM, CMD_STOP_STREAM, CMD_PAUSE_STREAM, CMD_RESUME_STREAM,
+        CMD_SEEK_STREAM, CMD_SET_STREAM_LOOP,
+        CMD_SET_WAVETABLE_MIP, CMD_SET_SAMPLE_INTERP, CMD_SET_PAN,
+        CMD_SET_PATCH, CMD_STEAL_VOICE, CMD_SET_ENV_CURVE, CMD_SET_ENVELOPE,
+        CMD_SET_FILTER, CMD_SET_FILTER_ENV, CMD_SET_FILTER_KEYTRACK, CMD_SET_VOICE_BUS,
+        CMD_TIMED = 0x80 // Flag: hold in the event list until 'when' (noteOnAt/noteOffAt)
+    };
+
+    struct SynthCommand {
+        uint32_t    seq;      // Ring slot sequence number (bounded MPSC ring)
+        uint8_t     op;       // CommandOp
+        uint8_t     batchLen; // On the first command of a group: how many were published together
+        uint16_t    voice;
+        uint32_t    a, b, c;
+        uint32_t    when;     // Sample time for CMD_TIMED commands
+        const void* p;
+    };
+
+    struct CommandBatch {
+        TaskHandle_t owner;
+        uint16_t     count;
+        SynthCommand cmds[SYNTH_CMD_BATCH_MAX];
+    };
+
+    SynthCommand* _cmdRing = nullptr;
+    CommandBatch* _cmdBatches = nullptr;
+    volatile bool _cmdQueueOn = false;
+    uint32_t      _cmdEnqueuePos = 0;
+    uint32_t      _cmdDequeuePos = 0;
+    TaskHandle_t  _renderTask = NULL; // Task currently running render(); its API calls apply directly
+
+    // The task that drains the ring: the engine's own audio task from the moment it is
+    // created (FreeRTOS stores the handle before the task first runs), otherwise the task
+    // that last called render() (pull mode). NULL before any render, when direct is safe.
+    TaskHandle_t renderTask() const { return audioTaskHandle ? audioTaskHandle : _renderTask; }
+
+    // Pending timed events, sorted by 'when'. Only the render task touches the list.
+    SynthCommand  _events[SYNTH_EVENT_QUEUE_LEN];
+    uint16_t      _numEvents = 0;
+    volatile uint32_t _sampleClock = 0; // Samples rendered since begin()
+
+    bool queueCommand(uint8_t op, uint16_t voice, uint32_t a = 0, uint32_t b = 0, uint32_t c = 0, const void* p = nullptr);
+    bool queueCommands(SynthCommand* cmds, int n);
+    bool pushCommands(SynthCommand* cmds, int n);
+    void drainCommands();
+    void discardCommands();
+    void applyCommand(const SynthCommand& cmd);
+    CommandBatch* findBatch(TaskHandle_t owner);
+    bool allocCommandRing();
+    bool scheduleCommand(uint8_t op, uint16_t voice, uint32_t when, uint32_t a = 0, uint32_t b = 0);
+    bool insertTimedEvent(const SynthCommand& cmd);
+    int  applyDueEvents(int pos, int samples);
+    void renderVoiceSpan(int32_t* mixBuffer, int samples);
+
+    // --- Active Voice Index ---
+    // One bit per sounding voice, mirrored from Voice::active. render() and processControl()
+    // walk the set bits instead of scanning every slot, so per-block overhead follows the
+    // number of sounding voices rather than MAX_VOICES. Bits are set from the caller's task
+    // (noteOn, playStream) and cleared from the audio task, hence the atomic read-modify-write.
+    static constexpr int VOICE_MASK_WORDS = (MAX_VOICES + 31) / 32;
+    uint32_t       _activeMask[VOICE_MASK_WORDS] = {};
+
+    inline void markVoiceActive(uint16_t v) {
+        voices[v].active = true;
+        __atomic_fetch_or(&_activeMask[v >> 5], 1u << (v & 31), __ATOMIC_SEQ_CST);
+    }
+    // Index of the first active voice after 'v' (pass -1 to start), or -1 when none is left.
+    inline int nextActiveVoice(int v) const {
+        v++;
+        int w = v >> 5;
+        if (w >= VOICE_MASK_WORDS) return -1;
+        uint32_t bits = __atomic_load_n(&_activeMask[w], __ATOMIC_RELAXED) & (0xFFFFFFFFu << (v & 31));
+        while (!bits) {
+            if (++w >= VOICE_MASK_WORDS) return -1;
+            bits = __atomic_load_n(&_activeMask[w], __ATOMIC_RELAXED);
+        }
+        return (w << 5) + __builtin_ctz(bits);
+    }
+    // --- Per-block kernel buckets (filled by render()) ---
+    // Kept as members rather than on the 4 KB audio task stack.
+    struct BlockVoice {
+        uint16_t voice;
+        uint8_t  kernel;   // RenderKernel
+        uint8_t  bus;      // Mix bus for this block (Voice::bus, or 0 while routing is off)
+        int32_t  startEnv;
+        int32_t  envStep;
+    };
+    BlockVoice     _blockVoices[MAX_VOICES];
+    uint16_t       _blockOrder[MAX_VOICES];
+    uint16_t       _bucketStart[RK_NUM_KERNELS + 1];
+
+    struct KernelTiming {
+        uint32_t cycles[RK_NUM_KERNELS];
+        uint16_t voices[RK_NUM_KERNELS];
+    };
+    void renderBuckets(int32_t* const* busOut, int samples, int from, int to, KernelTiming* timing, bool onWorker);
+
+    // --- Voice Allocator (ESP32Synth_Alloc.hpp) ---
+    // Only the task calling noteOnAuto()/noteOffAuto() writes these; the render task reads
+    // the note a stolen voice is waiting for (patch / freq / vol / cancel).
+    static constexpr uint16_t NO_VOICE        = 0xFFFF;
+    static constexpr int      ALLOC_HASH_BITS = 6;
+    enum AllocState : uint8_t { ALLOC_FREE, ALLOC_HELD, ALLOC_RELEASED };
+    enum AllocList  : uint8_t { LIST_AGE, LIST_RELEASED };
+
+    struct AllocSlot {
+        const SynthPatch* patch;
+        uint32_t          freq;        // Same-note key
+        uint16_t          vol;
+        uint16_t          gen;         // Bumped on every allocation, stale handles fail
+        uint16_t          prev[2];     // Links in the age list and the released list (AllocList)
+        uint16_t          next[2];
+        uint16_t          hashNext;
+        uint8_t           ons;         // noteOn() calls issued; reclaimable once Voice::noteCount matches
+        uint8_t           state;       // AllocState
+        bool              cancel;      // noteOffAuto() came before the stolen voice could start it
+    };
+
+    AllocSlot*     _alloc = nullptr;  // MAX_VOICES slots, allocated on first use
+    uint16_t*      _allocFree = nullptr;
+    uint16_t       _allocFreeCount = 0;
+    uint16_t       _allocHead[2] = { NO_VOICE, NO_VOICE }; // Oldest note / longest released
+    uint16_t       _allocTail[2] = { NO_VOICE, NO_VOICE };
+    uint16_t       _allocHash[1 << ALLOC_HASH_BITS];
+    uint32_t       _allocMask[VOICE_MASK_WORDS] = {};
+    uint16_t       _poolFirst = 0;
+    uint16_t       _poolCount = MAX_VOICES;
+    SynthStealMode _stealMode = STEAL_OLDEST;
+    bool           _retrigger = false;
+
+    bool allocVoicePool();
+    void resetVoicePool();
+    void allocListAppend(uint8_t list, uint16_t v);
+    void allocListRemove(uint8_t list, uint16_t v);
+    void allocRelease(uint16_t v);
+    int  allocFindNote(uint32_t freq, const SynthPatch* patch);
+    int  allocPopFree();
+    int  allocPickVictim();
+    void stealVoice(uint16_t v);
+    bool startStolenVoice(uint16_t v);
+
+#if SYNTH_ENABLE_FILTER
+    void updateFilterPitch(Voice* vo); // ESP32Synth_Filter.hpp
+#endif
+
+#if SYNTH_ENABLE_DUAL_CORE
+    // --- Dual-Core Voice Rendering (ESP32Synth_DualCore.hpp) ---
+    volatile bool     _dualCore = false;
+    volatile bool     _workerQuit = false;
+    TaskHandle_t      _workerTaskHandle = NULL;
+    SemaphoreHandle_t _workerStart = NULL;
+    SemaphoreHandle_t _workerDone = NULL;
+    int32_t*          _workerMix = nullptr;  // One block for the main mix
+    int32_t*          _workerBusMix = nullptr; // One block per other bus, once buses are in use
+    int32_t*          _workerOut[SYNTH_MAX_BUSES];
+    int               _workerMixLen = 0;
+    int               _workerFrom = 0;
+    int               _workerTo = 0;
+    int               _workerSamples = 0;
+    KernelTiming      _workerTiming;
+    uint16_t          _kernelCost[RK_NUM_KERNELS]; // Cycles per voice per sample, 8.8 fixed point
+
+    static void voiceWorkerTask(void* param);
+    bool startVoiceWorker();
+    void stopVoiceWorker();
+    void allocWorkerBusMix();
+    bool renderVoicesDual(int samples, int numBlockVoices);
+#endif
+
+    // Call after Voice::active was cleared. Re-checks the flag so a noteOn racing with the
+    // audio task retiring the same voice cannot leave a sounding voice out of the index.
+    inline void clearVoiceActive(uint16_t v) {
+        __atomic_fetch_and(&_activeMask[v >> 5], ~(1u << (v & 31)), __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&voices[v].active, __ATOMIC_SEQ_CST)) {
+            __atomic_fetch_or(&_activeMask[v >> 5], 1u << (v & 31), __ATOMIC_SEQ_CST);
+        }
+    }
     SampleData     samples[MAX_SAMPLES];
 
     uint32_t      _sampleRate = 48000;
@@ -499,37 +1233,105 @@ private:
     int _wsPin   = -1;
     int _mclkPin = -1;
 
+    // Runtime latency settings (setLatency)
+    uint16_t _dmaBufLen   = SYNTH_DMA_BUF_LEN;
+    uint8_t  _dmaBufCount = SYNTH_DMA_BUF_COUNT;
+    uint16_t _renderBlock = 0; // 0 = the whole DMA frame
+
     static void audioTask(void* param);
-    void render(void* buffer, int32_t* mixBuffer, int samples);
+    void render(void* buffer, int32_t* mixBuffer, int samples, MasterFormat fmt);
     void renderLoop();
     void processControl();
     int16_t fetchWavetableSample(uint16_t id, uint32_t phase);
 
     SynthDSPCallback          _customDSP     = nullptr;
+#if SYNTH_ENABLE_STEREO
+    SynthStereoDSPCallback    _customDSPStereo = nullptr;
+#endif
     SynthControlCallback      _customControl = nullptr;
     SynthCustomOutputCallback _customOutput  = nullptr;
 
+    // --- Effect Chain (ESP32Synth_Effects.hpp) ---
+    // Double-buffered stage list: edits fill the idle copy and publish it with one store.
+    struct FxChain {
+        SynthEffect*     stages[2][SYNTH_MAX_EFFECTS];
+        uint8_t          count[2];
+        volatile uint8_t live;  // Published copy
+        volatile uint8_t inUse; // Copy the audio task read at its last block
+    };
+    FxChain  _fxChain = {};
+    int32_t* _fxScratch = nullptr; // Two slices: dry copy for crossfades, then SynthEffect::scratch
+
+    bool allocFxScratch();
+    bool fxWaitFor(const volatile uint8_t* v, uint8_t want);
+    bool fxChainSync(FxChain& ch);
+    bool fxChainAdd(FxChain& ch, SynthEffect* fx, int position);
+    bool fxChainRemove(FxChain& ch, SynthEffect* fx);
+    bool fxChainClear(FxChain& ch);
+    void runFxChain(FxChain& ch, int32_t* mix, int frames);
+    uint32_t fxChainTail(FxChain& ch);
+
+    // --- Mix Buses (ESP32Synth_Buses.hpp) ---
+    struct MixBus {
+        FxChain  chain;
+        int32_t  gain;   // Q8, 256 = unity
+        int32_t  send;   // Q8, to the return bus
+        uint32_t quiet;  // Samples since the bus last had input
+        bool     active; // Processed in the last block
+    };
+    MixBus             _buses[SYNTH_MAX_BUSES + 1] = {}; // [0] unused (main mix), [SYNTH_MAX_BUSES] = return
+    int32_t* volatile  _busMix = nullptr;  // Buses 1 .. SYNTH_MAX_BUSES, _busLen frames each
+    int                _busLen = 0;
+    int32_t*           _busOut[SYNTH_MAX_BUSES]; // Where each bus's voices go in the current span
+    int32_t*           _blockMix = nullptr;      // render()'s mix; spans are offsets into it
+    int                _blockSamples = 0;
+    uint32_t           _blockBuses = 0;          // Buses cleared for this block, bit per bus
+    uint32_t           _spanBuses = 0;           // Buses with voices in the current span
+    bool               _busRouting = false;      // This block renders into the bus buffers
+
+    bool      allocBusMix();
+    int32_t*  busBuffer(int b) { return _busMix + (b - 1) * _busLen * SYNTH_MIX_CHANNELS; }
+    FxChain*  busChain(uint8_t bus);
+    void      routeBuses(int32_t* span, uint32_t used);
+    void      mixBuses(int32_t* mix, int samples);
+
     // --- Performance Measurement ---
     volatile float _dspLoad = 0.0f;
+
+#if SYNTH_ENABLE_PROFILER
+    struct ProfAccum {
+        uint64_t sum;
+        uint32_t count;
+        uint32_t min;
+        uint32_t max;
+    };
+
+    uint32_t           _profBlock[PROF_NUM_STAGES] = {};
+    ProfAccum          _profStageAcc[PROF_NUM_STAGES] = {};
+    ProfAccum          _profKernelAcc[PROF_NUM_KERNELS] = {};
+    ProfAccum          _profKernelAccWorker[PROF_NUM_KERNELS] = {}; // Dual-core worker, folded in per block
+    uint32_t           _profBlocks = 0;
+    uint32_t           _profWindowId = 0;
+    volatile bool      _profResetPending = true;
+    volatile uint32_t  _profSeq = 0;
+    SynthRenderProfile _profile = {};
+
+    static inline void profAdd(ProfAccum& a, uint32_t cycles) {
+        a.sum += cycles;
+        a.count++;
+        if (cycles < a.min) a.min = cycles;
+        if (cycles > a.max) a.max = cycles;
+    }
+    void profResetWindow();
+    void profEndBlock(int samples);
+    void profMergeWorker();
+#endif
 };
 
 template <typename... Args>
 void ESP32Synth::setArpeggio(uint16_t voice, uint16_t durationMs, Args... freqs) {
-    if (voice >= MAX_VOICES) return;
-
     uint32_t tempNotes[] = { (uint32_t)freqs... };
-    size_t count = sizeof...(freqs);
-    if (count > MAX_ARP_NOTES) count = MAX_ARP_NOTES;
-
-    Voice* v = &voices[voice];
-    for (size_t i = 0; i < count; i++) {
-        v->arpNotes[i] = tempNotes[i];
-    }
-    v->arpLen         = count;
-    v->arpSpeedMs     = durationMs;
-    v->arpIdx         = 0;
-    v->arpTickCounter = 0;
-    v->arpActive      = true;
+    applyArpeggio(voice, durationMs, tempNotes, sizeof...(freqs));
 }
 
 #endif // ESP32_SYNTH_H
\ No newline at end of file
@@ -0,0 +1,259 @@
+#pragma once
+#include "ESP32Synth.h"
+
+// ====================================================================================
+//    VOICE ALLOCATOR
+// ====================================================================================
+// noteOnAuto() hands out the voices of the pool (setVoicePool, all voices by default).
+// Free voices sit on a stack. Allocated ones are linked into an age list (oldest note at
+// the head) and, after noteOffAuto(), also into a released list (longest released at the
+// head), so each steal order is a list head. A note that has died out keeps its voice
+// until the free stack runs dry: one pass over the allocated-but-silent bits (32 voices
+// per word) then returns all of them at once. Same-note lookups go through a small hash
+// on the frequency; only STEAL_QUIETEST has to visit every allocated voice.
+//
+// A stolen voice that is still audible is not restarted on the spot: stealVoice() fades
+// it out over SYNTH_STEAL_FADE_SAMPLES and render() starts the waiting note as soon as it
+// is silent (startStolenVoice), so a steal never clicks.
+//
+// Handles are (generation << 16) | voice. Once the voice plays another note the old
+// handle stops matching and noteOffAuto() ignores it.
+
+static inline uint32_t allocHashIndex(uint32_t freq, int bits) {
+    return (freq * 2654435761u) >> (32 - bits);
+}
+
+bool ESP32Synth::allocVoicePool() {
+    if (_alloc) return true;
+    _alloc     = (AllocSlot*)heap_caps_malloc(MAX_VOICES * sizeof(AllocSlot), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    _allocFree = (uint16_t*)heap_caps_malloc(MAX_VOICES * sizeof(uint16_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!_alloc || !_allocFree) {
+        if (_alloc) heap_caps_free(_alloc);
+        if (_allocFree) heap_caps_free(_allocFree);
+        _alloc     = nullptr;
+        _allocFree = nullptr;
+        return false;
+    }
+    memset(_alloc, 0, MAX_VOICES * sizeof(AllocSlot));
+    resetVoicePool();
+    return true;
+}
+
+// Forgets every allocation. Voices still sounding are left to finish; generations are
+// kept so older handles stay invalid.
+void ESP32Synth::resetVoicePool() {
+    for (int v = 0; v < MAX_VOICES; v++) {
+        AllocSlot* s = &_alloc[v];
+        s->prev[LIST_AGE] = s->next[LIST_AGE] = NO_VOICE;
+        s->prev[LIST_RELEASED] = s->next[LIST_RELEASED] = NO_VOICE;
+        s->hashNext = NO_VOICE;
+        s->ons      = voices[v].noteCount;
+        s->state    = ALLOC_FREE;
+        s->cancel   = false;
+    }
+    for (int l = 0; l < 2; l++) _allocHead[l] = _allocTail[l] = NO_VOICE;
+    for (int b = 0; b < (1 << ALLOC_HASH_BITS); b++) _allocHash[b] = NO_VOICE;
+    memset(_allocMask, 0, sizeof(_allocMask));
+
+    // Pushed top-down so the lowest voice is handed out first
+    _allocFreeCount = 0;
+    for (int v = _poolFirst + _poolCount - 1; v >= _poolFirst; v--) _allocFree[_allocFreeCount++] = v;
+}
+
+bool ESP32Synth::setVoicePool(uint16_t firstVoice, uint16_t numVoices) {
+    if (numVoices == 0 || firstVoice >= MAX_VOICES || numVoices > MAX_VOICES - firstVoice) return false;
+    _poolFirst = firstVoice;
+    _poolCount = numVoices;
+    if (!allocVoicePool()) return false;
+    resetVoicePool();
+    return true;
+}
+
+void ESP32Synth::setVoiceStealing(SynthStealMode mode, bool retriggerSameNote) {
+    _stealMode = mode;
+    _retrigger = retriggerSameNote;
+}
+
+void ESP32Synth::setPatch(uint16_t voice, const SynthPatch* patch) {
+    if (queueCommand(CMD_SET_PATCH, voice, 0, 0, 0, patch)) return;
+    if (voice >= MAX_VOICES || patch == nullptr) return;
+    if (patch->inst) { // Tracker instruments bring their own envelope
+        setInstrument(voice, patch->inst);
+        return;
+    }
+    if (patch->instSample) {
+        setInstrument(voice, patch->instSample);
+    } else {
+        if (voices[voice].inst || voices[voice].instSample) setInstrument(voice, (Instrument*)nullptr);
+        setWave(voice, patch->wave);
+    }
+    setEnv(voice, patch->attackMs, patch->decayMs, patch->sustain, patch->releaseMs);
+}
+
+// --- Lists ---
+
+void ESP32Synth::allocListAppend(uint8_t list, uint16_t v) {
+    AllocSlot* s = &_alloc[v];
+    s->prev[list] = _allocTail[list];
+    s->next[list] = NO_VOICE;
+    if (_allocTail[list] != NO_VOICE) _alloc[_allocTail[list]].next[list] = v;
+    else _allocHead[list] = v;
+    _allocTail[list] = v;
+}
+
+void ESP32Synth::allocListRemove(uint8_t list, uint16_t v) {
+    AllocSlot* s = &_alloc[v];
+    if (s->prev[list] != NO_VOICE) _alloc[s->prev[list]].next[list] = s->next[list];
+    else _allocHead[list] = s->next[list];
+    if (s->next[list] != NO_VOICE) _alloc[s->next[list]].prev[list] = s->prev[list];
+    else _allocTail[list] = s->prev[list];
+    s->prev[list] = s->next[list] = NO_VOICE;
+}
+
+// Takes an allocated voice off every list, the hash and the bitmap.
+void ESP32Synth::allocRelease(uint16_t v) {
+    AllocSlot* s = &_alloc[v];
+    if (s->state == ALLOC_FREE) return;
+    allocListRemove(LIST_AGE, v);
+    if (s->state == ALLOC_RELEASED) allocListRemove(LIST_RELEASED, v);
+
+    uint16_t* link = &_allocHash[allocHashIndex(s->freq, ALLOC_HASH_BITS)];
+    while (*link != NO_VOICE && *link != v) link = &_alloc[*link].hashNext;
+    if (*link == v) *link = s->hashNext;
+    s->hashNext = NO_VOICE;
+
+    _allocMask[v >> 5] &= ~(1u << (v & 31));
+    s->state = ALLOC_FREE;
+}
+
+int ESP32Synth::allocFindNote(uint32_t freq, const SynthPatch* patch) {
+    for (uint16_t v = _allocHash[allocHashIndex(freq, ALLOC_HASH_BITS)]; v != NO_VOICE; v = _alloc[v].hashNext) {
+        if (_alloc[v].freq == freq && _alloc[v].patch == patch) return v;
+    }
+    return -1;
+}
+
+int ESP32Synth::allocPopFree() {
+    if (_allocFreeCount == 0) {
+        // Reclaim every note that has ended: allocated, not sounding, not waiting for a
+        // steal and with every noteOn() it was given already applied (the queue may still
+        // hold one).
+        int last = _poolFirst + _poolCount - 1;
+        for (int w = _poolFirst >> 5; w <= (last >> 5); w++) {
+            uint32_t bits = _allocMask[w] & ~__atomic_load_n(&_activeMask[w], __ATOMIC_RELAXED);
+            while (bits) {
+                uint16_t v = (w << 5) + __builtin_ctz(bits);
+                bits &= bits - 1;
+                const Voice* vo = &voices[v];
+                if (vo->active || vo->stealFade || (int8_t)(vo->noteCount - _alloc[v].ons) < 0) continue;
+                allocRelease(v);
+                _allocFree[_allocFreeCount++] = v;
+            }
+        }
+    }
+    return _allocFreeCount ? _allocFree[--_allocFreeCount] : -1;
+}
+
+int ESP32Synth::allocPickVictim() {
+    switch (_stealMode) {
+        case STEAL_NONE:
+            return -1;
+        case STEAL_RELEASED_FIRST:
+            if (_allocHead[LIST_RELEASED] != NO_VOICE) return _allocHead[LIST_RELEASED];
+            break;
+        case STEAL_QUIETEST: {
+            // Released notes first, so they win a tie; within a list the older one wins.
+            int      best      = -1;
+            uint64_t bestLevel = UINT64_MAX;
+            for (uint16_t v = _allocHead[LIST_RELEASED]; v != NO_VOICE; v = _alloc[v].next[LIST_RELEASED]) {
+                uint64_t level = voices[v].active ? (uint64_t)voices[v].currEnvVal * voices[v].vol : 0;
+                if (level < bestLevel) { best = v; bestLevel = level; }
+            }
+            for (uint16_t v = _allocHead[LIST_AGE]; v != NO_VOICE; v = _alloc[v].next[LIST_AGE]) {
+                if (_alloc[v].state != ALLOC_HELD) continue;
+                uint64_t level = voices[v].active ? (uint64_t)voices[v].currEnvVal * voices[v].vol : 0;
+                if (level < bestLevel) { best = v; bestLevel = level; }
+            }
+            return best;
+        }
+        default:
+            break;
+    }
+    return (_allocHead[LIST_AGE] != NO_VOICE) ? _allocHead[LIST_AGE] : -1; // STEAL_OLDEST
+}
+
+// --- Notes ---
+
+int32_t ESP32Synth::noteOnAuto(uint32_t freqCentiHz, uint16_t volume, const SynthPatch* patch) {
+    if (!allocVoicePool()) return -1;
+
+    int v = _retrigger ? allocFindNote(freqCentiHz, patch) : -1;
+    if (v < 0) v = allocPopFree();
+    if (v < 0) v = allocPickVictim();
+    if (v < 0) return -1;
+
+    AllocSlot* s = &_alloc[v];
+    allocRelease(v);
+    s->patch = patch;
+    s->freq  = freqCentiHz;
+    s->vol   = volume;
+    s->gen   = (s->gen + 1) & 0x7FFF;
+    s->state = ALLOC_HELD;
+    s->ons++;
+    __atomic_store_n(&s->cancel, false, __ATOMIC_RELEASE);
+    allocListAppend(LIST_AGE, v);
+    uint16_t* bucket = &_allocHash[allocHashIndex(freqCentiHz, ALLOC_HASH_BITS)];
+    s->hashNext = *bucket;
+    *bucket     = v;
+    _allocMask[v >> 5] |= 1u << (v & 31);
+
+    const Voice* vo = &voices[v];
+    if (vo->active || vo->stealFade) {
+        stealVoice(v); // Fades the old note out, render() then starts this one
+    } else {
+        if (patch) setPatch(v, patch);
+        noteOn(v, freqCentiHz, volume);
+    }
+    return ((int32_t)s->gen << 16) | v;
+}
+
+int16_t ESP32Synth::getAutoVoice(int32_t handle) {
+    if (handle < 0 || !_alloc) return -1;
+    uint16_t v = handle & 0xFFFF;
+    if (v >= MAX_VOICES) return -1;
+    const AllocSlot* s = &_alloc[v];
+    return (s->state != ALLOC_FREE && s->gen == (uint16_t)(handle >> 16)) ? v : -1;
+}
+
+void ESP32Synth::noteOffAuto(int32_t handle) {
+    int v = getAutoVoice(handle);
+    if (v < 0 || _alloc[v].state != ALLOC_HELD) return;
+    _alloc[v].state = ALLOC_RELEASED;
+    allocListAppend(LIST_RELEASED, v);
+    __atomic_store_n(&_alloc[v].cancel, true, __ATOMIC_RELEASE); // In case the note is still waiting to start
+    noteOff(v);
+}
+
+void ESP32Synth::stealVoice(uint16_t voice) {
+    if (queueCommand(CMD_STEAL_VOICE, voice)) return;
+    if (voice >= MAX_VOICES) return;
+    Voice* vo = &voices[voice];
+    vo->envState    = ENV_RELEASE;
+    vo->envSegState = ENV_SEG_RESTART;
+    __atomic_store_n(&vo->stealFade, true, __ATOMIC_RELEASE);
+    // Went silent in the meantime: nothing to fade, start the note now.
+    if (!__atomic_load_n(&vo->active, __ATOMIC_ACQUIRE)) startStolenVoice(voice);
+}
+
+// Starts the note a faded-out voice was stolen for. Returns whether the voice sounds.
+bool IRAM_ATTR ESP32Synth::startStolenVoice(uint16_t v) {
+    if (!__atomic_exchange_n(&voices[v].stealFade, false, __ATOMIC_ACQ_REL)) return false;
+    const AllocSlot* s = &_alloc[v];
+    if (__atomic_load_n(&s->cancel, __ATOMIC_ACQUIRE)) {
+        voices[v].noteCount++; // Counts as applied, the voice can be reclaimed
+        return false;
+    }
+    if (s->patch) setPatch(v, s->patch);
+    noteOn(v, s->freq, s->vol);
+    return voices[v].active;
+}
@@ -11,6 +11,23 @@
     #define SYNTH_PWM_MODE LEDC_LOW_SPEED_MODE
 #endif
 
+// Shared LUTs (sine, envelope curve, filter cutoff), rebuilt by every begin
+static void buildLUTs() {
+    for (int i = 0; i < SINE_LUT_SIZE; i++) {
+        sineLUT[i] = (int16_t)(sin(i * 2.0 * PI / (double)SINE_LUT_SIZE) * 32767.0);
+    }
+    for (int i = 0; i <= ENV_CURVE_LUT_SIZE; i++) {
+        const double k = SYNTH_ENV_CURVE_STEEPNESS;
+        envCurveLUT[i] = (uint16_t)((exp(k * i / ENV_CURVE_LUT_SIZE) - 1.0) / (exp(k) - 1.0) * 32768.0 + 0.5);
+    }
+#if SYNTH_ENABLE_FILTER
+    for (int i = 0; i < SVF_TAN_LUT_SIZE; i++) {
+        double fc = pow(2.0, (SVF_PITCH_MIN + (i << SVF_PITCH_STEP_BITS)) / 1200.0); // fc / fs
+        svfTanLUT[i] = (uint32_t)(tan(PI * fc) * 16777216.0 + 0.5);
+    }
+#endif
+}
+
 // Auto-Synchronized ISR: Triggered by the hardware PWM's own heartbeat pulse
 static IRAM_ATTR void ledc_ovf_isr(void *user_ctx) {
     ESP32Synth* synth = (ESP32Synth*)user_ctx;
@@ -24,9 +41,8 @@ static IRAM_ATTR void ledc_ovf_isr(void *user_ctx) {
         handled = true;
 
         if (synth->_running && synth->pwm_ping_pong_buf[synth->pwm_active_buf]) {
-            int16_t sample = synth->pwm_ping_pong_buf[synth->pwm_active_buf][synth->pwm_read_idx];
+            uint32_t duty_val = synth->pwm_ping_pong_buf[synth->pwm_active_buf][synth->pwm_read_idx]; // 10-bit duty, packed by render()
             synth->pwm_read_idx = synth->pwm_read_idx + 1; // Avoids 'volatile ++' compiler warning
-            uint32_t duty_val = ((uint32_t)(sample + 32768) >> 6) << 4; // Exact 10-bit duty
             REG_WRITE(LEDC_HSCH0_DUTY_REG, duty_val);
             REG_WRITE(LEDC_HSCH0_CONF1_REG, REG_READ(LEDC_HSCH0_CONF1_REG) | (1U << 31)); // Immediate latch
         }
@@ -38,9 +54,8 @@ static IRAM_ATTR void ledc_ovf_isr(void *user_ctx) {
         handled = true;
 
         if (synth->_running && synth->pwm_ping_pong_buf[synth->pwm_active_buf]) {
-            int16_t sample = synth->pwm_ping_pong_buf[synth->pwm_active_buf][synth->pwm_read_idx];
+            uint32_t duty_val = synth->pwm_ping_pong_buf[synth->pwm_active_buf][synth->pwm_read_idx]; // 10-bit duty, packed by render()
             synth->pwm_read_idx = synth->pwm_read_idx + 1; // Avoids 'volatile ++' compiler warning
-            uint32_t duty_val = ((uint32_t)(sample + 32768) >> 6) << 4; // Exact 10-bit duty
             REG_WRITE(LEDC_LSCH0_DUTY_REG, duty_val);
             REG_WRITE(LEDC_LSCH0_CONF0_REG, REG_READ(LEDC_LSCH0_CONF0_REG) | 0x10); // Immediate latch via BIT 4
         }
@@ -64,11 +79,26 @@ void ESP32Synth::end() {
         voices[i].active       = false;
         voices[i].envState     = ENV_IDLE;
         voices[i].streamTrackId = -1;
+        voices[i].stealFade     = false;
     }
+    memset(_activeMask, 0, sizeof(_activeMask));
+    if (_alloc) resetVoicePool();
+
+    // In PWM mode the render task may be parked on the ping-pong semaphore, and the ISR
+    // stops giving it once _running is false. Wake it so it can see the flag and exit.
+    if (pwm_sema != NULL) xSemaphoreGive(pwm_sema);
 
     while (audioTaskHandle  != NULL) { vTaskDelay(pdMS_TO_TICKS(2)); }
     while (streamTaskHandle != NULL) { vTaskDelay(pdMS_TO_TICKS(2)); }
 
+#if SYNTH_ENABLE_DUAL_CORE
+    stopVoiceWorker();
+#endif
+    if (_cmdRing) discardCommands();
+    _numEvents   = 0;
+    _sampleClock = 0;
+    _renderTask  = NULL;
+
     for (int i = 0; i < MAX_STREAMS; i++) {
         if (streams[i].active) {
             streams[i].playing = false;
@@ -166,9 +196,7 @@ bool ESP32Synth::begin(int dataPin, SynthOutputMode mode, int clkPin, int wsPin,
 
     controlIntervalSamples = (_sampleRate / controlRateHz) ? (_sampleRate / controlRateHz) : 1;
 
-    for (int i = 0; i < SINE_LUT_SIZE; i++) {
-        sineLUT[i] = (int16_t)(sin(i * 2.0 * PI / (double)SINE_LUT_SIZE) * 32767.0);
-    }
+    buildLUTs();
 
     if (mode == SMODE_DAC) {
         #if !defined(CONFIG_IDF_TARGET_ESP32) && !defined(CONFIG_IDF_TARGET_ESP32S2)
@@ -183,8 +211,8 @@ bool ESP32Synth::begin(int dataPin, SynthOutputMode mode, int clkPin, int wsPin,
 
         dac_continuous_config_t cont_cfg = {
             .chan_mask  = mask,
-            .desc_num   = SYNTH_DMA_BUF_COUNT,
-            .buf_size   = SYNTH_DMA_BUF_LEN * 2,
+            .desc_num   = _dmaBufCount,
+            .buf_size   = (size_t)_dmaBufLen * 2,
             .freq_hz    = _sampleRate * 2,
             .offset     = 0,
             .clk_src    = DAC_DIGI_CLK_SRC_DEFAULT,
@@ -227,8 +255,8 @@ bool ESP32Synth::begin(int dataPin, SynthOutputMode mode, int clkPin, int wsPin,
         i2s_port_t requested_port = (mode == SMODE_PDM) ? I2S_NUM_0 : I2S_NUM_AUTO;
         i2s_chan_config_t chan_cfg = I2S_CHANNEL_DEFAULT_CONFIG(requested_port, I2S_ROLE_MASTER);
 
-        chan_cfg.dma_desc_num  = SYNTH_DMA_BUF_COUNT;
-        chan_cfg.dma_frame_num = SYNTH_DMA_BUF_LEN;
+        chan_cfg.dma_desc_num  = _dmaBufCount;
+        chan_cfg.dma_frame_num = _dmaBufLen;
 
         if (i2s_new_channel(&chan_cfg, &tx_handle, NULL) != ESP_OK) return false;
 
@@ -261,7 +289,7 @@ bool ESP32Synth::begin(int dataPin, SynthOutputMode mode, int clkPin, int wsPin,
 
     // Core 1 on the S3 has less contention from USB CDC or Wi-Fi than Core 0.
     // With the mathematical Phase-Lock solved, Core 1 is the best place of all.
-    if (xTaskCreatePinnedToCore(audioTask, "SynthTask", 4096, this, configMAX_PRIORITIES - 1, &audioTaskHandle, SYNTH_AUDIO_TASK_CORE) != pdPASS) {
+    if (xTaskCreatePinnedToCore(audioTask, "SynthTask", 4096, this, SYNTH_AUDIO_TASK_PRIORITY, &audioTaskHandle, SYNTH_AUDIO_TASK_CORE) != pdPASS) {
         return false;
     }
 
@@ -278,9 +306,7 @@ bool ESP32Synth::beginCustom(uint32_t sampleRate, SynthCustomOutputCallback cust
 
     controlIntervalSamples = (_sampleRate / controlRateHz) ? (_sampleRate / controlRateHz) : 1;
 
-    for (int i = 0; i < SINE_LUT_SIZE; i++) {
-        sineLUT[i] = (int16_t)(sin(i * 2.0 * PI / (double)SINE_LUT_SIZE) * 32767.0);
-    }
+    buildLUTs();
 
     this->_running = true;
 
@@ -288,10 +314,44 @@ bool ESP32Synth::beginCustom(uint32_t sampleRate, SynthCustomOutputCallback cust
     // the AudioTask in push mode. If NOT, no task is created — the user pulls data
     // on demand via generateSamples() (pull mode). Ideal for A2DP / Wi-Fi.
     if (customOutput != nullptr) {
-        if (xTaskCreatePinnedToCore(audioTask, "SynthTask", 4096, this, configMAX_PRIORITIES - 1, &audioTaskHandle, SYNTH_AUDIO_TASK_CORE) != pdPASS) {
+        if (xTaskCreatePinnedToCore(audioTask, "SynthTask", 4096, this, SYNTH_AUDIO_TASK_PRIORITY, &audioTaskHandle, SYNTH_AUDIO_TASK_CORE) != pdPASS) {
             return false;
         }
     }
 
     return true;
+}
+
+bool ESP32Synth::setLatencyProfile(SynthLatencyProfile profile) {
+    switch (profile) {
+        case LATENCY_LIVE:     return setLatency(128, 2);
+        case LATENCY_BALANCED: return setLatency(256, 4);
+        default:               return setLatency(512, 6);
+    }
+}
+
+bool ESP32Synth::setLatency(uint16_t dmaFrameLen, uint8_t dmaBufCount, uint16_t renderBlock) {
+    if (dmaFrameLen < 16 || dmaFrameLen > 2048 || dmaBufCount < 2) return false;
+    if (renderBlock > dmaFrameLen) renderBlock = dmaFrameLen;
+
+    _dmaBufLen   = dmaFrameLen;
+    _dmaBufCount = dmaBufCount;
+    _renderBlock = renderBlock;
+
+    // Pull mode has no DMA and nothing to restart; a stopped engine picks it up in begin().
+    if (!_running || (currentMode == SMODE_CUSTOM && audioTaskHandle == NULL)) return true;
+
+    // The driver's DMA ring is sized at creation, so the output is rebuilt on the same pins.
+    // The mix bus buffers follow the block size, and can only grow while nothing renders.
+    bool dual = isDualCore();
+    bool ok;
+    if (_busMix) { end(); allocBusMix(); }
+    if (currentMode == SMODE_CUSTOM) ok = beginCustom(_sampleRate, _customOutput);
+    else                             ok = begin(_dataPin, currentMode, _bckPin, _wsPin, _mclkPin, _i2sDepth);
+    if (ok && dual) setDualCore(true);
+    return ok;
+}
+
+uint32_t ESP32Synth::getLatencyUs() {
+    return (uint32_t)((uint64_t)_dmaBufLen * _dmaBufCount * 1000000ULL / (_sampleRate ? _sampleRate : 48000));
 }
\ No newline at end of file
@@ -0,0 +1,162 @@
+#pragma once
+#include "ESP32Synth.h"
+
+// ====================================================================================
+//    MIX BUSES
+// ====================================================================================
+// Each sounding voice renders into the buffer of its bus (Voice::bus, fixed per block in
+// BlockVoice::bus). After the voices, mixBuses() runs every group bus through its chain,
+// adds it to the main mix at its gain and to the return bus at its send, then does the
+// same for the return. The main chain (addEffect) and the DSP hooks see the sum.
+//
+// An idle bus costs nothing: its buffer is only cleared once a voice on it sounds in the
+// block, and a bus with no sounding voice is skipped outright (no clear, chain or sum)
+// once it has been quiet for longer than the longest tail in its chain. A reverb on the
+// pad bus runs only while pads play or ring out, whatever the drums on bus 0 do.
+//
+// Until a voice or an effect is put on another bus nothing is allocated and render()
+// works exactly as without buses.
+
+#if SYNTH_MAX_BUSES < 1 || SYNTH_MAX_BUSES > 32
+#error "SYNTH_MAX_BUSES must be 1 .. 32"
+#endif
+
+// dst += src * g (Q8, 256 = unity)
+static FORCE_INLINE void busAdd(int32_t* dst, const int32_t* src, int32_t g, int words) {
+    if (g == 256) {
+        for (int i = 0; i < words; i++) dst[i] += src[i];
+    } else if (g > 0) {
+        for (int i = 0; i < words; i++) dst[i] += (int32_t)(((int64_t)src[i] * g) >> 8);
+    }
+}
+
+// _buses slot of a bus number: 0 = main mix, SYNTH_MAX_BUSES = return, -1 = no such bus
+static int busSlot(uint8_t bus) {
+    if (bus == SYNTH_BUS_RETURN) return (SYNTH_MAX_BUSES > 1) ? SYNTH_MAX_BUSES : -1;
+    return (bus < SYNTH_MAX_BUSES) ? bus : -1;
+}
+
+// One block per group bus plus the return, sized like the dual-core worker's buffer for
+// the render block and the 128-sample chunks of generateSamples(). A running engine keeps
+// the buffers it has (setLatency() grows them while the engine is down); a longer block
+// renders every voice into the main mix.
+bool ESP32Synth::allocBusMix() {
+#if SYNTH_MAX_BUSES > 1
+    int len = (_dmaBufLen > 128) ? _dmaBufLen : 128;
+    len = (len + 3) & ~3;
+    if (_busMix && (_busLen >= len || _running)) {
+#if SYNTH_ENABLE_DUAL_CORE
+        allocWorkerBusMix();
+#endif
+        return true;
+    }
+
+    int32_t* mem = (int32_t*)heap_caps_aligned_alloc(16, (size_t)len * SYNTH_MAX_BUSES * SYNTH_MIX_CHANNELS * sizeof(int32_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!mem) return _busMix != nullptr;
+    if (_busMix) heap_caps_free(_busMix);
+    _busLen = len;
+    __atomic_store_n(&_busMix, mem, __ATOMIC_RELEASE);
+#if SYNTH_ENABLE_DUAL_CORE
+    allocWorkerBusMix(); // The worker's share of the bus blocks
+#endif
+    return true;
+#else
+    return false;
+#endif
+}
+
+ESP32Synth::FxChain* ESP32Synth::busChain(uint8_t bus) {
+    const int slot = busSlot(bus);
+    if (slot < 0) return nullptr;
+    return slot ? &_buses[slot].chain : &_fxChain;
+}
+
+// Audio task, per span: points the buses used in it at their buffers, clearing a bus's
+// whole block the first time one of its voices sounds in the block.
+void IRAM_ATTR ESP32Synth::routeBuses(int32_t* span, uint32_t used) {
+    const int offset = (int)(span - _blockMix);
+    for (int b = 1; b < SYNTH_MAX_BUSES; b++) {
+        if (!((used >> b) & 1)) continue;
+        int32_t* buf = busBuffer(b);
+        if (!((_blockBuses >> b) & 1)) {
+            memset(buf, 0, _blockSamples * SYNTH_MIX_CHANNELS * sizeof(int32_t));
+            _blockBuses |= 1u << b;
+        }
+        _busOut[b] = buf + offset;
+    }
+}
+
+// Audio task, after the voices: the group buses into the main mix and the return, then
+// the return into the main mix. A bus without input keeps running its chain on silence
+// until the longest tail is out, then sleeps.
+void IRAM_ATTR ESP32Synth::mixBuses(int32_t* mix, int samples) {
+    const int words = samples * SYNTH_MIX_CHANNELS;
+    int32_t*  ret   = busBuffer(SYNTH_MAX_BUSES);
+    bool      fed   = false; // Something was sent to the return in this block
+
+    for (int b = 1; b <= SYNTH_MAX_BUSES; b++) {
+        MixBus&    bus  = _buses[b];
+        int32_t*   buf  = busBuffer(b);
+        const bool live = (b < SYNTH_MAX_BUSES) ? ((_blockBuses >> b) & 1) : fed;
+        if (live) {
+            bus.quiet = 0;
+        } else {
+            const uint32_t tail = fxChainTail(bus.chain);
+            if (tail != SYNTH_FX_TAIL_FOREVER && bus.quiet >= tail) { bus.active = false; continue; }
+            if (bus.quiet < tail) bus.quiet += (uint32_t)samples;
+            memset(buf, 0, words * sizeof(int32_t));
+        }
+        bus.active = true;
+
+        runFxChain(bus.chain, buf, samples);
+        if (b < SYNTH_MAX_BUSES && bus.send > 0) {
+            if (!fed) { memset(ret, 0, words * sizeof(int32_t)); fed = true; }
+            busAdd(ret, buf, bus.send, words);
+        }
+        busAdd(mix, buf, bus.gain, words);
+    }
+}
+
+// The buffers are allocated here, by the caller, before the command is queued.
+void ESP32Synth::setVoiceBus(uint16_t voice, uint8_t bus) {
+    if (bus >= SYNTH_MAX_BUSES) return;
+    if (bus && !_busMix) allocBusMix();
+    if (queueCommand(CMD_SET_VOICE_BUS, voice, bus)) return;
+    if (voice < MAX_VOICES) voices[voice].bus = bus;
+}
+
+uint8_t ESP32Synth::getVoiceBus(uint16_t voice) {
+    return (voice < MAX_VOICES) ? voices[voice].bus : 0;
+}
+
+// Bus 0 has no gain of its own (setMasterVolume).
+void ESP32Synth::setBusGain(uint8_t bus, uint8_t gain) {
+    const int slot = busSlot(bus);
+    if (slot > 0) _buses[slot].gain = fxGainQ8(gain);
+}
+
+void ESP32Synth::setBusSend(uint8_t bus, uint8_t level) {
+    const int slot = busSlot(bus);
+    if (slot > 0 && slot < SYNTH_MAX_BUSES) _buses[slot].send = fxGainQ8(level);
+}
+
+bool ESP32Synth::addBusEffect(uint8_t bus, SynthEffect* fx, int8_t position) {
+    FxChain* ch = busChain(bus);
+    if (!ch || (ch != &_fxChain && !allocBusMix())) return false;
+    return fxChainAdd(*ch, fx, position);
+}
+
+bool ESP32Synth::removeBusEffect(uint8_t bus, SynthEffect* fx) {
+    FxChain* ch = busChain(bus);
+    return ch && fx && fxChainRemove(*ch, fx);
+}
+
+bool ESP32Synth::clearBusEffects(uint8_t bus) {
+    FxChain* ch = busChain(bus);
+    return ch && fxChainClear(*ch);
+}
+
+bool ESP32Synth::isBusActive(uint8_t bus) {
+    const int slot = busSlot(bus);
+    return slot == 0 || (slot > 0 && _buses[slot].active);
+}
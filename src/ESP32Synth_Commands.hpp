@@ -0,0 +1,344 @@
+#pragma once
+#include "ESP32Synth.h"
+
+// ====================================================================================
+//    COMMAND QUEUE
+// ====================================================================================
+// Bounded multi-producer / single-consumer ring (per-slot sequence numbers, no locks).
+// Producers are the tasks calling the voice API; the consumer is whichever task runs
+// render(), which drains the ring at the start of every block. A slot for position 'pos'
+// is free when seq == pos and holds a published command when seq == pos + 1. A group of
+// n commands (a batch) reserves n consecutive positions with one CAS and publishes its
+// first slot last, so render() either sees the whole group or none of it.
+
+static_assert((SYNTH_CMD_QUEUE_LEN & (SYNTH_CMD_QUEUE_LEN - 1)) == 0, "SYNTH_CMD_QUEUE_LEN must be a power of 2");
+static_assert(SYNTH_CMD_BATCH_MAX <= SYNTH_CMD_QUEUE_LEN, "SYNTH_CMD_BATCH_MAX must fit in the command ring");
+
+bool ESP32Synth::setCommandQueue(bool enable) {
+    if (!enable) {
+        // Calls go direct again; anything still queued is applied by the next block.
+        _cmdQueueOn = false;
+        return true;
+    }
+    if (!allocCommandRing()) return false;
+    _cmdQueueOn = true;
+    return true;
+}
+
+// Also reached lazily from noteOnAt() on any task, so two callers may race here: the
+// loser of the CAS frees its copy.
+bool ESP32Synth::allocCommandRing() {
+    if (__atomic_load_n(&_cmdRing, __ATOMIC_ACQUIRE) != nullptr) return true;
+
+    SynthCommand* ring    = (SynthCommand*)heap_caps_malloc(SYNTH_CMD_QUEUE_LEN * sizeof(SynthCommand), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    CommandBatch* batches = (CommandBatch*)heap_caps_calloc(SYNTH_CMD_BATCH_SLOTS, sizeof(CommandBatch), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!ring || !batches) {
+        if (ring)    heap_caps_free(ring);
+        if (batches) heap_caps_free(batches);
+        return false;
+    }
+    for (uint32_t i = 0; i < SYNTH_CMD_QUEUE_LEN; i++) ring[i].seq = i;
+
+    CommandBatch* noBatches = nullptr;
+    if (!__atomic_compare_exchange_n(&_cmdBatches, &noBatches, batches, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        heap_caps_free(ring);
+        heap_caps_free(batches);
+        while (__atomic_load_n(&_cmdRing, __ATOMIC_ACQUIRE) == nullptr) { vTaskDelay(1); }
+        return true;
+    }
+    _cmdEnqueuePos = 0;
+    _cmdDequeuePos = 0;
+    __atomic_store_n(&_cmdRing, ring, __ATOMIC_RELEASE);
+    return true;
+}
+
+bool ESP32Synth::isCommandQueueEnabled() {
+    return _cmdQueueOn;
+}
+
+ESP32Synth::CommandBatch* ESP32Synth::findBatch(TaskHandle_t owner) {
+    for (int i = 0; i < SYNTH_CMD_BATCH_SLOTS; i++) {
+        if (__atomic_load_n(&_cmdBatches[i].owner, __ATOMIC_ACQUIRE) == owner) return &_cmdBatches[i];
+    }
+    return nullptr;
+}
+
+bool ESP32Synth::beginBatch() {
+    if (!_cmdQueueOn) return false;
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    if (self == renderTask()) return false; // Already applied at a block boundary
+    if (findBatch(self)) return true;      // Nested begin: keep filling the open batch
+
+    for (int i = 0; i < SYNTH_CMD_BATCH_SLOTS; i++) {
+        TaskHandle_t expected = NULL;
+        if (__atomic_compare_exchange_n(&_cmdBatches[i].owner, &expected, self, false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+            _cmdBatches[i].count = 0;
+            return true;
+        }
+    }
+    return false; // All slots busy: commands from this task are queued one by one
+}
+
+void ESP32Synth::commitBatch() {
+    if (_cmdBatches == nullptr) return;
+    CommandBatch* batch = findBatch(xTaskGetCurrentTaskHandle());
+    if (!batch) return;
+
+    if (batch->count > 0 && !pushCommands(batch->cmds, batch->count)) {
+        // The audio task is gone, so nothing is racing us: apply in place.
+        for (int i = 0; i < batch->count; i++) applyCommand(batch->cmds[i]);
+    }
+    batch->count = 0;
+    __atomic_store_n(&batch->owner, (TaskHandle_t)NULL, __ATOMIC_RELEASE);
+}
+
+// Returns true when the call was captured; the API function then returns without touching
+// the voice. Calls made from the render task itself (the drain below, processControl(),
+// the control hook) fall through and apply immediately, and so does everything while no
+// task renders: nothing reads the voices yet, and in pull mode the caller may well be the
+// task that will drain the ring, which would otherwise block on a full ring forever. An
+// audio task counts as rendering from its creation (renderTask()), so calls made before
+// its first block are queued too.
+bool ESP32Synth::queueCommand(uint8_t op, uint16_t voice, uint32_t a, uint32_t b, uint32_t c, const void* p) {
+    if (LIKELY(!_cmdQueueOn) || !_running) return false;
+    TaskHandle_t self     = xTaskGetCurrentTaskHandle();
+    TaskHandle_t renderer = renderTask();
+    if (self == renderer || renderer == NULL) return false;
+
+    SynthCommand cmd = { 0, op, 1, voice, a, b, c, 0, p };
+    return queueCommands(&cmd, 1);
+}
+
+// A group of commands that must land in the same block (at most SYNTH_CMD_BATCH_MAX).
+// Same rules as queueCommand(); inside an open batch the group is never split.
+bool ESP32Synth::queueCommands(SynthCommand* cmds, int n) {
+    if (LIKELY(!_cmdQueueOn) || !_running) return false;
+    TaskHandle_t self     = xTaskGetCurrentTaskHandle();
+    TaskHandle_t renderer = renderTask();
+    if (self == renderer || renderer == NULL) return false;
+
+    CommandBatch* batch = findBatch(self);
+    if (batch) {
+        if (batch->count + n > SYNTH_CMD_BATCH_MAX) {
+            pushCommands(batch->cmds, batch->count);
+            batch->count = 0;
+        }
+        for (int i = 0; i < n; i++) batch->cmds[batch->count++] = cmds[i];
+        return true;
+    }
+    return pushCommands(cmds, n);
+}
+
+bool ESP32Synth::pushCommands(SynthCommand* cmds, int n) {
+    const uint32_t mask = SYNTH_CMD_QUEUE_LEN - 1;
+    uint32_t pos;
+    while (true) {
+        pos = __atomic_load_n(&_cmdEnqueuePos, __ATOMIC_RELAXED);
+        // The consumer frees slots in order, so if the last slot of the range is free all are.
+        uint32_t last = pos + n - 1;
+        int32_t  dif  = (int32_t)(__atomic_load_n(&_cmdRing[last & mask].seq, __ATOMIC_ACQUIRE) - last);
+        if (dif == 0) {
+            if (__atomic_compare_exchange_n(&_cmdEnqueuePos, &pos, pos + n, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) break;
+        } else if (dif < 0) {
+            // Ring full: wait for render() to drain a block.
+            if (!_running) return false;
+            vTaskDelay(1);
+        }
+    }
+
+    for (int i = 0; i < n; i++) {
+        SynthCommand* slot = &_cmdRing[(pos + i) & mask];
+        slot->op       = cmds[i].op;
+        slot->batchLen = (i == 0) ? (uint8_t)n : 0;
+        slot->voice    = cmds[i].voice;
+        slot->a        = cmds[i].a;
+        slot->b        = cmds[i].b;
+        slot->c        = cmds[i].c;
+        slot->when     = cmds[i].when;
+        slot->p        = cmds[i].p;
+    }
+    // Publish back to front: the head slot going live releases the whole group.
+    for (int i = n - 1; i >= 0; i--) {
+        __atomic_store_n(&_cmdRing[(pos + i) & mask].seq, pos + i + 1, __ATOMIC_RELEASE);
+    }
+    return true;
+}
+
+void IRAM_ATTR ESP32Synth::drainCommands() {
+    const uint32_t mask = SYNTH_CMD_QUEUE_LEN - 1;
+    uint32_t pos = _cmdDequeuePos;
+    while (true) {
+        SynthCommand* head = &_cmdRing[pos & mask];
+        if (__atomic_load_n(&head->seq, __ATOMIC_ACQUIRE) != pos + 1) break;
+
+        const int n = head->batchLen;
+        for (int i = 0; i < n; i++) {
+            SynthCommand* cmd = &_cmdRing[(pos + i) & mask];
+            applyCommand(*cmd);
+            __atomic_store_n(&cmd->seq, pos + i + SYNTH_CMD_QUEUE_LEN, __ATOMIC_RELEASE);
+        }
+        pos += n;
+    }
+    _cmdDequeuePos = pos;
+}
+
+// end(): the audio task has stopped, drop whatever it did not get to.
+void ESP32Synth::discardCommands() {
+    const uint32_t mask = SYNTH_CMD_QUEUE_LEN - 1;
+    uint32_t pos = _cmdDequeuePos;
+    while (__atomic_load_n(&_cmdRing[pos & mask].seq, __ATOMIC_ACQUIRE) == pos + 1) {
+        const int n = _cmdRing[pos & mask].batchLen;
+        for (int i = 0; i < n; i++) {
+            __atomic_store_n(&_cmdRing[(pos + i) & mask].seq, pos + i + SYNTH_CMD_QUEUE_LEN, __ATOMIC_RELEASE);
+        }
+        pos += n;
+    }
+    _cmdDequeuePos = pos;
+}
+
+// Runs on the render task, so each call below takes its direct path. A timed command is
+// parked in the event list instead; if the list is full it plays now rather than never.
+void IRAM_ATTR ESP32Synth::applyCommand(const SynthCommand& cmd) {
+    if (UNLIKELY(cmd.op & CMD_TIMED) && insertTimedEvent(cmd)) return;
+
+    const uint16_t v = cmd.voice;
+    switch (cmd.op & ~CMD_TIMED) {
+        case CMD_NOTE_ON:               noteOn(v, cmd.a, (uint16_t)cmd.b); break;
+        case CMD_NOTE_OFF:              noteOff(v); break;
+        case CMD_SET_FREQUENCY:         setFrequency(v, cmd.a); break;
+        case CMD_SET_VOLUME:            setVolume(v, (uint16_t)cmd.a); break;
+        case CMD_SET_WAVE:              setWave(v, (WaveType)(int8_t)cmd.a); break;
+        case CMD_SET_PULSE_WIDTH:       setPulseWidth(v, cmd.a); break;
+        case CMD_SET_CUSTOM_WAVE:       setCustomWave(v, (SynthCustomWaveCallback)cmd.p); break;
+        case CMD_SET_ENV:               setEnv(v, (uint16_t)cmd.a, (uint16_t)(cmd.a >> 16), (uint8_t)cmd.b, (uint16_t)cmd.c); break;
+        case CMD_SET_SMOOTH_ENV:        setSmoothEnv(v, cmd.a != 0); break;
+        case CMD_SET_ENV_CURVE:         setEnvCurve(v, (EnvCurve)cmd.a, (EnvCurve)cmd.b, (EnvCurve)cmd.c); break;
+        case CMD_SET_ENVELOPE:          setEnvelope(v, (const SynthEnvelope*)cmd.p); break;
+        case CMD_SET_FILTER:            setFilter(v, (FilterType)(cmd.a & 0xFF), cmd.b, (uint8_t)(cmd.a >> 8)); break;
+        case CMD_SET_FILTER_ENV:        setFilterEnv(v, (uint16_t)cmd.a, (uint16_t)(cmd.a >> 16), (uint8_t)cmd.b, (uint16_t)cmd.c, (int16_t)(cmd.b >> 16)); break;
+        case CMD_SET_FILTER_KEYTRACK:   setFilterKeyTrack(v, (uint8_t)cmd.a); break;
+        case CMD_SET_VOICE_BUS:         setVoiceBus(v, (uint8_t)cmd.a); break;
+        case CMD_SET_START_PHASE:       setStartPhase(v, (uint16_t)cmd.a); break;
+        case CMD_SET_CURRENT_PHASE:     setCurrentPhase(v, (uint16_t)cmd.a); break;
+        case CMD_SET_VIBRATO:           setVibrato(v, cmd.a, cmd.b); break;
+        case CMD_SET_VIBRATO_PHASE:     setVibratoPhase(v, (uint16_t)cmd.a); break;
+        case CMD_SET_TREMOLO:           setTremolo(v, cmd.a, (uint16_t)cmd.b); break;
+        case CMD_SET_TREMOLO_PHASE:     setTremoloPhase(v, (uint16_t)cmd.a); break;
+        case CMD_SLIDE_FREQ:            slideFreq(v, cmd.a, cmd.b, cmd.c); break;
+        case CMD_SLIDE_FREQ_TO:         slideFreqTo(v, cmd.a, cmd.b); break;
+        case CMD_SLIDE_VOL:             slideVol(v, (uint16_t)cmd.a, (uint16_t)cmd.b, cmd.c); break;
+        case CMD_SLIDE_VOL_TO:          slideVolTo(v, (uint16_t)cmd.a, cmd.b); break;
+        case CMD_SET_WAVETABLE:         setWavetable(v, cmd.p, cmd.a, (BitDepth)cmd.b, cmd.c != 0); break;
+        case CMD_SET_WAVETABLE_MIP:     setWavetableMip(v, (const WavetableMip*)cmd.p, cmd.c != 0); break;
+        case CMD_SET_SAMPLE_INTERP:     setSampleInterp(v, (SampleInterp)cmd.a); break;
+        case CMD_SET_PAN:               setPan(v, (int8_t)cmd.a); break;
+        case CMD_SET_PATCH:             setPatch(v, (const SynthPatch*)cmd.p); break;
+        case CMD_STEAL_VOICE:           stealVoice(v); break;
+        case CMD_SET_INSTRUMENT:        setInstrument(v, (Instrument*)cmd.p); break;
+        case CMD_SET_INSTRUMENT_SAMPLE: setInstrument(v, (Instrument_Sample*)cmd.p); break;
+        case CMD_DETACH_INSTRUMENT:     detachInstrument(v, (WaveType)(int8_t)cmd.a); break;
+        case CMD_SET_SAMPLE:            setSample(v, (uint16_t)cmd.a, (LoopMode)(cmd.a >> 16), cmd.b, cmd.c); break;
+        case CMD_SET_SAMPLE_LOOP:       setSampleLoop(v, (LoopMode)cmd.a, cmd.b, cmd.c); break;
+        case CMD_SET_ARP_NOTES:
+            voices[v].arpNotes[cmd.a] = cmd.b;
+            if (cmd.a + 1 < MAX_ARP_NOTES) voices[v].arpNotes[cmd.a + 1] = cmd.c;
+            break;
+        case CMD_SET_ARPEGGIO:          applyArpeggio(v, (uint16_t)cmd.b, voices[v].arpNotes, cmd.a); break;
+        case CMD_DETACH_ARPEGGIO:       detachArpeggio(v); break;
+        case CMD_SETUP_STREAM:          startStream(v, (int8_t)cmd.a, 0, false); break;
+        case CMD_PLAY_STREAM:           startStream(v, (int8_t)cmd.a, (uint16_t)cmd.b, true); break;
+        case CMD_STOP_STREAM:           detachStream(v, (int8_t)cmd.a); break;
+        case CMD_PAUSE_STREAM:          pauseStream(v); break;
+        case CMD_RESUME_STREAM:         resumeStream(v); break;
+        case CMD_SEEK_STREAM:           seekStreamMs(v, cmd.a); break;
+        case CMD_SET_STREAM_LOOP:       setStreamLoopPointsMs(v, cmd.a, cmd.b); break;
+        default: break;
+    }
+}
+
+// ====================================================================================
+//    SAMPLE-ACCURATE EVENTS
+// ====================================================================================
+// noteOnAt()/noteOffAt() reach the render task like any queued command (the ring is
+// allocated on first use even if setCommandQueue() is off) and are then kept in _events,
+// sorted by sample time. render() applies the due ones and cuts the block where the next
+// one falls, so each span is rendered with the voice state its events left behind.
+
+bool ESP32Synth::noteOnAt(uint16_t voice, uint32_t freqCentiHz, uint16_t volume, uint32_t sampleTime) {
+    return scheduleCommand(CMD_NOTE_ON, voice, sampleTime, freqCentiHz, volume);
+}
+
+bool ESP32Synth::noteOffAt(uint16_t voice, uint32_t sampleTime) {
+    return scheduleCommand(CMD_NOTE_OFF, voice, sampleTime);
+}
+
+uint32_t ESP32Synth::getSampleTime() {
+    return _sampleClock;
+}
+
+bool ESP32Synth::scheduleCommand(uint8_t op, uint16_t voice, uint32_t when, uint32_t a, uint32_t b) {
+    if (voice >= MAX_VOICES) return false;
+    SynthCommand cmd = { 0, (uint8_t)(op | CMD_TIMED), 1, voice, a, b, 0, when, nullptr };
+
+    // Same rule as queueCommand(): while no task renders or on the render task itself the
+    // list can be written directly.
+    TaskHandle_t self     = xTaskGetCurrentTaskHandle();
+    TaskHandle_t renderer = renderTask();
+    if (!_running || self == renderer || renderer == NULL) return insertTimedEvent(cmd);
+
+    if (!allocCommandRing()) return false;
+    CommandBatch* batch = findBatch(self);
+    if (batch) {
+        if (batch->count == SYNTH_CMD_BATCH_MAX) {
+            pushCommands(batch->cmds, batch->count);
+            batch->count = 0;
+        }
+        batch->cmds[batch->count++] = cmd;
+        return true;
+    }
+    return pushCommands(&cmd, 1);
+}
+
+bool IRAM_ATTR ESP32Synth::insertTimedEvent(const SynthCommand& cmd) {
+    if (_numEvents >= SYNTH_EVENT_QUEUE_LEN) return false;
+
+    // Insertion from the back keeps events with the same time in call order.
+    int i = _numEvents;
+    while (i > 0 && (int32_t)(_events[i - 1].when - cmd.when) > 0) {
+        _events[i] = _events[i - 1];
+        i--;
+    }
+    _events[i]    = cmd;
+    _events[i].op = cmd.op & ~CMD_TIMED;
+    _numEvents++;
+    return true;
+}
+
+// Applies every event due at or before offset 'pos' of the current block and returns the
+// offset where the next span must end (the next event, or the end of the block).
+int IRAM_ATTR ESP32Synth::applyDueEvents(int pos, int samples) {
+    const uint32_t now = _sampleClock + (uint32_t)pos;
+    int n = 0;
+    while (n < _numEvents && (int32_t)(_events[n].when - now) <= 0) {
+        applyCommand(_events[n]);
+        n++;
+    }
+    if (n > 0) {
+        _numEvents -= n;
+        memmove(_events, _events + n, _numEvents * sizeof(SynthCommand));
+
+        // noteOn() asks for an immediate control update; run it here rather than at the next
+        // block, and credit the rest of this block as render() does for the whole block.
+        if (controlSampleCounter >= controlIntervalSamples) {
+            processControl();
+            controlSampleCounter = (uint32_t)(samples - pos);
+        }
+    }
+    if (_numEvents == 0) return samples;
+
+    int32_t next = (int32_t)(_events[0].when - _sampleClock);
+#if defined(CONFIG_IDF_TARGET_ESP32S3)
+    next = (next + 3) & ~3; // Spans stay 16-byte aligned for the vector kernels
+#endif
+    return (next < samples) ? next : samples;
+}
@@ -33,13 +33,25 @@
     between polyphony and performance.
 */
 
-// /* // Default:
+// /* // Default (each one can also be overridden from build flags, e.g. -DMAX_VOICES=300):
+#ifndef MAX_VOICES
 #define MAX_VOICES      80   // Max simultaneous voices. (CPU/RAM limited, see note above).
+#endif
+#ifndef MAX_WAVETABLES
 #define MAX_WAVETABLES  20   // Default 20
+#endif
+#ifndef MAX_SAMPLES
 #define MAX_SAMPLES     20   // Default 20
+#endif
+#ifndef MAX_ARP_NOTES
 #define MAX_ARP_NOTES   16   // Default 16
+#endif
+#ifndef MAX_STREAMS
 #define MAX_STREAMS      4   // Max concurrent SD streams (RAM/CPU limited).
+#endif
+#ifndef STREAM_BUF_SAMPLES
 #define STREAM_BUF_SAMPLES 2048 // Ring buffer size (Must be power of 2).
+#endif
 // */
 
  /* // Low RAM usage (for LVGL or other high-memory libs / tasks):
@@ -65,6 +77,8 @@
     [Balance] LEN: 256 | COUNT: 4  (good for most MIDI keyboards)
     [LIVE]    LEN: 128 | COUNT: 2  (imperceptible latency, slightly less polyphony)
 
+    These are the defaults; setLatencyProfile() / setLatency() pick them at runtime.
+
     [You have an audio analyzer in mind] LEN: 64 | COUNT: 2 (Impressive!)
 
     It's a joke, please don't take it seriously (works but low polyphony, not recommended):
@@ -80,10 +94,175 @@
 #define SYNTH_DMA_BUF_COUNT 6
 #endif
 
+/*
+    Render profiler: accumulates esp_cpu_get_cycle_count() deltas per render stage
+    (control, voices, DSP hook, master, output conversion) and per voice kernel, and
+    publishes min/avg/max over a window of SYNTH_PROFILER_WINDOW blocks through
+    getRenderProfile(). When left at 0 none of it is compiled, so it costs nothing.
+*/
+#ifndef SYNTH_ENABLE_PROFILER
+#define SYNTH_ENABLE_PROFILER 0
+#endif
+
+#ifndef SYNTH_PROFILER_WINDOW
+#define SYNTH_PROFILER_WINDOW 64 // Blocks per published window (~680 ms at 512 samples / 48kHz)
+#endif
+
+/*
+    Command queue: after setCommandQueue(true) the voice API (noteOn, noteOff, setFrequency,
+    slides, envelopes, ...) called from any task other than the one running render() no
+    longer writes Voice fields directly. Each call becomes a fixed-size command in a
+    lock-free multi-producer ring that render() drains at the start of the next block, so
+    multi-field updates never tear against the audio task and several tasks on both cores
+    can drive the engine without mutexes. beginBatch()/commitBatch() publish a group of
+    commands (e.g. a chord) so they all land in the same block.
+*/
+#ifndef SYNTH_CMD_QUEUE_LEN
+#define SYNTH_CMD_QUEUE_LEN 256 // Commands in the ring (power of 2)
+#endif
+
+#ifndef SYNTH_CMD_BATCH_MAX
+#define SYNTH_CMD_BATCH_MAX 32 // Commands per batch; larger batches are split
+#endif
+
+#ifndef SYNTH_CMD_BATCH_SLOTS
+#define SYNTH_CMD_BATCH_SLOTS 4 // Tasks that can hold an open batch at the same time
+#endif
+
+/*
+    Timed events: noteOnAt()/noteOffAt() are held in a sorted list until their sample time
+    comes up, and render() cuts the DMA block at that offset so the note starts on the exact
+    sample instead of the next block boundary (~10.7 ms at 512 samples / 48kHz). Each pending
+    event costs 32 bytes of RAM. On the ESP32-S3 the cut is rounded up to a multiple of 4
+    samples to keep the vector kernels aligned.
+*/
+#ifndef SYNTH_EVENT_QUEUE_LEN
+#define SYNTH_EVENT_QUEUE_LEN 64 // Timed events pending at once
+#endif
+
+/*
+    Voice allocator: when noteOnAuto() steals a voice that is still sounding, the old note
+    is faded out over SYNTH_STEAL_FADE_SAMPLES (the envelope ramps at block granularity, so
+    never faster than the rest of the block) and the new note starts on the next block.
+*/
+#ifndef SYNTH_STEAL_FADE_SAMPLES
+#define SYNTH_STEAL_FADE_SAMPLES 96 // 2 ms at 48kHz
+#endif
+
+/*
+    Envelope curves: ENV_CURVE_EXP segments follow (e^(k*x) - 1) / (e^k - 1) of the distance
+    still to go, so they cover ~92% of it in the first half of the segment time at k = 5, and
+    ENV_CURVE_LOG is the mirror image. The curve is read from a small LUT twice per block;
+    the samples in between are the usual linear ramp.
+*/
+#ifndef SYNTH_ENV_CURVE_STEEPNESS
+#define SYNTH_ENV_CURVE_STEEPNESS 5 // k above
+#endif
+
+/*
+    Per-voice filter: setFilter() gives a voice its own resonant state-variable filter
+    (low / band / high-pass) with a filter envelope and key tracking. Coefficients are
+    updated once per block, the filter itself runs per sample. The state costs ~80 bytes
+    per voice whether it is used or not, which lowers the MAX_VOICES limits above, so it
+    is opt-in: set to 1 to compile it in (while 0, the setters are no-ops).
+*/
+#ifndef SYNTH_ENABLE_FILTER
+#define SYNTH_ENABLE_FILTER 0
+#endif
+
+/*
+    Effect chain: addEffect() runs SynthEffect stages over the mix, in order, in slices of
+    SYNTH_FX_BLOCK frames. The chain shares two scratch buffers of one slice each, allocated
+    with the first effect (1 KB mono, 2 KB stereo at 64 frames).
+*/
+#ifndef SYNTH_MAX_EFFECTS
+#define SYNTH_MAX_EFFECTS 8 // Stages per chain
+#endif
+
+#ifndef SYNTH_FX_BLOCK
+#define SYNTH_FX_BLOCK 64 // Frames per slice (multiple of 4)
+#endif
+
+/*
+    Built-in reverb (SynthReverb): a feedback delay network of SYNTH_REVERB_LINES int16
+    delay lines, 4 or 8. Eight lines give a denser, less metallic tail for ~1.6x the cycles.
+    Every line keeps 2 * SYNTH_REVERB_MOD_MAX + 1 extra samples for its modulated read tap.
+*/
+#ifndef SYNTH_REVERB_LINES
+#define SYNTH_REVERB_LINES 8
+#endif
+
+#ifndef SYNTH_REVERB_MOD_MAX
+#define SYNTH_REVERB_MOD_MAX 16 // Deepest tap modulation, samples
+#endif
+
+// DelayLine / reverb buffers of this many bytes or more go to PSRAM when the board has it
+#ifndef SYNTH_DELAY_PSRAM_MIN
+#define SYNTH_DELAY_PSRAM_MIN 16384
+#endif
+
+/*
+    Mix buses: setVoiceBus() routes a voice to one of SYNTH_MAX_BUSES buses, bus 0 being
+    the main mix. Every other bus has its own gain, effect chain and send to the shared
+    return bus. The bus buffers (one render block per bus, plus the return) are allocated
+    on first use, and so are the dual-core worker's blocks for them. 1 = no buses.
+*/
+#ifndef SYNTH_MAX_BUSES
+#define SYNTH_MAX_BUSES 4 // Including the main mix (max 32)
+#endif
+
 // Core Task Pinning
 #define SYNTH_SD_TASK_CORE 0 //If any library conflicts, for compatibility with other ESP32s, etc.
 #define SYNTH_AUDIO_TASK_CORE 1 //If any library conflicts, for compatibility with other ESP32s, etc. <-- Not recommended to change
 
+#ifndef SYNTH_AUDIO_TASK_PRIORITY
+#define SYNTH_AUDIO_TASK_PRIORITY (configMAX_PRIORITIES - 1)
+#endif
+
+/*
+    Dual-core voice rendering: setDualCore(true) starts a worker task on
+    SYNTH_WORKER_TASK_CORE that renders part of the sounding voices into its own mix
+    buffer while the audio task renders the rest; both are summed before the DSP hook.
+    The split is weighted by each kernel's measured cost in the previous blocks.
+    Blocks with fewer than SYNTH_DUAL_CORE_MIN_VOICES sounding voices stay on one core,
+    since the hand-off would cost more than it saves. Set SYNTH_ENABLE_DUAL_CORE to 0 to
+    compile it out (single-core chips refuse setDualCore(true) at runtime anyway).
+*/
+#ifndef SYNTH_ENABLE_DUAL_CORE
+#define SYNTH_ENABLE_DUAL_CORE 1
+#endif
+
+#ifndef SYNTH_WORKER_TASK_CORE
+#define SYNTH_WORKER_TASK_CORE 0 // The core left idle by SYNTH_AUDIO_TASK_CORE
+#endif
+
+// The worker shares its core with the IPC, Wi-Fi/BT and esp_timer tasks (the top three
+// priorities on Core 0), so it takes the audio task's priority but stays below those.
+#ifndef SYNTH_WORKER_TASK_PRIORITY
+#define SYNTH_WORKER_TASK_PRIORITY (SYNTH_AUDIO_TASK_PRIORITY < configMAX_PRIORITIES - 3 ? SYNTH_AUDIO_TASK_PRIORITY : configMAX_PRIORITIES - 4)
+#endif
+
+#ifndef SYNTH_DUAL_CORE_MIN_VOICES
+#define SYNTH_DUAL_CORE_MIN_VOICES 8
+#endif
+
+/*
+    Stereo engine: every voice gets a constant-power pan (setPan) folded into its gain,
+    the mix bus is interleaved L/R, and I2S output / generateSamplesStereo() carry real
+    stereo. PDM, DAC, PWM and generateSamples() get the (L + R) / 2 downmix. It costs
+    a second multiply-accumulate per voice sample and twice the mix buffer RAM, so it is
+    opt-in.
+*/
+#ifndef SYNTH_ENABLE_STEREO
+#define SYNTH_ENABLE_STEREO 0
+#endif
+
+#if SYNTH_ENABLE_STEREO
+#define SYNTH_MIX_CHANNELS 2
+#else
+#define SYNTH_MIX_CHANNELS 1
+#endif
+
 // ====================================================================================
 //    SINE WAVE LOOK-UP TABLE
 // ====================================================================================
@@ -91,10 +270,31 @@
 #define SINE_LUT_MASK (SINE_LUT_SIZE - 1)
 #define SINE_SHIFT    20
 
+// Voice pan offset: -SYNTH_PAN_MAX (left) .. +SYNTH_PAN_MAX (right). sineLUT[SYNTH_PAN_MAX +/- pan]
+// spans the first quarter wave (0..90 degrees), giving the constant-power sin / cos gains.
+#define SYNTH_PAN_MAX (SINE_LUT_SIZE / 8)
+
 // Shared sine LUT
 extern int16_t sineLUT[SINE_LUT_SIZE];
 
+// Envelope curve LUT (ENV_CURVE_EXP), Q15 over ENV_CURVE_LUT_SIZE + 1 points
+#define ENV_CURVE_LUT_BITS 6
+#define ENV_CURVE_LUT_SIZE (1 << ENV_CURVE_LUT_BITS)
+extern uint16_t envCurveLUT[ENV_CURVE_LUT_SIZE + 1];
+
+// Filter cutoff LUT: tan(pi fc / fs) in Q24, one point every 128 cents from fs / 8192
+// (~6 Hz at 48kHz) to ~0.48 fs. The pitch axis is cents relative to the sample rate.
+#if SYNTH_ENABLE_FILTER
+#define SVF_PITCH_MIN       (-15600)
+#define SVF_PITCH_STEP_BITS 7
+#define SVF_TAN_LUT_SIZE    113
+#define SVF_PITCH_MAX       (SVF_PITCH_MIN + ((SVF_TAN_LUT_SIZE - 1) << SVF_PITCH_STEP_BITS))
+extern uint32_t svfTanLUT[SVF_TAN_LUT_SIZE];
+#endif
+
 #define STREAM_BUF_MASK (STREAM_BUF_SAMPLES - 1)
 #define ENV_MAX 268435456
+#define ENV_SEG_RESTART 0xFF // Voice::envSegState: start the segment of the current envState anew
+#define ENV_SEG_NEXT    0xFE // Voice::envSegState: start the envTable stage in Voice::envSeg
 
 #endif // ESP32_SYNTH_CONFIG_HPP
\ No newline at end of file
@@ -2,12 +2,24 @@
 #include "ESP32Synth.h"
 
 void ESP32Synth::noteOn(uint16_t voice, uint32_t freqCentiHz, uint16_t volume) {
+    if (queueCommand(CMD_NOTE_ON, voice, freqCentiHz, volume)) return;
     if (voice >= MAX_VOICES) return;
     Voice* vo = &voices[voice];
 
+    vo->noteCount++;
+    vo->stealFade = false;
     vo->freqVal = freqCentiHz;
     vo->vol     = volume << _volShift;
-    vo->active  = true;
+#if SYNTH_ENABLE_FILTER
+    if (!vo->active) { // Nothing left ringing in the filter: start it (and its envelope) from rest
+        memset(vo->svfIc1, 0, sizeof(vo->svfIc1));
+        memset(vo->svfIc2, 0, sizeof(vo->svfIc2));
+        vo->svfInit = true;
+        vo->fenvVal = 0;
+    }
+    vo->fenvState = ENV_ATTACK;
+#endif
+    markVoiceActive(voice);
 
     // Calculate phase increment
     vo->phaseInc = (uint32_t)(((uint64_t)freqCentiHz << 32) / (_sampleRate * 100));
@@ -28,6 +40,7 @@ void ESP32Synth::noteOn(uint16_t voice, uint32_t freqCentiHz, uint16_t volume) {
         vo->sampleLoopMode  = vo->instSample->loopMode;
         vo->sampleLoopStart = vo->instSample->loopStart;
         vo->sampleDirection = (vo->sampleLoopMode != LOOP_REVERSE);
+        if (vo->instSample->interp != INTERP_NONE) vo->sampleInterp = vo->instSample->interp;
 
         const SampleData* sData = nullptr;
         uint32_t root = 0;
@@ -118,7 +131,8 @@ void ESP32Synth::noteOn(uint16_t voice, uint32_t freqCentiHz, uint16_t volume) {
 
     // Trigger ADSR universal
     if (!vo->inst) {
-        if (vo->rateAttack >= ENV_MAX) { // Zero attack time
+        vo->envSegState = ENV_SEG_RESTART;
+        if (vo->rateAttack >= ENV_MAX && !vo->envTable) { // Zero attack time
             vo->currEnvVal = ENV_MAX;
             vo->envState   = ENV_DECAY;
         } else {
@@ -129,14 +143,24 @@ void ESP32Synth::noteOn(uint16_t voice, uint32_t freqCentiHz, uint16_t volume) {
 }
 
 void ESP32Synth::noteOff(uint16_t voice) {
+    if (queueCommand(CMD_NOTE_OFF, voice)) return;
     if (voice < MAX_VOICES && voices[voice].active) {
-        voices[voice].envState   = ENV_RELEASE;
-        voices[voice].stageIdx   = 0; // Reset instrument stage index
-        voices[voice].controlTick = 0;
+        voices[voice].envState    = ENV_RELEASE;
+        voices[voice].envSegState = ENV_SEG_RESTART;
+#if SYNTH_ENABLE_FILTER
+        voices[voice].fenvState   = ENV_RELEASE;
+#endif
+        // controlTick lives in the engine union (it aliases wtData / samplePos1616),
+        // so only touch it when a tracker instrument actually owns that storage.
+        if (voices[voice].inst) {
+            voices[voice].stageIdx    = 0; // Reset instrument stage index
+            voices[voice].controlTick = 0;
+        }
     }
 }
 
 void ESP32Synth::setFrequency(uint16_t voice, uint32_t freqCentiHz) {
+    if (queueCommand(CMD_SET_FREQUENCY, voice, freqCentiHz)) return;
     if (voice >= MAX_VOICES) return;
     Voice* v = &voices[voice];
     v->freqVal = freqCentiHz;
@@ -160,10 +184,12 @@ void ESP32Synth::setFrequency(uint16_t voice, uint32_t freqCentiHz) {
 }
 
 void ESP32Synth::setVolume(uint16_t voice, uint16_t volume) {
+    if (queueCommand(CMD_SET_VOLUME, voice, volume)) return;
     if (voice < MAX_VOICES) voices[voice].vol = volume << _volShift;
 }
 
 void ESP32Synth::setWave(uint16_t voice, WaveType type) {
+    if (queueCommand(CMD_SET_WAVE, voice, (uint32_t)type)) return;
     if (voice < MAX_VOICES) voices[voice].type = type;
 }
 
@@ -174,11 +200,20 @@ void ESP32Synth::setPulseWidthBitDepth(uint8_t bits) {
 }
 
 void ESP32Synth::setPulseWidth(uint16_t voice, uint32_t width) {
+    if (queueCommand(CMD_SET_PULSE_WIDTH, voice, width)) return;
     // Bit-shift to convert to the engine's 32-bit phase scale. O(1) processing.
     if (voice < MAX_VOICES) voices[voice].pulseWidth = width << _pwShift;
 }
 
+// Stored as an offset into the quarter-sine pan law; mono builds keep it but never read it.
+void ESP32Synth::setPan(uint16_t voice, int8_t pan) {
+    if (queueCommand(CMD_SET_PAN, voice, (uint32_t)pan)) return;
+    if (pan < -127) pan = -127;
+    if (voice < MAX_VOICES) voices[voice].pan = (int16_t)((pan * SYNTH_PAN_MAX) / 127);
+}
+
 void ESP32Synth::setCustomWave(uint16_t voice, SynthCustomWaveCallback cb) {
+    if (queueCommand(CMD_SET_CUSTOM_WAVE, voice, 0, 0, 0, (const void*)cb)) return;
     if (voice < MAX_VOICES) {
         voices[voice].customWaveFunc = cb;
         voices[voice].type = WAVE_CUSTOM; // Automatically forces the wave type!
@@ -187,6 +222,7 @@ void ESP32Synth::setCustomWave(uint16_t voice, SynthCustomWaveCallback cb) {
 
 // --- Envelope (ADSR) ---
 void ESP32Synth::setEnv(uint16_t voice, uint16_t a, uint16_t d, uint8_t s, uint16_t r) {
+    if (queueCommand(CMD_SET_ENV, voice, a | ((uint32_t)d << 16), s, r)) return;
     if (voice >= MAX_VOICES) return;
     Voice* v = &voices[voice];
     v->levelSustain = (uint32_t)s * (ENV_MAX / 255);
@@ -199,7 +235,27 @@ void ESP32Synth::setEnv(uint16_t voice, uint16_t a, uint16_t d, uint8_t s, uint1
     v->rateRelease = (r == 0) ? ENV_MAX : ENV_MAX / ((uint32_t)r * spm);
 }
 
+// Curves apply to setEnv()'s ADSR from the next segment on; a SynthEnvelope's stages carry their own.
+void ESP32Synth::setEnvCurve(uint16_t voice, EnvCurve attack, EnvCurve decay, EnvCurve release) {
+    if (queueCommand(CMD_SET_ENV_CURVE, voice, attack, decay, release)) return;
+    if (voice >= MAX_VOICES) return;
+    Voice* v = &voices[voice];
+    if (!v->envShaped) v->envSegState = ENV_SEG_RESTART; // Pick up the running segment
+    v->envCurves = (uint8_t)((attack & 3) | ((decay & 3) << 2) | ((release & 3) << 4));
+    v->envShaped = (v->envCurves != 0) || (v->envTable != nullptr);
+}
+
+void ESP32Synth::setEnvelope(uint16_t voice, const SynthEnvelope* env) {
+    if (queueCommand(CMD_SET_ENVELOPE, voice, 0, 0, 0, env)) return;
+    if (voice >= MAX_VOICES) return;
+    Voice* v = &voices[voice];
+    v->envTable    = (env && env->numSegs > 0) ? env : nullptr;
+    v->envShaped   = (v->envCurves != 0) || (v->envTable != nullptr);
+    v->envSegState = ENV_SEG_RESTART;
+}
+
 void ESP32Synth::setSmoothEnv(uint16_t voice, bool enable) {
+    if (queueCommand(CMD_SET_SMOOTH_ENV, voice, enable)) return;
     if (voice < MAX_VOICES) {
         voices[voice].smoothEnv = enable;
     }
@@ -207,12 +263,14 @@ void ESP32Synth::setSmoothEnv(uint16_t voice, bool enable) {
 
 // --- Phase Control ---
 void ESP32Synth::setStartPhase(uint16_t voice, uint16_t phaseDegrees) {
+    if (queueCommand(CMD_SET_START_PHASE, voice, phaseDegrees)) return;
     if (voice < MAX_VOICES) {
         voices[voice].startPhase = phaseDegrees % 360;
     }
 }
 
 void ESP32Synth::setCurrentPhase(uint16_t voice, uint16_t phaseDegrees) {
+    if (queueCommand(CMD_SET_CURRENT_PHASE, voice, phaseDegrees)) return;
     if (voice >= MAX_VOICES) return;
     Voice* vo   = &voices[voice];
     uint32_t deg = phaseDegrees % 360;
@@ -231,6 +289,7 @@ void ESP32Synth::setCurrentPhase(uint16_t voice, uint16_t phaseDegrees) {
 // --- Modulation & Slides ---
 
 void ESP32Synth::setVibrato(uint16_t voice, uint32_t rateCentiHz, uint32_t depthCentiHz) {
+    if (queueCommand(CMD_SET_VIBRATO, voice, rateCentiHz, depthCentiHz)) return;
     if (voice >= MAX_VOICES) return;
     // Precise calculation that fully adapts to the current sample rate!
     voices[voice].vibRateInc  = (uint32_t)(((uint64_t)rateCentiHz  * 4294967296ULL) / ((uint64_t)_sampleRate * 100ULL));
@@ -238,24 +297,28 @@ void ESP32Synth::setVibrato(uint16_t voice, uint32_t rateCentiHz, uint32_t depth
 }
 
 void ESP32Synth::setVibratoPhase(uint16_t voice, uint16_t phaseDegrees) {
+    if (queueCommand(CMD_SET_VIBRATO_PHASE, voice, phaseDegrees)) return;
     if (voice < MAX_VOICES) {
         voices[voice].vibPhase = (uint32_t)(phaseDegrees % 360) * 11930465UL;
     }
 }
 
 void ESP32Synth::setTremolo(uint16_t voice, uint32_t rateCentiHz, uint16_t depth) {
+    if (queueCommand(CMD_SET_TREMOLO, voice, rateCentiHz, depth)) return;
     if (voice >= MAX_VOICES) return;
     voices[voice].trmRateInc = (uint32_t)(((uint64_t)rateCentiHz * 4294967296ULL) / ((uint64_t)_sampleRate * 100ULL));
     voices[voice].trmDepth   = depth;
 }
 
 void ESP32Synth::setTremoloPhase(uint16_t voice, uint16_t phaseDegrees) {
+    if (queueCommand(CMD_SET_TREMOLO_PHASE, voice, phaseDegrees)) return;
     if (voice < MAX_VOICES) {
         voices[voice].trmPhase = (uint32_t)(phaseDegrees % 360) * 11930465UL;
     }
 }
 
 void ESP32Synth::slideFreq(uint16_t voice, uint32_t startFreqCentiHz, uint32_t endFreqCentiHz, uint32_t durationMs) {
+    if (queueCommand(CMD_SLIDE_FREQ, voice, startFreqCentiHz, endFreqCentiHz, durationMs)) return;
     if (voice >= MAX_VOICES) return;
     Voice* v = &voices[voice];
     uint32_t ticks = (durationMs == 0) ? 0 : ((durationMs * controlRateHz + 999) / 1000);
@@ -288,6 +351,7 @@ void ESP32Synth::slideFreq(uint16_t voice, uint32_t startFreqCentiHz, uint32_t e
 }
 
 void ESP32Synth::slideFreqTo(uint16_t voice, uint32_t endFreqCentiHz, uint32_t durationMs) {
+    if (queueCommand(CMD_SLIDE_FREQ_TO, voice, endFreqCentiHz, durationMs)) return;
     if (voice >= MAX_VOICES) return;
     uint32_t start = voices[voice].freqVal;
     if (start == 0) { // If current frequency is 0, calculate from phaseInc
@@ -321,34 +385,60 @@ void ESP32Synth::slideVolAbsolute(uint16_t voice, uint16_t startVol16, uint16_t
 }
 
 void ESP32Synth::slideVol(uint16_t voice, uint16_t startVol, uint16_t endVol, uint32_t durationMs) {
+    if (queueCommand(CMD_SLIDE_VOL, voice, startVol, endVol, durationMs)) return;
     // Converts the user-facing resolution and passes it to the absolute internal engine
     slideVolAbsolute(voice, startVol << _volShift, endVol << _volShift, durationMs);
 }
 
 void ESP32Synth::slideVolTo(uint16_t voice, uint16_t endVol, uint32_t durationMs) {
+    if (queueCommand(CMD_SLIDE_VOL_TO, voice, endVol, durationMs)) return;
     if (voice >= MAX_VOICES) return;
     slideVolAbsolute(voice, voices[voice].vol, endVol << _volShift, durationMs);
 }
 
 // --- Wavetable & Instruments ---
 
-void ESP32Synth::setWavetable(uint16_t voice, const void* data, uint32_t size, BitDepth depth) {
+void ESP32Synth::setWavetable(uint16_t voice, const void* data, uint32_t size, BitDepth depth, bool interpolate) {
+    if (queueCommand(CMD_SET_WAVETABLE, voice, size, (uint32_t)depth, interpolate, data)) return;
     if (voice < MAX_VOICES) {
-        voices[voice].wtData = data;
-        voices[voice].wtSize = size;
-        voices[voice].depth  = depth;
+        voices[voice].wtData   = data;
+        voices[voice].wtSize   = size;
+        voices[voice].wtMip    = nullptr;
+        voices[voice].depth    = depth;
+        voices[voice].wtInterp = interpolate;
     }
 }
 
-void ESP32Synth::registerWavetable(uint16_t id, const void* data, uint32_t size, BitDepth depth) {
+void ESP32Synth::setWavetableMip(uint16_t voice, const WavetableMip* mip, bool interpolate) {
+    if (queueCommand(CMD_SET_WAVETABLE_MIP, voice, 0, 0, interpolate, mip)) return;
+    if (voice >= MAX_VOICES) return;
+    if (!mip || mip->numLevels == 0) { setWavetable(voice, nullptr, 0, BITS_16, interpolate); return; }
+    // Level 0 until the first block picks the level for the current pitch.
+    voices[voice].wtData   = mip->levels[0];
+    voices[voice].wtSize   = mip->sizes[0];
+    voices[voice].wtMip    = mip;
+    voices[voice].depth    = mip->depth;
+    voices[voice].wtInterp = interpolate;
+}
+
+void ESP32Synth::registerWavetable(uint16_t id, const void* data, uint32_t size, BitDepth depth, bool interpolate) {
     if (id < MAX_WAVETABLES) {
-        wavetables[id].data  = data;
-        wavetables[id].size  = size;
-        wavetables[id].depth = depth;
+        wavetables[id].data   = data;
+        wavetables[id].size   = size;
+        wavetables[id].depth  = depth;
+        wavetables[id].interp = interpolate;
+        wavetables[id].mip    = nullptr;
     }
 }
 
+void ESP32Synth::registerWavetableMip(uint16_t id, const WavetableMip* mip, bool interpolate) {
+    if (id >= MAX_WAVETABLES || !mip || mip->numLevels == 0) return;
+    registerWavetable(id, mip->levels[0], mip->sizes[0], mip->depth, interpolate);
+    wavetables[id].mip = mip;
+}
+
 void ESP32Synth::setInstrument(uint16_t voice, Instrument* inst) {
+    if (queueCommand(CMD_SET_INSTRUMENT, voice, 0, 0, 0, inst)) return;
     if (voice >= MAX_VOICES) return;
     voices[voice].inst       = inst;
     voices[voice].instSample = nullptr;
@@ -359,6 +449,7 @@ void ESP32Synth::setInstrument(uint16_t voice, Instrument* inst) {
 }
 
 void ESP32Synth::setInstrument(uint16_t voice, Instrument_Sample* inst) {
+    if (queueCommand(CMD_SET_INSTRUMENT_SAMPLE, voice, 0, 0, 0, inst)) return;
     if (voice >= MAX_VOICES) return;
     voices[voice].instSample = inst;
     voices[voice].inst       = nullptr;
@@ -367,6 +458,7 @@ void ESP32Synth::setInstrument(uint16_t voice, Instrument_Sample* inst) {
 }
 
 void ESP32Synth::detachInstrument(uint16_t voice, WaveType newWaveType) {
+    if (queueCommand(CMD_DETACH_INSTRUMENT, voice, (uint32_t)newWaveType)) return;
     if (voice >= MAX_VOICES) return;
     setInstrument(voice, (Instrument*)nullptr);
     setWave(voice, newWaveType);
@@ -386,6 +478,7 @@ bool ESP32Synth::registerSample(uint16_t sampleId, const void* data, uint32_t le
 }
 
 void ESP32Synth::setSample(uint16_t voice, uint16_t sampleId, LoopMode loopMode, uint32_t loopStart, uint32_t loopEnd) {
+    if (queueCommand(CMD_SET_SAMPLE, voice, sampleId | ((uint32_t)loopMode << 16), loopStart, loopEnd)) return;
     if (voice >= MAX_VOICES || sampleId >= MAX_SAMPLES) return;
     Voice* v = &voices[voice];
     v->type            = WAVE_SAMPLE;
@@ -397,6 +490,7 @@ void ESP32Synth::setSample(uint16_t voice, uint16_t sampleId, LoopMode loopMode,
 }
 
 void ESP32Synth::setSampleLoop(uint16_t voice, LoopMode loopMode, uint32_t loopStart, uint32_t loopEnd) {
+    if (queueCommand(CMD_SET_SAMPLE_LOOP, voice, (uint32_t)loopMode, loopStart, loopEnd)) return;
     if (voice < MAX_VOICES) {
         Voice* v           = &voices[voice];
         v->sampleLoopMode  = loopMode;
@@ -405,8 +499,43 @@ void ESP32Synth::setSampleLoop(uint16_t voice, LoopMode loopMode, uint32_t loopS
     }
 }
 
+void ESP32Synth::setSampleInterp(uint16_t voice, SampleInterp mode) {
+    if (queueCommand(CMD_SET_SAMPLE_INTERP, voice, (uint32_t)mode)) return;
+    if (voice < MAX_VOICES && mode <= INTERP_HERMITE) voices[voice].sampleInterp = mode;
+}
+
 // --- Arpeggiator ---
 
+// The note list rides two notes per CMD_SET_ARP_NOTES, followed by the CMD_SET_ARPEGGIO
+// that starts it; they are queued as one group, so no block sees half a list.
+static_assert((MAX_ARP_NOTES + 1) / 2 + 1 <= SYNTH_CMD_BATCH_MAX, "An arpeggio must fit in one command batch");
+
+void ESP32Synth::applyArpeggio(uint16_t voice, uint16_t durationMs, const uint32_t* notes, size_t count) {
+    if (voice >= MAX_VOICES) return;
+    if (count > MAX_ARP_NOTES) count = MAX_ARP_NOTES;
+
+    if (_cmdQueueOn) {
+        SynthCommand cmds[(MAX_ARP_NOTES + 1) / 2 + 1];
+        int n = 0;
+        for (size_t i = 0; i < count; i += 2) {
+            cmds[n++] = { 0, CMD_SET_ARP_NOTES, 1, voice, (uint32_t)i, notes[i], (i + 1 < count) ? notes[i + 1] : 0, 0, nullptr };
+        }
+        cmds[n++] = { 0, CMD_SET_ARPEGGIO, 1, voice, (uint32_t)count, durationMs, 0, 0, nullptr };
+        if (queueCommands(cmds, n)) return;
+    }
+
+    Voice* v = &voices[voice];
+    for (size_t i = 0; i < count; i++) {
+        v->arpNotes[i] = notes[i];
+    }
+    v->arpLen         = count;
+    v->arpSpeedMs     = durationMs;
+    v->arpIdx         = 0;
+    v->arpTickCounter = 0;
+    v->arpActive      = true;
+}
+
 void ESP32Synth::detachArpeggio(uint16_t voice) {
+    if (queueCommand(CMD_DETACH_ARPEGGIO, voice)) return;
     if (voice < MAX_VOICES) voices[voice].arpActive = false;
 }
\ No newline at end of file
@@ -0,0 +1,325 @@
+#pragma once
+#include "ESP32Synth.h"
+
+// ====================================================================================
+//    DELAY EFFECTS
+// ====================================================================================
+// SynthDelay, SynthChorus and SynthFlanger: one DelayLine per mix channel, holding the mix
+// >> FXD_SHIFT as int16. Modulated delays are computed at the ends of each slice and
+// ramped linearly in between, so the LFO costs two table reads per tap per slice.
+//
+// The chorus has no feedback, so it writes the slice first and reads its taps with the
+// block API. The echo and the flanger feed back through delays that can be shorter than
+// a slice and run sample by sample.
+
+#define FXD_SHIFT   2   // Mix -> line headroom
+#define FXD_MAX_LFO 128 // Largest echo glide step: half a sample per sample (Q8)
+
+static FORCE_INLINE int16_t fxdIn(int32_t x) {
+    return (int16_t)masterClamp16(x >> FXD_SHIFT);
+}
+
+// dry * dryQ8 + wet (line scale) * wetQ8, both gains Q8
+static FORCE_INLINE int32_t fxdMix(int32_t dry, int32_t wet, int32_t dryQ8, int32_t wetQ8) {
+    return (int32_t)(((int64_t)dry * dryQ8) >> 8) + ((wet * wetQ8) >> (8 - FXD_SHIFT));
+}
+
+static uint32_t fxdUsToQ8(uint32_t us, uint32_t sampleRate) {
+    return (uint32_t)(((uint64_t)us * sampleRate * 256) / 1000000);
+}
+
+// num / den beats at 'bpm', in microseconds
+static uint32_t fxdBeatsUs(float bpm, uint8_t num, uint8_t den) {
+    if (bpm <= 0.0f || num == 0 || den == 0) return 0;
+    return (uint32_t)(60000000.0f * num / (bpm * den) + 0.5f);
+}
+
+// LFO delay: base + depth * (1 + sin) / 2, Q8
+static FORCE_INLINE uint32_t fxdLfoDelay(uint32_t baseQ8, uint32_t depthQ8, uint32_t phase) {
+    return baseQ8 + (uint32_t)(((uint64_t)depthQ8 * (uint32_t)(sineLUT[phase >> SINE_SHIFT] + 32768)) >> 16);
+}
+
+// Samples until 'delay'-spaced repeats scaled by 'gain' (Q 'bits') fall by 60 dB
+static uint32_t fxdRepeatTail(uint32_t delaySamples, int32_t gain, int bits) {
+    if (gain < 0) gain = -gain;
+    double repeats = 1.0;
+    if (gain > 0) repeats += log(0.001) / log((double)gain / (1 << bits));
+    double tail = repeats * delaySamples;
+    return (tail > 2e9) ? 2000000000UL : (uint32_t)tail;
+}
+
+// ------------------------------------------------------------------------------------
+//    Echo
+// ------------------------------------------------------------------------------------
+bool SynthDelay::begin(uint32_t sampleRate, uint16_t maxMs) {
+    end();
+    if (sampleRate == 0 || maxMs == 0) return false;
+    _sampleRate   = sampleRate;
+    uint32_t most = (uint32_t)(((uint64_t)maxMs * sampleRate) / 1000);
+    for (int c = 0; c < SYNTH_MIX_CHANNELS; c++) {
+        if (!_line[c].begin(most + 1)) { end(); return false; }
+    }
+    _maxQ8 = most << 8;
+    updateTime();
+    _delayQ8 = _targetQ8;
+    setTone(_toneCentiHz);
+    reset();
+    return true;
+}
+
+void SynthDelay::end() {
+    for (int c = 0; c < SYNTH_MIX_CHANNELS; c++) _line[c].end();
+    _maxQ8 = 0;
+    _tail  = 0;
+}
+
+void SynthDelay::reset() {
+    for (int c = 0; c < SYNTH_MIX_CHANNELS; c++) { _line[c].clear(); _lp[c] = 0; }
+    _delayQ8 = _targetQ8;
+}
+
+void SynthDelay::updateTime() {
+    if (!_maxQ8) return;
+    uint32_t q8 = fxdUsToQ8(_timeUs, _sampleRate);
+    _targetQ8   = (q8 < 256) ? 256 : (q8 > _maxQ8) ? _maxQ8 : q8;
+    _tail       = fxdRepeatTail(_targetQ8 >> 8, _feedback, 8);
+}
+
+void SynthDelay::setTime(uint16_t ms) {
+    _timeUs = (uint32_t)ms * 1000;
+    updateTime();
+}
+
+void SynthDelay::setTempo(float bpm, uint8_t num, uint8_t den) {
+    uint32_t us = fxdBeatsUs(bpm, num, den);
+    if (!us) return;
+    _timeUs = us;
+    updateTime();
+}
+
+void SynthDelay::setFeedback(uint8_t feedback) {
+    _feedback = feedback;
+    updateTime();
+}
+
+void SynthDelay::setTone(uint32_t cutoffCentiHz) {
+    _toneCentiHz = cutoffCentiHz;
+    _toneA       = fxOnePoleQ15(cutoffCentiHz, _sampleRate);
+}
+
+void SynthDelay::setMix(uint8_t wet, uint8_t dry) {
+    _wet = fxGainQ8(wet);
+    _dry = fxGainQ8(dry);
+}
+
+// A new time is reached by gliding at most FXD_MAX_LFO per sample, like a tape delay's
+// pitch bend, instead of jumping (which clicks).
+void IRAM_ATTR SynthDelay::process(int32_t* mix, int frames) {
+    if (!_maxQ8) return;
+    const int32_t fb = _feedback, a = _toneA, wet = _wet, dry = _dry;
+    for (int pos = 0; pos < frames; pos += SYNTH_FX_BLOCK) {
+        const int n    = (frames - pos < SYNTH_FX_BLOCK) ? frames - pos : SYNTH_FX_BLOCK;
+        int32_t   step = ((int32_t)(_targetQ8 - _delayQ8)) / n;
+        if (step > FXD_MAX_LFO) step = FXD_MAX_LFO;
+        if (step < -FXD_MAX_LFO) step = -FXD_MAX_LFO;
+
+        for (int c = 0; c < SYNTH_MIX_CHANNELS; c++) {
+            DelayLine& line = _line[c];
+            int32_t*   m    = mix + pos * SYNTH_MIX_CHANNELS + c;
+            int32_t    lp   = _lp[c];
+            uint32_t   d    = _delayQ8;
+            for (int i = 0; i < n; i++, d += step, m += SYNTH_MIX_CHANNELS) {
+                const int32_t y = line.readLinear(d);
+                lp += ((y - lp) * a + 16384) >> 15;
+                line.write((int16_t)masterClamp16((*m >> FXD_SHIFT) + ((lp * fb) >> 8)));
+                *m = fxdMix(*m, y, dry, wet);
+            }
+            _lp[c] = lp;
+        }
+        _delayQ8 += (uint32_t)(step * n);
+    }
+}
+
+// ------------------------------------------------------------------------------------
+//    Chorus
+// ------------------------------------------------------------------------------------
+#define CHORUS_MAX_US 40000
+
+bool SynthChorus::begin(uint32_t sampleRate) {
+    end();
+    if (sampleRate == 0) return false;
+    _sampleRate = sampleRate;
+    const uint32_t most = (uint32_t)(((uint64_t)CHORUS_MAX_US * sampleRate) / 1000000) + SYNTH_FX_BLOCK + 2;
+    for (int c = 0; c < SYNTH_MIX_CHANNELS; c++) {
+        if (!_line[c].begin(most)) { end(); return false; }
+    }
+    update();
+    reset();
+    return true;
+}
+
+void SynthChorus::end() {
+    for (int c = 0; c < SYNTH_MIX_CHANNELS; c++) _line[c].end();
+    _tail = 0;
+}
+
+void SynthChorus::reset() {
+    for (int c = 0; c < SYNTH_MIX_CHANNELS; c++) { _line[c].clear(); _ap[c][0] = _ap[c][1] = 0; }
+}
+
+void SynthChorus::update() {
+    uint32_t base  = (_baseUs < 1000) ? 1000 : _baseUs;
+    uint32_t swing = _depthUs;
+    if (base > CHORUS_MAX_US) base = CHORUS_MAX_US;
+    if (base + swing > CHORUS_MAX_US) swing = CHORUS_MAX_US - base;
+    _baseQ8  = fxdUsToQ8(base, _sampleRate);
+    _depthQ8 = fxdUsToQ8(swing, _sampleRate);
+    _lfoInc  = (uint32_t)(_rateHz * 4294967296.0 / _sampleRate);
+    _tail    = ((_baseQ8 + _depthQ8) >> 8) + 2;
+}
+
+void SynthChorus::setDelay(uint16_t baseUs, uint16_t depthUs) {
+    _baseUs  = baseUs;
+    _depthUs = depthUs;
+    update();
+}
+
+void SynthChorus::setRate(uint16_t centiHz) {
+    _rateHz = centiHz * 0.01f;
+    update();
+}
+
+void SynthChorus::setTempo(float bpm, uint8_t num, uint8_t den) {
+    uint32_t us = fxdBeatsUs(bpm, num, den);
+    if (!us) return;
+    _rateHz = 1000000.0f / us;
+    update();
+}
+
+void SynthChorus::setMix(uint8_t wet, uint8_t dry) {
+    _wet = fxGainQ8(wet);
+    _dry = fxGainQ8(dry);
+}
+
+// Two taps per channel, half an LFO cycle apart; the right channel runs a quarter cycle
+// behind the left.
+void IRAM_ATTR SynthChorus::process(int32_t* mix, int frames) {
+    if (!_line[0].length()) return;
+    const int32_t wet = _wet, dry = _dry;
+
+    for (int pos = 0; pos < frames; pos += SYNTH_FX_BLOCK) {
+        const int      n        = (frames - pos < SYNTH_FX_BLOCK) ? frames - pos : SYNTH_FX_BLOCK;
+        const uint32_t phaseEnd = _lfoPhase + _lfoInc * (uint32_t)n;
+        int32_t*       buf      = mix + pos * SYNTH_MIX_CHANNELS;
+
+        for (int c = 0; c < SYNTH_MIX_CHANNELS; c++) {
+            DelayLine& line = _line[c];
+            for (int i = 0; i < n; i++) _in[i] = fxdIn(buf[i * SYNTH_MIX_CHANNELS + c]);
+            line.writeBlock(_in, n);
+
+            for (int t = 0; t < 2; t++) {
+                const uint32_t off    = 0x80000000UL * t + 0x40000000UL * c;
+                const uint32_t dStart = fxdLfoDelay(_baseQ8, _depthQ8, _lfoPhase + off);
+                const uint32_t dEnd   = fxdLfoDelay(_baseQ8, _depthQ8, phaseEnd + off);
+                const int32_t  stp    = ((int32_t)(dEnd - dStart)) / n;
+                line.readBlock(_tap[t], dStart + ((uint32_t)n << 8), stp, n, _interp, &_ap[c][t]);
+            }
+            for (int i = 0; i < n; i++) {
+                int32_t& m = buf[i * SYNTH_MIX_CHANNELS + c];
+                m = fxdMix(m, (_tap[0][i] + _tap[1][i]) >> 1, dry, wet);
+            }
+        }
+        _lfoPhase = phaseEnd;
+    }
+}
+
+// ------------------------------------------------------------------------------------
+//    Flanger
+// ------------------------------------------------------------------------------------
+#define FLANGER_MAX_US 10000
+
+bool SynthFlanger::begin(uint32_t sampleRate) {
+    end();
+    if (sampleRate == 0) return false;
+    _sampleRate = sampleRate;
+    const uint32_t most = (uint32_t)(((uint64_t)FLANGER_MAX_US * sampleRate) / 1000000) + 2;
+    for (int c = 0; c < SYNTH_MIX_CHANNELS; c++) {
+        if (!_line[c].begin(most)) { end(); return false; }
+    }
+    update();
+    reset();
+    return true;
+}
+
+void SynthFlanger::end() {
+    for (int c = 0; c < SYNTH_MIX_CHANNELS; c++) _line[c].end();
+    _tail = 0;
+}
+
+void SynthFlanger::reset() {
+    for (int c = 0; c < SYNTH_MIX_CHANNELS; c++) { _line[c].clear(); _ap[c] = 0; }
+}
+
+// The allpass read needs 1.5 samples of delay, the linear one a whole sample.
+void SynthFlanger::update() {
+    uint32_t base  = (_baseUs > FLANGER_MAX_US) ? FLANGER_MAX_US : _baseUs;
+    uint32_t swing = (base + _depthUs > FLANGER_MAX_US) ? FLANGER_MAX_US - base : _depthUs;
+    _baseQ8  = fxdUsToQ8(base, _sampleRate);
+    if (_baseQ8 < 384) _baseQ8 = 384;
+    _depthQ8 = fxdUsToQ8(swing, _sampleRate);
+    _lfoInc  = (uint32_t)(_rateHz * 4294967296.0 / _sampleRate);
+    _tail    = fxdRepeatTail(((_baseQ8 + _depthQ8) >> 8) + 1, _feedback, 7);
+}
+
+void SynthFlanger::setDelay(uint16_t baseUs, uint16_t depthUs) {
+    _baseUs  = baseUs;
+    _depthUs = depthUs;
+    update();
+}
+
+void SynthFlanger::setRate(uint16_t centiHz) {
+    _rateHz = centiHz * 0.01f;
+    update();
+}
+
+void SynthFlanger::setTempo(float bpm, uint8_t num, uint8_t den) {
+    uint32_t us = fxdBeatsUs(bpm, num, den);
+    if (!us) return;
+    _rateHz = 1000000.0f / us;
+    update();
+}
+
+void SynthFlanger::setFeedback(int8_t feedback) {
+    _feedback = (feedback < -127) ? -127 : feedback;
+    update();
+}
+
+void SynthFlanger::setMix(uint8_t wet, uint8_t dry) {
+    _wet = fxGainQ8(wet);
+    _dry = fxGainQ8(dry);
+}
+
+void IRAM_ATTR SynthFlanger::process(int32_t* mix, int frames) {
+    if (!_line[0].length()) return;
+    const int32_t fb = _feedback, wet = _wet, dry = _dry;
+    const bool    ap = (_interp == DELAY_ALLPASS);
+
+    for (int pos = 0; pos < frames; pos += SYNTH_FX_BLOCK) {
+        const int      n        = (frames - pos < SYNTH_FX_BLOCK) ? frames - pos : SYNTH_FX_BLOCK;
+        const uint32_t phaseEnd = _lfoPhase + _lfoInc * (uint32_t)n;
+
+        for (int c = 0; c < SYNTH_MIX_CHANNELS; c++) {
+            DelayLine&     line = _line[c];
+            const uint32_t off  = 0x40000000UL * c;
+            uint32_t       d    = fxdLfoDelay(_baseQ8, _depthQ8, _lfoPhase + off);
+            const int32_t  stp  = ((int32_t)(fxdLfoDelay(_baseQ8, _depthQ8, phaseEnd + off) - d)) / n;
+            int32_t*       m    = mix + pos * SYNTH_MIX_CHANNELS + c;
+            for (int i = 0; i < n; i++, d += stp, m += SYNTH_MIX_CHANNELS) {
+                const int32_t y = ap ? line.readAllpass(d, _ap[c]) : line.readLinear(d);
+                line.write((int16_t)masterClamp16((*m >> FXD_SHIFT) + ((y * fb) >> 7)));
+                *m = fxdMix(*m, y, dry, wet);
+            }
+        }
+        _lfoPhase = phaseEnd;
+    }
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include "ESP32Synth.h"
+
+// ====================================================================================
+//    DELAY LINE
+// ====================================================================================
+// One int16 ring per line. The length is a power of two, so wrapping an index is an AND
+// and the block copies split into at most two memcpy. Short lines (chorus, flanger) stay
+// in internal RAM; long ones (echo, reverb) go to PSRAM, where sequential block access is
+// what the cache handles best.
+
+// Buffers of SYNTH_DELAY_PSRAM_MIN bytes or more prefer PSRAM, smaller ones internal RAM;
+// each falls back to the other. 'psram' tells where it went.
+static void* synthDelayAlloc(size_t bytes, bool& psram) {
+    const uint32_t internal = MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
+    const uint32_t external = MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT;
+    psram   = (bytes >= SYNTH_DELAY_PSRAM_MIN);
+    void* p = heap_caps_malloc(bytes, psram ? external : internal);
+    if (!p) {
+        psram = !psram;
+        p     = heap_caps_malloc(bytes, psram ? external : internal);
+    }
+    return p;
+}
+
+DelayLine::~DelayLine() {
+    end();
+}
+
+bool DelayLine::begin(uint32_t maxDelay) {
+    end();
+    uint32_t len = 16;
+    while (len < maxDelay + 2 && len < 0x40000000UL) len <<= 1; // + the interpolation neighbour
+    _buf = (int16_t*)synthDelayAlloc(len * sizeof(int16_t), _psram);
+    if (!_buf) return false;
+    _mask = len - 1;
+    clear();
+    return true;
+}
+
+void DelayLine::end() {
+    if (_buf) heap_caps_free(_buf);
+    _buf   = nullptr;
+    _mask  = 0;
+    _w     = 0;
+    _psram = false;
+}
+
+void DelayLine::clear() {
+    if (_buf) memset(_buf, 0, length() * sizeof(int16_t));
+    _w = 0;
+}
+
+// First-order allpass between the samples N and N + 1 back: y = b + eta * (a - y1) with
+// eta = (1 - f) / (1 + f). Splitting the delay so that f stays in [0.5, 1.5) keeps |eta|
+// <= 1/3, away from the pole at -1 that rings at Nyquist.
+static FORCE_INLINE int32_t delayAllpass(const int16_t* buf, uint32_t mask, uint32_t w, uint32_t delayQ8, int32_t y1) {
+    const uint32_t d   = delayQ8 - 128;
+    const int32_t  f   = (int32_t)(d & 0xFF) + 128;
+    const int32_t  eta = ((256 - f) * 32768) / (256 + f);
+    const uint32_t p   = w - (d >> 8);
+    const int32_t  a   = buf[p & mask];
+    return buf[(p - 1) & mask] + (((a - y1) * eta) >> 15);
+}
+
+int32_t DelayLine::readAllpass(uint32_t delayQ8, int32_t& state) const {
+    state = delayAllpass(_buf, _mask, _w, delayQ8, state);
+    return state;
+}
+
+void DelayLine::writeBlock(const int16_t* src, int n) {
+    const uint32_t len   = length();
+    const uint32_t first = (_w + (uint32_t)n <= len) ? (uint32_t)n : len - _w;
+    memcpy(_buf + _w, src, first * sizeof(int16_t));
+    if (first < (uint32_t)n) memcpy(_buf, src + first, (n - first) * sizeof(int16_t));
+    _w = (_w + (uint32_t)n) & _mask;
+}
+
+void DelayLine::readBlock(int16_t* dst, uint32_t delay, int n) const {
+    const uint32_t len   = length();
+    const uint32_t at    = (_w - delay) & _mask;
+    const uint32_t first = (at + (uint32_t)n <= len) ? (uint32_t)n : len - at;
+    memcpy(dst, _buf + at, first * sizeof(int16_t));
+    if (first < (uint32_t)n) memcpy(dst + first, _buf, (n - first) * sizeof(int16_t));
+}
+
+void IRAM_ATTR DelayLine::readBlock(int32_t* dst, uint32_t delayQ8, int32_t stepQ8, int n, DelayInterp interp, int32_t* state) const {
+    const int16_t* buf  = _buf;
+    const uint32_t mask = _mask;
+    if (interp == DELAY_ALLPASS && state) {
+        int32_t y = *state;
+        for (int i = 0; i < n; i++, delayQ8 += stepQ8) dst[i] = y = delayAllpass(buf, mask, _w + i, delayQ8, y);
+        *state = y;
+        return;
+    }
+    for (int i = 0; i < n; i++, delayQ8 += stepQ8) {
+        const uint32_t p = _w + i - (delayQ8 >> 8);
+        const int32_t  a = buf[p & mask];
+        dst[i] = a + (((buf[(p - 1) & mask] - a) * (int32_t)(delayQ8 & 0xFF)) >> 8);
+    }
+}
@@ -0,0 +1,177 @@
+#pragma once
+#include "ESP32Synth.h"
+
+// ====================================================================================
+//    DUAL-CORE VOICE RENDERING
+// ====================================================================================
+// render() buckets the sounding voices by kernel (see classifyVoiceKernel). In dual-core
+// mode the bucketed list is cut in two: the audio task keeps the front of the list plus
+// every custom-callback voice (user code is not assumed to be thread-safe), and a worker
+// task pinned to SYNTH_WORKER_TASK_CORE renders the rest into its own mix buffer. The cut
+// is placed where the estimated cost is halved, using each kernel's cycles per voice per
+// sample measured in the previous blocks, and both buffers are summed before the DSP hook.
+// The worker keeps one buffer per mix bus, so every voice still lands on its own bus.
+
+// dst += src over 'words' words, a multiple of 4, both buffers 16-byte aligned
+static inline void workerMerge(int32_t* dst, const int32_t* src, int words) {
+#if defined(CONFIG_IDF_TARGET_ESP32S3)
+    for (int i = 0; i < words; i += 4) *(v4i32*)&dst[i] += *(const v4i32*)&src[i];
+#else
+    for (int i = 0; i < words; i++) dst[i] += src[i];
+#endif
+}
+
+bool ESP32Synth::setDualCore(bool enable) {
+#if SYNTH_ENABLE_DUAL_CORE
+    if (!enable) {
+        _dualCore = false; // The worker stays parked until end(); re-enabling is instant.
+        return true;
+    }
+    if (portNUM_PROCESSORS < 2) return false;
+    if (!startVoiceWorker()) return false;
+    _dualCore = true;
+    return true;
+#else
+    return !enable;
+#endif
+}
+
+bool ESP32Synth::isDualCore() {
+#if SYNTH_ENABLE_DUAL_CORE
+    return _dualCore;
+#else
+    return false;
+#endif
+}
+
+#if SYNTH_ENABLE_DUAL_CORE
+void ESP32Synth::voiceWorkerTask(void* param) {
+    ESP32Synth* synth = (ESP32Synth*)param;
+    while (true) {
+        xSemaphoreTake(synth->_workerStart, portMAX_DELAY);
+        if (synth->_workerQuit) break;
+
+        for (int b = 0; b < SYNTH_MAX_BUSES; b++) {
+            if ((synth->_spanBuses >> b) & 1) memset(synth->_workerOut[b], 0, synth->_workerSamples * SYNTH_MIX_CHANNELS * sizeof(int32_t));
+        }
+        synth->renderBuckets(synth->_workerOut, synth->_workerSamples, synth->_workerFrom, synth->_workerTo, &synth->_workerTiming, true);
+
+        xSemaphoreGive(synth->_workerDone);
+    }
+    synth->_workerTaskHandle = NULL;
+    vTaskDelete(NULL);
+}
+
+bool ESP32Synth::startVoiceWorker() {
+    if (_workerTaskHandle != NULL) return true;
+
+    // Large enough for the render block and the 128-sample chunks of generateSamples().
+    // A later setLatency() with longer blocks restarts the engine, and with it the worker.
+    int len = (_dmaBufLen > 128) ? _dmaBufLen : 128;
+    len = (len + 3) & ~3;
+
+    _workerMix   = (int32_t*)heap_caps_aligned_alloc(16, len * SYNTH_MIX_CHANNELS * sizeof(int32_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    _workerStart = xSemaphoreCreateBinary();
+    _workerDone  = xSemaphoreCreateBinary();
+    _workerMixLen = len;
+    _workerQuit   = false;
+    _workerOut[0] = _workerMix;
+    if (_busMix) allocWorkerBusMix();
+
+    // Until the first measurement every kernel is assumed to cost the same.
+    for (int k = 0; k < RK_NUM_KERNELS; k++) _kernelCost[k] = 8 << 8;
+
+    if (!_workerMix || !_workerStart || !_workerDone ||
+        xTaskCreatePinnedToCore(voiceWorkerTask, "SynthWorker", 4096, this, SYNTH_WORKER_TASK_PRIORITY, &_workerTaskHandle, SYNTH_WORKER_TASK_CORE) != pdPASS) {
+        _workerTaskHandle = NULL;
+        stopVoiceWorker();
+        return false;
+    }
+    return true;
+}
+
+// Only called once nothing can be inside render() any more (end()).
+void ESP32Synth::stopVoiceWorker() {
+    _dualCore = false;
+    if (_workerTaskHandle != NULL) {
+        _workerQuit = true;
+        xSemaphoreGive(_workerStart);
+        while (_workerTaskHandle != NULL) { vTaskDelay(pdMS_TO_TICKS(2)); }
+    }
+    if (_workerStart) { vSemaphoreDelete(_workerStart); _workerStart = NULL; }
+    if (_workerDone)  { vSemaphoreDelete(_workerDone);  _workerDone  = NULL; }
+    if (_workerMix)   { heap_caps_free(_workerMix);     _workerMix   = nullptr; }
+    if (_workerBusMix) { heap_caps_free(_workerBusMix); _workerBusMix = nullptr; }
+    _workerMixLen = 0;
+}
+
+// The worker's blocks for buses 1.., allocated next to the mix buses (allocBusMix(), or
+// startVoiceWorker() once they exist). Until then a span with a voice off the main mix
+// renders on the audio task alone.
+void ESP32Synth::allocWorkerBusMix() {
+#if SYNTH_MAX_BUSES > 1
+    if (!_workerMix || _workerBusMix) return;
+    int32_t* mem = (int32_t*)heap_caps_aligned_alloc(16, (size_t)_workerMixLen * (SYNTH_MAX_BUSES - 1) * SYNTH_MIX_CHANNELS * sizeof(int32_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!mem) return;
+    for (int b = 1; b < SYNTH_MAX_BUSES; b++) _workerOut[b] = mem + (b - 1) * _workerMixLen * SYNTH_MIX_CHANNELS;
+    __atomic_store_n(&_workerBusMix, mem, __ATOMIC_RELEASE);
+#endif
+}
+
+// Returns false when the block is not worth splitting; render() then renders it alone.
+bool IRAM_ATTR ESP32Synth::renderVoicesDual(int samples, int numBlockVoices) {
+    if (numBlockVoices < SYNTH_DUAL_CORE_MIN_VOICES || samples > _workerMixLen) return false;
+    if (_spanBuses > 1 && !__atomic_load_n(&_workerBusMix, __ATOMIC_ACQUIRE)) return false;
+
+    const uint16_t* bs = _bucketStart;
+    uint32_t total = 0;
+    for (int k = 0; k < RK_NUM_KERNELS; k++) total += (uint32_t)(bs[k + 1] - bs[k]) * _kernelCost[k];
+
+    // The audio task keeps [0, split) plus the custom bucket; aim for half of the total.
+    uint32_t custom = (uint32_t)(bs[RK_CUSTOM + 1] - bs[RK_CUSTOM]) * _kernelCost[RK_CUSTOM];
+    uint32_t want   = (total / 2 > custom) ? total / 2 - custom : 0;
+    uint32_t acc    = 0;
+    int      split  = 0;
+    for (int k = 0; k < RK_CUSTOM; k++) {
+        uint32_t c = (uint32_t)(bs[k + 1] - bs[k]) * _kernelCost[k];
+        if (acc + c <= want) { acc += c; split = bs[k + 1]; continue; }
+        split = bs[k] + (want - acc + _kernelCost[k] / 2) / _kernelCost[k];
+        break;
+    }
+    const int workerEnd = bs[RK_CUSTOM];
+    if (split >= workerEnd) return false;
+
+    KernelTiming mainTiming = {};
+    memset(&_workerTiming, 0, sizeof(_workerTiming));
+    _workerFrom    = split;
+    _workerTo      = workerEnd;
+    _workerSamples = samples;
+    xSemaphoreGive(_workerStart);
+
+    renderBuckets(_busOut, samples, 0, split, &mainTiming, false);
+    renderBuckets(_busOut, samples, workerEnd, numBlockVoices, &mainTiming, false);
+
+    // Per-block barrier: the worker's share must be in before the DSP hook sees the mix.
+    xSemaphoreTake(_workerDone, portMAX_DELAY);
+
+    for (int b = 0; b < SYNTH_MAX_BUSES; b++) {
+        if ((_spanBuses >> b) & 1) workerMerge(_busOut[b], _workerOut[b], samples * SYNTH_MIX_CHANNELS);
+    }
+
+    // Fold this block's measurements into the per-kernel cost estimate (1/4 weight).
+    for (int k = 0; k < RK_NUM_KERNELS; k++) {
+        uint32_t n = (uint32_t)mainTiming.voices[k] + _workerTiming.voices[k];
+        if (n == 0) continue;
+        uint64_t cycles   = (uint64_t)mainTiming.cycles[k] + _workerTiming.cycles[k];
+        uint32_t measured = (uint32_t)((cycles << 8) / (n * (uint32_t)samples));
+        if (measured > 65535) measured = 65535;
+        int32_t cost = _kernelCost[k] + (((int32_t)measured - (int32_t)_kernelCost[k]) >> 2);
+        _kernelCost[k] = (cost < 1) ? 1 : (uint16_t)cost;
+    }
+
+#if SYNTH_ENABLE_PROFILER
+    profMergeWorker();
+#endif
+    return true;
+}
+#endif
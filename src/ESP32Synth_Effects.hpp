@@ -0,0 +1,263 @@
+#pragma once
+#include "ESP32Synth.h"
+
+// ====================================================================================
+//    EFFECT CHAIN
+// ====================================================================================
+// addEffect() builds an ordered chain of SynthEffect stages that render() runs over the
+// mix after the voices. The block is cut into SYNTH_FX_BLOCK frame slices, so every stage
+// works on a short block that stays in cache and the chain needs only two preallocated
+// scratch slices, whatever the DMA block size.
+//
+// Edits never touch the list the audio task is reading: the stage list is double
+// buffered, an edit fills the idle copy and publishes it with one store, and the audio
+// task picks it up at the start of its next block. A stage that is switched on or off
+// (add / remove / bypass) crossfades between its input and its output over one slice
+// instead of jumping, so edits do not click.
+//
+// Once a stage's input has been silent for longer than its tailSamples(), the stage
+// sleeps (is skipped) until sound comes back: a reverb costs nothing while nothing plays.
+// Each stage keeps a smoothed cycles-per-sample figure (getCyclesPerSample).
+
+#define FX_SYNC_TICKS 50 // Longest wait for the audio task to pick up an edit
+
+// Shared by the stages and the bus mixer: a 0..255 level -> Q8 gain, 255 == unity
+static FORCE_INLINE int32_t fxGainQ8(uint8_t level) {
+    return level + (level >> 7);
+}
+
+// One-pole low-pass coefficient (y += (x - y) * a >> 15) for a cutoff in centi-Hz, 1..32767
+static int32_t fxOnePoleQ15(uint32_t cutoffCentiHz, uint32_t sampleRate) {
+    const float   w = 2.0f * (float)PI * (cutoffCentiHz * 0.01f) / sampleRate;
+    const int32_t a = (w >= (float)PI) ? 32767 : (int32_t)((1.0f - expf(-w)) * 32768.0f);
+    return (a > 32767) ? 32767 : (a < 1) ? 1 : a;
+}
+
+static FORCE_INLINE bool fxSilent(const int32_t* mix, int n) {
+    int32_t acc = 0;
+    for (int i = 0; i < n; i++) acc |= mix[i];
+    return acc == 0;
+}
+
+// mix = dry + (wet - dry) * w, with w ramping 0 -> 1 (fadeIn) or 1 -> 0 across the slice
+static void fxCrossfade(int32_t* mix, const int32_t* dry, int frames, bool fadeIn) {
+    for (int i = 0; i < frames; i++) {
+        int32_t w = ((i + 1) << 15) / frames;
+        if (!fadeIn) w = 32768 - w;
+        for (int c = 0; c < SYNTH_MIX_CHANNELS; c++) {
+            const int j = i * SYNTH_MIX_CHANNELS + c;
+            mix[j] = dry[j] + (int32_t)((((int64_t)mix[j] - dry[j]) * w) >> 15);
+        }
+    }
+}
+
+bool ESP32Synth::allocFxScratch() {
+    if (_fxScratch) return true;
+    _fxScratch = (int32_t*)heap_caps_aligned_alloc(16, 2 * SYNTH_FX_BLOCK * SYNTH_MIX_CHANNELS * sizeof(int32_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    return _fxScratch != nullptr;
+}
+
+// Waits until the audio task has moved '*v' to 'want' (its copy of a chain, a stage's
+// fade). From the audio task itself, or while nothing renders, there is nothing to wait
+// for. false when a render loop that has stopped (pull mode) did not get there within
+// FX_SYNC_TICKS: the edit has to be called off, the audio task may still be on the old state.
+bool ESP32Synth::fxWaitFor(const volatile uint8_t* v, uint8_t want) {
+    if (*v == want) return true;
+    TaskHandle_t renderer = renderTask();
+    if (!_running || !renderer || renderer == xTaskGetCurrentTaskHandle()) return true;
+    for (int t = 0; t < FX_SYNC_TICKS; t++) {
+        vTaskDelay(1);
+        if (*v == want) return true;
+    }
+    return false;
+}
+
+// Returns once the audio task reads the published copy, so the other one is free to edit.
+bool ESP32Synth::fxChainSync(FxChain& ch) {
+    return fxWaitFor(&ch.inUse, ch.live);
+}
+
+// A chain edit that times out (fxWaitFor) returns false and leaves the stage list and the
+// effects as they were.
+bool ESP32Synth::fxChainAdd(FxChain& ch, SynthEffect* fx, int position) {
+    if (!fx || !allocFxScratch() || !fxChainSync(ch)) return false;
+    const uint8_t cur = ch.live, next = cur ^ 1;
+    const int     n   = ch.count[cur];
+    if (n >= SYNTH_MAX_EFFECTS) return false;
+    for (int i = 0; i < n; i++) if (ch.stages[cur][i] == fx) return false;
+    if (position < 0 || position > n) position = n;
+
+    fx->reset();
+    fx->scratch     = _fxScratch + SYNTH_FX_BLOCK * SYNTH_MIX_CHANNELS;
+    fx->_fxState    = SynthEffect::FX_OFF;
+    fx->_fxIdle     = 0;
+    fx->_fxSleeping = false;
+    fx->_fxCyclesQ8 = 0;
+    fx->_fxEnabled  = true; // Fades in over its first slice
+
+    int j = 0;
+    for (int i = 0; i < n; i++) {
+        if (i == position) ch.stages[next][j++] = fx;
+        ch.stages[next][j++] = ch.stages[cur][i];
+    }
+    if (position == n) ch.stages[next][j++] = fx;
+    ch.count[next] = (uint8_t)j;
+    __atomic_store_n(&ch.live, next, __ATOMIC_RELEASE);
+    return true;
+}
+
+bool ESP32Synth::fxChainRemove(FxChain& ch, SynthEffect* fx) {
+    if (!fxChainSync(ch)) return false;
+    const uint8_t cur = ch.live, next = cur ^ 1;
+    const int     n   = ch.count[cur];
+    int idx = -1;
+    for (int i = 0; i < n; i++) if (ch.stages[cur][i] == fx) idx = i;
+    if (idx < 0) return false;
+
+    // Let the audio task fade it out, then unlink it and wait until no block uses it.
+    const bool enabled = fx->_fxEnabled;
+    fx->_fxEnabled = false;
+    if (!fxWaitFor(&fx->_fxState, SynthEffect::FX_OFF)) { fx->_fxEnabled = enabled; return false; }
+    int j = 0;
+    for (int i = 0; i < n; i++) if (i != idx) ch.stages[next][j++] = ch.stages[cur][i];
+    ch.count[next] = (uint8_t)j;
+    __atomic_store_n(&ch.live, next, __ATOMIC_RELEASE);
+    if (!fxChainSync(ch)) {
+        __atomic_store_n(&ch.live, cur, __ATOMIC_RELEASE);
+        fx->_fxEnabled = enabled;
+        return false;
+    }
+
+    fx->_fxState    = SynthEffect::FX_OFF;
+    fx->_fxSleeping = false;
+    return true;
+}
+
+bool ESP32Synth::fxChainClear(FxChain& ch) {
+    if (!fxChainSync(ch)) return false;
+    const uint8_t cur = ch.live;
+    const int     n   = ch.count[cur];
+    SynthEffect* const* stages = ch.stages[cur];
+    bool enabled[SYNTH_MAX_EFFECTS];
+    for (int i = 0; i < n; i++) { enabled[i] = stages[i]->_fxEnabled; stages[i]->_fxEnabled = false; }
+    bool synced = true;
+    for (int i = 0; i < n && synced; i++) synced = fxWaitFor(&stages[i]->_fxState, SynthEffect::FX_OFF);
+    if (synced) {
+        ch.count[cur ^ 1] = 0;
+        __atomic_store_n(&ch.live, cur ^ 1, __ATOMIC_RELEASE);
+        if (!(synced = fxChainSync(ch))) __atomic_store_n(&ch.live, cur, __ATOMIC_RELEASE);
+    }
+    if (!synced) {
+        for (int i = 0; i < n; i++) stages[i]->_fxEnabled = enabled[i];
+        return false;
+    }
+    for (int i = 0; i < n; i++) {
+        stages[i]->_fxState    = SynthEffect::FX_OFF;
+        stages[i]->_fxSleeping = false;
+    }
+    return true;
+}
+
+// Audio task: runs the published stage list over 'frames' frames of 'mix'.
+void IRAM_ATTR ESP32Synth::runFxChain(FxChain& ch, int32_t* mix, int frames) {
+    const uint8_t copy = __atomic_load_n(&ch.live, __ATOMIC_ACQUIRE);
+    __atomic_store_n(&ch.inUse, copy, __ATOMIC_RELEASE);
+    const int n = ch.count[copy];
+    if (n == 0) return;
+    SynthEffect* const* stages = ch.stages[copy];
+    int32_t* dry = _fxScratch;
+
+    for (int pos = 0; pos < frames; pos += SYNTH_FX_BLOCK) {
+        const int len   = (frames - pos < SYNTH_FX_BLOCK) ? frames - pos : SYNTH_FX_BLOCK;
+        const int words = len * SYNTH_MIX_CHANNELS;
+        int32_t*  buf   = mix + pos * SYNTH_MIX_CHANNELS;
+        bool      silent = fxSilent(buf, words);
+
+        for (int s = 0; s < n; s++) {
+            SynthEffect* fx   = stages[s];
+            uint8_t     state = fx->_fxState;
+            const bool  want  = fx->_fxEnabled;
+            if (state == SynthEffect::FX_OFF) {
+                if (!want) { fx->_fxCyclesQ8 -= fx->_fxCyclesQ8 >> 4; continue; }
+                state = SynthEffect::FX_FADE_IN;
+            } else if (state == SynthEffect::FX_ON && !want) {
+                state = SynthEffect::FX_FADE_OUT;
+            }
+
+            if (state == SynthEffect::FX_ON) {
+                const uint32_t tail = fx->tailSamples();
+                if (!silent) {
+                    fx->_fxIdle = 0;
+                } else if (tail != SYNTH_FX_TAIL_FOREVER) {
+                    if (fx->_fxIdle >= tail) {
+                        fx->_fxSleeping = true;
+                        fx->_fxCyclesQ8 -= fx->_fxCyclesQ8 >> 4; // Skipped: the figure decays
+                        continue;
+                    }
+                    fx->_fxIdle += (uint32_t)len;
+                }
+            }
+            fx->_fxSleeping = false;
+
+            uint32_t t0 = esp_cpu_get_cycle_count();
+            if (state == SynthEffect::FX_ON) {
+                fx->process(buf, len);
+            } else {
+                memcpy(dry, buf, words * sizeof(int32_t));
+                fx->process(buf, len);
+                fxCrossfade(buf, dry, len, state == SynthEffect::FX_FADE_IN);
+                state = (state == SynthEffect::FX_FADE_IN) ? SynthEffect::FX_ON : SynthEffect::FX_OFF;
+            }
+            uint32_t perQ8  = (uint32_t)(((uint64_t)(esp_cpu_get_cycle_count() - t0) << 8) / (uint32_t)len);
+            fx->_fxCyclesQ8 = (uint32_t)((int32_t)fx->_fxCyclesQ8 + (((int32_t)perQ8 - (int32_t)fx->_fxCyclesQ8) >> 4));
+            fx->_fxState    = state;
+            silent = false;
+        }
+    }
+}
+
+// Audio task, for a chain it is about to skip (an idle mix bus): the longest tail in the
+// published stage list, 0 when it is empty. A stage waiting to fade in or out counts as
+// endless, so the chain runs until the edit is done. Reading the list acknowledges it like
+// runFxChain() does, so edits to a skipped chain do not wait for it.
+uint32_t IRAM_ATTR ESP32Synth::fxChainTail(FxChain& ch) {
+    const uint8_t copy = __atomic_load_n(&ch.live, __ATOMIC_ACQUIRE);
+    __atomic_store_n(&ch.inUse, copy, __ATOMIC_RELEASE);
+    uint32_t tail = 0;
+    for (int s = 0; s < ch.count[copy]; s++) {
+        SynthEffect* fx = ch.stages[copy][s];
+        if ((fx->_fxState == SynthEffect::FX_OFF) == fx->_fxEnabled) return SYNTH_FX_TAIL_FOREVER;
+        const uint32_t t = fx->tailSamples();
+        if (t > tail) tail = t;
+    }
+    return tail;
+}
+
+bool ESP32Synth::addEffect(SynthEffect* fx, int8_t position) {
+    return fxChainAdd(_fxChain, fx, position);
+}
+
+bool ESP32Synth::removeEffect(SynthEffect* fx) {
+    return fx && fxChainRemove(_fxChain, fx);
+}
+
+bool ESP32Synth::clearEffects() {
+    return fxChainClear(_fxChain);
+}
+
+// A stage switched back on starts from a cleared state, so no stale tail comes back. A
+// fade-out still running owns that state: if it does not finish in time, nothing changes.
+bool ESP32Synth::setEffectBypass(SynthEffect* fx, bool bypass) {
+    if (!fx) return false;
+    if (bypass) { fx->_fxEnabled = false; return true; }
+    if (fx->_fxEnabled) return true;
+    if (!fxWaitFor(&fx->_fxState, SynthEffect::FX_OFF)) return false;
+    fx->reset();
+    fx->_fxIdle    = 0;
+    fx->_fxEnabled = true;
+    return true;
+}
+
+uint8_t ESP32Synth::getEffectCount() {
+    return _fxChain.count[_fxChain.live];
+}
@@ -0,0 +1,206 @@
+#pragma once
+#include "ESP32Synth.h"
+
+// ====================================================================================
+//    PER-VOICE FILTER
+// ====================================================================================
+// setFilter() runs a voice through its own trapezoidal state-variable filter (the
+// "Cytomic" SVF: zero-delay feedback, stays stable and in tune up to ~0.48 fs at any
+// resonance). Everything that needs a division or a tan() happens once per block in
+// render()'s first pass (updateFilterBlock): the filter envelope advances, the cutoff is
+// summed in cents (base + key tracking + envelope), looked up in svfTanLUT and turned
+// into the three Q30 coefficients. They are ramped linearly to that target across the
+// block, so sweeps stay smooth without any per-sample math beyond the filter itself.
+//
+// Per sample, with g = tan(pi fc / fs) and k = 1 / Q:
+//   m1 = 1 / (1 + g (g + k))   m2 = g m1   m3 = g m2
+//   v3 = v0 - ic2
+//   v1 = m1 ic1 + m2 v3        v2 = ic2 + m2 ic1 + m3 v3
+//   ic1 = 2 v1 - ic1           ic2 = 2 v2 - ic2
+//   LP = v2, BP = v1, HP = v0 - k v1 - v2
+//
+// The voice kernel renders into a short scratch buffer (see renderBuckets), the filter
+// runs over it in place and the result is added to the mix. The recursion is serial per
+// voice; on the S3 the scratch is added to the mix four words at a time.
+
+#define SVF_CHUNK 32 // Samples per scratch pass (stack: SVF_CHUNK * SYNTH_MIX_CHANNELS int32)
+
+#if SYNTH_ENABLE_FILTER
+
+#define SVF_PITCH_C4 26163                                   // Key tracking reference, centiHz
+#define SVF_K_MAX    (2 << 24)                               // Resonance 0: k = 2 (Q = 0.5)
+#define SVF_K_STEP   ((int32_t)(1.96 * (1 << 24) / 255 + 0.5)) // Resonance 255: k = 0.04 (Q = 25)
+
+#define VOICE_FILTERED(vo) ((vo)->svfType != FILTER_OFF)
+
+// Pitch of a phase increment, in cents relative to the sample rate (1200 * log2(inc / 2^32)).
+// log2(1 + x) ~ x + 0.346 x (1 - x) on the mantissa: within 2 cents.
+static inline int32_t svfPitchOfInc(uint32_t inc) {
+    if (inc == 0) return SVF_PITCH_MIN;
+    int      n = 31 - __builtin_clz(inc);
+    uint32_t x = ((n >= 16) ? (inc >> (n - 16)) : (inc << (16 - n))) & 0xFFFF;
+    uint32_t f = x + ((22675 * ((x * (65536 - x)) >> 16)) >> 16);
+    return (n - 32) * 1200 + (int32_t)((f * 1200) >> 16);
+}
+
+// tan(pi fc / fs) in Q24 for a pitch from svfPitchOfInc
+static FORCE_INLINE uint32_t svfTan(int32_t pitch) {
+    if (pitch < SVF_PITCH_MIN) pitch = SVF_PITCH_MIN;
+    if (pitch >= SVF_PITCH_MAX) return svfTanLUT[SVF_TAN_LUT_SIZE - 1];
+    uint32_t off  = (uint32_t)(pitch - SVF_PITCH_MIN);
+    uint32_t idx  = off >> SVF_PITCH_STEP_BITS;
+    uint32_t frac = off & ((1 << SVF_PITCH_STEP_BITS) - 1);
+    uint32_t gLo   = svfTanLUT[idx];
+    return gLo + (uint32_t)(((uint64_t)(svfTanLUT[idx + 1] - gLo) * frac) >> SVF_PITCH_STEP_BITS);
+}
+
+// Filter envelope: a plain linear ADSR, one step per block.
+static FORCE_INLINE void updateFilterEnvBlock(Voice* vo, int samples) {
+    switch (vo->fenvState) {
+        case ENV_ATTACK: {
+            uint64_t step = (uint64_t)vo->fenvRateA * samples;
+            if (vo->fenvVal + step >= ENV_MAX) { vo->fenvVal = ENV_MAX; vo->fenvState = ENV_DECAY; }
+            else vo->fenvVal += (uint32_t)step;
+            break;
+        }
+        case ENV_DECAY: {
+            uint64_t step = (uint64_t)vo->fenvRateD * samples;
+            if (vo->fenvVal <= vo->fenvSustain + step) { vo->fenvVal = vo->fenvSustain; vo->fenvState = ENV_SUSTAIN; }
+            else vo->fenvVal -= (uint32_t)step;
+            break;
+        }
+        case ENV_RELEASE: {
+            uint64_t step = (uint64_t)vo->fenvRateR * samples;
+            if (vo->fenvVal <= step) { vo->fenvVal = 0; vo->fenvState = ENV_IDLE; }
+            else vo->fenvVal -= (uint32_t)step;
+            break;
+        }
+        default: break;
+    }
+}
+
+// Block-rate part: filter envelope, cutoff and the coefficient ramp for the next 'samples'.
+static FORCE_INLINE IRAM_ATTR void updateFilterBlock(Voice* vo, int samples) {
+    updateFilterEnvBlock(vo, samples);
+
+    int32_t pitch = vo->svfCutPitch + (int32_t)(((int64_t)vo->fenvAmount * vo->fenvVal) >> 28);
+    if (vo->svfKeyTrack) pitch += (int32_t)(((int64_t)svfPitchOfInc(vo->phaseInc) * vo->svfKeyTrack * 257) >> 16);
+
+    int64_t g  = svfTan(pitch);
+    int64_t m1 = (int64_t)((1ULL << 54) / (uint64_t)((1LL << 24) + ((g * (g + vo->svfK)) >> 24)));
+    int64_t m2 = (m1 * g) >> 24;
+    int64_t m3 = (m2 * g) >> 24;
+    const int32_t target[3] = {(int32_t)m1, (int32_t)m2, (int32_t)m3};
+
+    for (int j = 0; j < 3; j++) {
+        if (vo->svfInit) { vo->svfA[j] = target[j]; vo->svfDA[j] = 0; }
+        else vo->svfDA[j] = (target[j] - vo->svfA[j]) / samples;
+    }
+    vo->svfInit = false;
+}
+
+// One channel of one scratch pass, in place. 'stride' steps over the other channel of a stereo mix.
+template <uint8_t T>
+static FORCE_INLINE void svfRun(int32_t* buf, int n, int stride, int32_t& ic1Ref, int32_t& ic2Ref, const Voice* vo) {
+    int32_t ic1 = ic1Ref, ic2 = ic2Ref;
+    int32_t m1 = vo->svfA[0], m2 = vo->svfA[1], m3 = vo->svfA[2];
+    const int32_t dm1 = vo->svfDA[0], dm2 = vo->svfDA[1], dm3 = vo->svfDA[2];
+    const int32_t k  = vo->svfK;
+    for (int i = 0; i < n * stride; i += stride) {
+        int32_t v0 = buf[i];
+        int32_t v3 = v0 - ic2;
+        int32_t v1 = (int32_t)(((int64_t)m1 * ic1 + (int64_t)m2 * v3) >> 30);
+        int32_t v2 = ic2 + (int32_t)(((int64_t)m2 * ic1 + (int64_t)m3 * v3) >> 30);
+        ic1 = 2 * v1 - ic1;
+        ic2 = 2 * v2 - ic2;
+        switch (T) {
+            case FILTER_LP: buf[i] = v2; break;
+            case FILTER_BP: buf[i] = v1; break;
+            default:        buf[i] = v0 - (int32_t)(((int64_t)k * v1) >> 24) - v2; break;
+        }
+        m1 += dm1; m2 += dm2; m3 += dm3;
+    }
+    ic1Ref = ic1;
+    ic2Ref = ic2;
+}
+
+// Filters 'n' frames of the voice's scratch buffer and adds them to 'mix'.
+static FORCE_INLINE IRAM_ATTR void svfRenderChunk(Voice* __restrict__ vo, int32_t* __restrict__ buf, int32_t* __restrict__ mix, int n) {
+    for (int ch = 0; ch < SYNTH_MIX_CHANNELS; ch++) {
+        switch (vo->svfType) {
+            case FILTER_LP: svfRun<FILTER_LP>(buf + ch, n, SYNTH_MIX_CHANNELS, vo->svfIc1[ch], vo->svfIc2[ch], vo); break;
+            case FILTER_BP: svfRun<FILTER_BP>(buf + ch, n, SYNTH_MIX_CHANNELS, vo->svfIc1[ch], vo->svfIc2[ch], vo); break;
+            default:        svfRun<FILTER_HP>(buf + ch, n, SYNTH_MIX_CHANNELS, vo->svfIc1[ch], vo->svfIc2[ch], vo); break;
+        }
+    }
+    for (int j = 0; j < 3; j++) vo->svfA[j] += vo->svfDA[j] * n;
+
+    const int words = n * SYNTH_MIX_CHANNELS;
+    int i = 0;
+#if defined(CONFIG_IDF_TARGET_ESP32S3)
+    for (; i + 4 <= words; i += 4) *(v4i32*)&mix[i] += *(const v4i32*)&buf[i];
+#endif
+    for (; i < words; i++) mix[i] += buf[i];
+}
+
+// Cutoff as a pitch relative to the sample rate, with the key tracking reference taken out
+// so that updateFilterBlock() only has to add the note's own pitch.
+void ESP32Synth::updateFilterPitch(Voice* vo) {
+    uint64_t fs100  = (uint64_t)_sampleRate * 100;
+    uint64_t cutoff = (vo->svfCutoff < fs100 / 2) ? vo->svfCutoff : fs100 / 2;
+    int32_t  base   = svfPitchOfInc((uint32_t)((cutoff << 32) / fs100));
+    int32_t  ref    = svfPitchOfInc((uint32_t)(((uint64_t)SVF_PITCH_C4 << 32) / fs100));
+    vo->svfCutPitch = base - (int32_t)(((int64_t)ref * vo->svfKeyTrack * 257) >> 16);
+}
+
+#else
+
+#define VOICE_FILTERED(vo) false
+static FORCE_INLINE void svfRenderChunk(Voice*, int32_t*, int32_t*, int) {}
+
+#endif // SYNTH_ENABLE_FILTER
+
+void ESP32Synth::setFilter(uint16_t voice, FilterType type, uint32_t cutoffCentiHz, uint8_t resonance) {
+    if (queueCommand(CMD_SET_FILTER, voice, type | ((uint32_t)resonance << 8), cutoffCentiHz)) return;
+    if (voice >= MAX_VOICES) return;
+#if SYNTH_ENABLE_FILTER
+    Voice* vo = &voices[voice];
+    if (type > FILTER_HP) type = FILTER_OFF;
+    if (vo->svfType == FILTER_OFF) { // Start from rest, at the target coefficients
+        memset(vo->svfIc1, 0, sizeof(vo->svfIc1));
+        memset(vo->svfIc2, 0, sizeof(vo->svfIc2));
+        vo->svfInit = true;
+    }
+    vo->svfType   = type;
+    vo->svfK      = SVF_K_MAX - SVF_K_STEP * resonance;
+    vo->svfCutoff = cutoffCentiHz;
+    updateFilterPitch(vo);
+#endif
+}
+
+// Linear ADSR that moves the cutoff by up to 'amountCents' (negative: downwards). Same
+// a / d / r in ms and s in 0..255 as setEnv(); it restarts with every noteOn().
+void ESP32Synth::setFilterEnv(uint16_t voice, uint16_t a, uint16_t d, uint8_t s, uint16_t r, int16_t amountCents) {
+    if (queueCommand(CMD_SET_FILTER_ENV, voice, a | ((uint32_t)d << 16), s | ((uint32_t)(uint16_t)amountCents << 16), r)) return;
+    if (voice >= MAX_VOICES) return;
+#if SYNTH_ENABLE_FILTER
+    Voice* vo = &voices[voice];
+    vo->fenvSustain = (uint32_t)s * (ENV_MAX / 255);
+    vo->fenvAmount  = amountCents;
+
+    uint32_t spm = (_sampleRate >= 1000) ? (_sampleRate / 1000) : 1;
+
+    vo->fenvRateA = (a == 0) ? ENV_MAX : ENV_MAX / ((uint32_t)a * spm);
+    vo->fenvRateD = (d == 0) ? ENV_MAX : (ENV_MAX - vo->fenvSustain) / ((uint32_t)d * spm);
+    vo->fenvRateR = (r == 0) ? ENV_MAX : ENV_MAX / ((uint32_t)r * spm);
+#endif
+}
+
+void ESP32Synth::setFilterKeyTrack(uint16_t voice, uint8_t amount) {
+    if (queueCommand(CMD_SET_FILTER_KEYTRACK, voice, amount)) return;
+    if (voice >= MAX_VOICES) return;
+#if SYNTH_ENABLE_FILTER
+    voices[voice].svfKeyTrack = amount;
+    updateFilterPitch(&voices[voice]);
+#endif
+}
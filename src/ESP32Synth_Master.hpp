@@ -0,0 +1,131 @@
+#pragma once
+#include "ESP32Synth.h"
+
+// ====================================================================================
+//    MASTER STAGE
+// ====================================================================================
+// One pass from the int32 mix to the exact layout the output consumes (see MasterFormat):
+// master volume, saturation, bitcrush and format packing happen per frame while the value
+// is still in a register, so no mono int16 block is written out and read back again.
+//
+// The volume multiply stays in 32 bits: with mix = hi * 65536 + lo (lo unsigned),
+// (mix * vol) >> 16 == hi * vol + ((lo * vol) >> 16) exactly, and neither term overflows
+// for vol <= 65535. On Xtensa the 16-bit saturation is a single CLAMPS.
+
+#ifndef FORCE_INLINE
+#define FORCE_INLINE __attribute__((always_inline)) inline
+#endif
+
+static FORCE_INLINE int32_t masterClamp16(int32_t v) {
+#if defined(__XTENSA__)
+    int32_t r;
+    asm("clamps %0, %1, 15" : "=a"(r) : "a"(v));
+    return r;
+#else
+    return (v > 32767) ? 32767 : (v < -32768) ? -32768 : v;
+#endif
+}
+
+// sat16((mix * vol) >> 16) & mask
+static FORCE_INLINE int16_t masterScale16(int32_t mix, int32_t vol, uint32_t mask) {
+    int32_t val = (mix >> 16) * vol + (int32_t)(((uint32_t)mix & 0xFFFF) * (uint32_t)vol >> 16);
+    return (int16_t)(masterClamp16(val) & mask);
+}
+
+// sat32(mix * vol) & mask
+static FORCE_INLINE int32_t masterScale32(int32_t mix, int32_t vol, uint32_t mask) {
+    int32_t val;
+    if (__builtin_mul_overflow(mix, vol, &val)) val = (mix < 0) ? INT32_MIN : INT32_MAX;
+    return (int32_t)((uint32_t)val & mask);
+}
+
+// Mono source for frame i: the mix word, or the (L + R) / 2 downmix of a stereo mix.
+static FORCE_INLINE int32_t masterMono(const int32_t* mix, int i) {
+#if SYNTH_ENABLE_STEREO
+    return (mix[i * 2] >> 1) + (mix[i * 2 + 1] >> 1);
+#else
+    return mix[i];
+#endif
+}
+
+// One loop per layout, each frame goes from the mix word(s) to its final output word(s).
+// 'out' may be 'mix' itself: frame i only writes bytes up to the end of its own mix frame,
+// which has been read by then. With a mono mix the 8-byte I2S 32-bit frames outgrow that
+// and run back to front.
+template <MasterFormat F>
+static FORCE_INLINE void masterPack(const int32_t* mix, void* out, int samples, int32_t vol, uint32_t mask) {
+    switch (F) {
+        case MASTER_STEREO32: {
+            int32_t* o = (int32_t*)out;
+#if SYNTH_ENABLE_STEREO
+            for (int i = 0; i < samples * 2; i++) o[i] = masterScale32(mix[i], vol, mask);
+#else
+            for (int i = samples - 1; i >= 0; i--) {
+                int32_t s = masterScale32(mix[i], vol, mask);
+                o[i * 2] = o[i * 2 + 1] = s;
+            }
+#endif
+            break;
+        }
+        case MASTER_STEREO16: {
+            uint32_t* o = (uint32_t*)out;
+#if SYNTH_ENABLE_STEREO
+            for (int i = 0; i < samples; i++) {
+                uint32_t l = (uint16_t)masterScale16(mix[i * 2], vol, mask);
+                uint32_t r = (uint16_t)masterScale16(mix[i * 2 + 1], vol, mask);
+                o[i] = (r << 16) | l; // Left in the first int16
+            }
+#else
+            for (int i = 0; i < samples; i++) {
+                uint32_t s = (uint16_t)masterScale16(mix[i], vol, mask);
+                o[i] = (s << 16) | s;
+            }
+#endif
+            break;
+        }
+        case MASTER_DAC8: {
+            uint16_t* o = (uint16_t*)out;
+            for (int i = 0; i < samples; i++) {
+                uint32_t code = (uint16_t)(masterScale16(masterMono(mix, i), vol, mask) ^ 0x8000) >> 8; // offset binary
+                o[i] = (uint16_t)((code << 8) | code);
+            }
+            break;
+        }
+        case MASTER_PWM10: {
+            uint16_t* o = (uint16_t*)out;
+            for (int i = 0; i < samples; i++) o[i] = (uint16_t)(((uint32_t)(uint16_t)(masterScale16(masterMono(mix, i), vol, mask) ^ 0x8000) >> 6) << 4);
+            break;
+        }
+        default: {
+            int16_t* o = (int16_t*)out;
+            for (int i = 0; i < samples; i++) o[i] = masterScale16(masterMono(mix, i), vol, mask);
+            break;
+        }
+    }
+}
+
+// Bytes per packed output frame
+static FORCE_INLINE size_t masterFrameBytes(MasterFormat fmt) {
+    switch (fmt) {
+        case MASTER_STEREO32: return 2 * sizeof(int32_t);
+        case MASTER_STEREO16: return 2 * sizeof(int16_t);
+        default:              return sizeof(int16_t);
+    }
+}
+
+static FORCE_INLINE void masterBlock(const int32_t* mix, void* out, int samples, int32_t vol, uint8_t bitcrush, MasterFormat fmt) {
+    uint32_t mask32 = 0xFFFFFFFFUL;
+    uint32_t mask16 = 0xFFFFFFFFUL;
+    if (bitcrush > 0) {
+        mask32 = (bitcrush >= 32) ? 0 : (0xFFFFFFFFUL << (32 - bitcrush));
+        mask16 = (bitcrush >= 16) ? 0 : (0xFFFFFFFFUL << (16 - bitcrush));
+    }
+
+    switch (fmt) {
+        case MASTER_STEREO16: masterPack<MASTER_STEREO16>(mix, out, samples, vol, mask16); break;
+        case MASTER_STEREO32: masterPack<MASTER_STEREO32>(mix, out, samples, vol, mask32); break;
+        case MASTER_DAC8:     masterPack<MASTER_DAC8>(mix, out, samples, vol, mask16);     break;
+        case MASTER_PWM10:    masterPack<MASTER_PWM10>(mix, out, samples, vol, mask16);    break;
+        default:              masterPack<MASTER_MONO16>(mix, out, samples, vol, mask16);   break;
+    }
+}
@@ -0,0 +1,128 @@
+#pragma once
+#include "ESP32Synth.h"
+
+// ====================================================================================
+//    RENDER PROFILER
+// ====================================================================================
+// Every hook below collapses to nothing when SYNTH_ENABLE_PROFILER is 0, so the hot
+// path is byte-for-byte the same as an unprofiled build.
+
+#if SYNTH_ENABLE_PROFILER
+    #define SYNTH_PROF_MARK(t)            uint32_t t = esp_cpu_get_cycle_count()
+    #define SYNTH_PROF_STAGE(stage, t)    _profBlock[stage] += esp_cpu_get_cycle_count() - (t)
+    #define SYNTH_PROF_KERNEL(acc, kernel, t) profAdd((acc)[kernel], esp_cpu_get_cycle_count() - (t))
+    #define SYNTH_PROF_END_BLOCK(samples) profEndBlock(samples)
+#else
+    #define SYNTH_PROF_MARK(t)
+    #define SYNTH_PROF_STAGE(stage, t)
+    #define SYNTH_PROF_KERNEL(acc, kernel, t)
+    #define SYNTH_PROF_END_BLOCK(samples)
+#endif
+
+#if SYNTH_ENABLE_PROFILER
+void ESP32Synth::profResetWindow() {
+    for (int s = 0; s < PROF_NUM_STAGES; s++) {
+        _profStageAcc[s] = { 0, 0, 0xFFFFFFFFUL, 0 };
+        _profBlock[s]    = 0;
+    }
+    for (int k = 0; k < PROF_NUM_KERNELS; k++) {
+        _profKernelAcc[k]       = { 0, 0, 0xFFFFFFFFUL, 0 };
+        _profKernelAccWorker[k] = { 0, 0, 0xFFFFFFFFUL, 0 };
+    }
+    _profBlocks = 0;
+}
+
+// Folds the dual-core worker's kernel timings into the window. Called once the worker has
+// finished its share of the block, so nothing else is touching _profKernelAccWorker.
+void IRAM_ATTR ESP32Synth::profMergeWorker() {
+    for (int k = 0; k < PROF_NUM_KERNELS; k++) {
+        ProfAccum& w = _profKernelAccWorker[k];
+        if (w.count == 0) continue;
+        ProfAccum& a = _profKernelAcc[k];
+        a.sum   += w.sum;
+        a.count += w.count;
+        if (w.min < a.min) a.min = w.min;
+        if (w.max > a.max) a.max = w.max;
+        w = { 0, 0, 0xFFFFFFFFUL, 0 };
+    }
+}
+
+// Closes one block: folds the per-stage deltas into the window and publishes it when full.
+void IRAM_ATTR ESP32Synth::profEndBlock(int samples) {
+    if (_profResetPending) {
+        _profResetPending = false;
+        profResetWindow();
+        return;
+    }
+
+    uint32_t total = 0;
+    for (int s = 0; s < PROF_TOTAL; s++) total += _profBlock[s];
+    _profBlock[PROF_TOTAL] = total;
+
+    for (int s = 0; s < PROF_NUM_STAGES; s++) {
+        profAdd(_profStageAcc[s], _profBlock[s]);
+        _profBlock[s] = 0;
+    }
+
+    if (++_profBlocks < SYNTH_PROFILER_WINDOW) return;
+
+    uint32_t blocks = _profBlocks;
+    uint32_t budget = (uint32_t)(((uint64_t)SYNTH_GET_CPU_FREQ_MHZ() * 1000000ULL * (uint32_t)samples) / _sampleRate);
+    if (budget == 0) budget = 1;
+
+    // Seqlock publish: readers retry while _profSeq is odd or changed under them.
+    _profSeq = _profSeq + 1;
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    _profile.enabled         = true;
+    _profile.windowId        = ++_profWindowId;
+    _profile.blocks          = blocks;
+    _profile.samplesPerBlock = (uint32_t)samples;
+    _profile.budgetCycles    = budget;
+
+    for (int s = 0; s < PROF_NUM_STAGES; s++) {
+        const ProfAccum& a         = _profStageAcc[s];
+        _profile.stage[s].minCycles = a.min;
+        _profile.stage[s].avgCycles = (uint32_t)(a.sum / blocks);
+        _profile.stage[s].maxCycles = a.max;
+    }
+    for (int k = 0; k < PROF_NUM_KERNELS; k++) {
+        const ProfAccum& a     = _profKernelAcc[k];
+        SynthKernelStat& out   = _profile.kernel[k];
+        out.voiceRenders       = a.count;
+        out.avgVoices          = a.count / blocks;
+        out.avgCyclesPerBlock  = (uint32_t)(a.sum / blocks);
+        out.perVoice.minCycles = a.count ? a.min : 0;
+        out.perVoice.avgCycles = a.count ? (uint32_t)(a.sum / a.count) : 0;
+        out.perVoice.maxCycles = a.max;
+    }
+    _profile.avgLoad  = ((float)_profile.stage[PROF_TOTAL].avgCycles / (float)budget) * 100.0f;
+    _profile.peakLoad = ((float)_profile.stage[PROF_TOTAL].maxCycles / (float)budget) * 100.0f;
+
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    _profSeq = _profSeq + 1;
+
+    profResetWindow();
+}
+#endif
+
+SynthRenderProfile ESP32Synth::getRenderProfile() {
+    SynthRenderProfile p = {};
+#if SYNTH_ENABLE_PROFILER
+    uint32_t seq;
+    do {
+        seq = _profSeq;
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        p = _profile;
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    } while ((seq & 1) || seq != _profSeq);
+    p.enabled = true;
+#endif
+    return p;
+}
+
+void ESP32Synth::resetRenderProfile() {
+#if SYNTH_ENABLE_PROFILER
+    _profResetPending = true; // Applied by the audio task at the next block boundary
+#endif
+}
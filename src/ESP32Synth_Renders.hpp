@@ -11,6 +11,88 @@
 #define UNLIKELY(x) __builtin_expect(!!(x), 0)
 #endif
 
+// Every kernel accumulates through MIX_ADD / MIX_ADD4 (one sample / four samples at i, gain
+// 'vol' as in (val * vol) >> 16). Mono builds get the plain accumulate. Stereo builds
+// (SYNTH_ENABLE_STEREO) fold the voice's constant-power pan gains into 'vol' and write the
+// interleaved L/R pair at 2i; MIX_PAN(vo) loads those gains once per block. Stereo sources
+// (SD streams) go through MIX_ADD_LR / MIX_ADD4_LR with MIX_BALANCE(vo) instead: centre
+// leaves both channels at unity and panning only attenuates the opposite side.
+#if SYNTH_ENABLE_STEREO
+#define MIX_PAN(vo) \
+    const uint32_t panL = (uint32_t)sineLUT[SYNTH_PAN_MAX - (vo)->pan]; \
+    const uint32_t panR = (uint32_t)sineLUT[SYNTH_PAN_MAX + (vo)->pan]
+#define MIX_BALANCE(vo) \
+    const uint32_t panL = (uint32_t)sineLUT[2 * (SYNTH_PAN_MAX - (((vo)->pan > 0) ? (vo)->pan : 0))]; \
+    const uint32_t panR = (uint32_t)sineLUT[2 * (SYNTH_PAN_MAX + (((vo)->pan < 0) ? (vo)->pan : 0))]
+#define MIX_ADD_LR(i, l, r, vol) do { \
+    mixBuffer[(i) * 2]     += ((l) * (int32_t)(((uint32_t)(vol) * panL) >> 15)) >> 16; \
+    mixBuffer[(i) * 2 + 1] += ((r) * (int32_t)(((uint32_t)(vol) * panR) >> 15)) >> 16; } while (0)
+#define MIX_ADD4_LR(i, l, r, vol) do { \
+    v4u32 mixG_ = (v4u32)(vol); \
+    v4i32 mixL_ = ((l) * (v4i32)((mixG_ * panL) >> 15)) >> 16; \
+    v4i32 mixR_ = ((r) * (v4i32)((mixG_ * panR) >> 15)) >> 16; \
+    *(v4i32*)&mixBuffer[(i) * 2]     += __builtin_shuffle(mixL_, mixR_, (v4i32){0, 4, 1, 5}); \
+    *(v4i32*)&mixBuffer[(i) * 2 + 4] += __builtin_shuffle(mixL_, mixR_, (v4i32){2, 6, 3, 7}); } while (0)
+#define MIX_ADD(i, val, vol)   do { int32_t mixV_ = (val); MIX_ADD_LR(i, mixV_, mixV_, vol); } while (0)
+#define MIX_ADD4(i, vals, vol) do { v4i32 mixV_ = (vals); MIX_ADD4_LR(i, mixV_, mixV_, vol); } while (0)
+#else
+#define MIX_PAN(vo)
+#define MIX_ADD(i, val, vol)   (mixBuffer[i] += ((val) * (vol)) >> 16)
+#define MIX_ADD4(i, vals, vol) (*(v4i32*)&mixBuffer[i] += ((vals) * (vol)) >> 16)
+#endif
+
+// Enveloped blocks: MIX_RAMP(n) / MIX_RAMP4(n) set up an n-sample ramp from the kernel's
+// currentEnv, envStep and volBase, then MIX_ADD_RAMP / MIX_ADD4_RAMP accumulate one sample /
+// four samples and step it. Mono builds derive the gain from the envelope per sample, exactly
+// as before. Stereo builds pan the gain at both ends of the block (8 extra fraction bits) and
+// step L and R linearly, so a frame costs one multiply-add per channel instead of re-deriving
+// and re-panning the gain.
+#if SYNTH_ENABLE_STEREO
+static FORCE_INLINE int32_t mixRampGain(int32_t env, int32_t volBase, uint32_t pan) {
+    int32_t envSafe  = env >> 14;
+    envSafe         &= ~(envSafe >> 31);
+    return (int32_t)(((int64_t)envSafe * volBase * pan) >> 21);
+}
+#define MIX_RAMP(n) \
+    int32_t       rampL_  = mixRampGain(currentEnv, volBase, panL); \
+    int32_t       rampR_  = mixRampGain(currentEnv, volBase, panR); \
+    const int32_t rampDL_ = (mixRampGain(currentEnv + envStep * (n), volBase, panL) - rampL_) / (n); \
+    const int32_t rampDR_ = (mixRampGain(currentEnv + envStep * (n), volBase, panR) - rampR_) / (n)
+#define MIX_RAMP4(n) \
+    MIX_RAMP(n); \
+    v4i32       rampL4_  = {rampL_, rampL_ + rampDL_, rampL_ + rampDL_ * 2, rampL_ + rampDL_ * 3}; \
+    v4i32       rampR4_  = {rampR_, rampR_ + rampDR_, rampR_ + rampDR_ * 2, rampR_ + rampDR_ * 3}; \
+    const v4i32 rampDL4_ = {rampDL_ * 4, rampDL_ * 4, rampDL_ * 4, rampDL_ * 4}; \
+    const v4i32 rampDR4_ = {rampDR_ * 4, rampDR_ * 4, rampDR_ * 4, rampDR_ * 4}
+#define MIX_ADD_RAMP_LR(i, l, r) do { \
+    mixBuffer[(i) * 2]     += ((l) * (rampL_ >> 8)) >> 16; \
+    mixBuffer[(i) * 2 + 1] += ((r) * (rampR_ >> 8)) >> 16; \
+    rampL_ += rampDL_; rampR_ += rampDR_; } while (0)
+#define MIX_ADD4_RAMP_LR(i, l, r) do { \
+    v4i32 mixL_ = ((l) * (rampL4_ >> 8)) >> 16; \
+    v4i32 mixR_ = ((r) * (rampR4_ >> 8)) >> 16; \
+    *(v4i32*)&mixBuffer[(i) * 2]     += __builtin_shuffle(mixL_, mixR_, (v4i32){0, 4, 1, 5}); \
+    *(v4i32*)&mixBuffer[(i) * 2 + 4] += __builtin_shuffle(mixL_, mixR_, (v4i32){2, 6, 3, 7}); \
+    rampL4_ += rampDL4_; rampR4_ += rampDR4_; } while (0)
+#define MIX_ADD_RAMP(i, val)   do { int32_t mixV_ = (val); MIX_ADD_RAMP_LR(i, mixV_, mixV_); } while (0)
+#define MIX_ADD4_RAMP(i, vals) do { v4i32 mixV_ = (vals); MIX_ADD4_RAMP_LR(i, mixV_, mixV_); } while (0)
+#else
+#define MIX_RAMP(n)  int32_t rampEnv_ = currentEnv
+#define MIX_RAMP4(n) \
+    v4i32       rampEnv4_  = {currentEnv, currentEnv + envStep, currentEnv + envStep * 2, currentEnv + envStep * 3}; \
+    const v4i32 rampStep4_ = {envStep * 4, envStep * 4, envStep * 4, envStep * 4}
+#define MIX_ADD_RAMP(i, val) do { \
+    int32_t rampE_  = rampEnv_ >> 14; \
+    rampE_         &= ~(rampE_ >> 31); \
+    MIX_ADD(i, val, (rampE_ * volBase) >> 14); \
+    rampEnv_ += envStep; } while (0)
+#define MIX_ADD4_RAMP(i, vals) do { \
+    v4i32 rampE_  = rampEnv4_ >> 14; \
+    rampE_       &= ~(rampE_ >> 31); \
+    MIX_ADD4(i, vals, (rampE_ * (int32_t)volBase) >> 14); \
+    rampEnv4_ += rampStep4_; } while (0)
+#endif
+
 // The LoopMode switch is pulled out of the hot path.
 // It is only processed in the microsecond when the sample crosses the exact boundary.
 #define ADVANCE_SAMPLE_POS \
@@ -30,8 +112,66 @@
         } \
     }
 
+// One table / sample frame scaled to int16 range, for any bit depth.
+static FORCE_INLINE int32_t wtEntry(const void* data, uint32_t idx, const BitDepth depth) {
+    switch (depth) {
+        case BITS_16: return ((const int16_t*)data)[idx];
+        case BITS_8:  return ((int32_t)((const uint8_t*)data)[idx] - 128) << 8;
+        default:      return ((int32_t)((((const uint8_t*)data)[idx >> 1] >> ((idx & 1) << 2)) & 0x0F) - 8) * 4096;
+    }
+}
+
+#if defined(CONFIG_IDF_TARGET_ESP32S3)
+// Four frames at once; the 4-bit case gathers the bytes and unpacks both nibbles in-lane.
+static FORCE_INLINE v4i32 wtEntryVec(const void* data, v4u32 vIdx, const BitDepth depth) {
+    switch (depth) {
+        case BITS_16: {
+            const int16_t* d = (const int16_t*)data;
+            return (v4i32){ d[vIdx[0]], d[vIdx[1]], d[vIdx[2]], d[vIdx[3]] };
+        }
+        case BITS_8: {
+            const uint8_t* d = (const uint8_t*)data;
+            v4i32 vals = { d[vIdx[0]], d[vIdx[1]], d[vIdx[2]], d[vIdx[3]] };
+            return (vals - 128) << 8;
+        }
+        default: {
+            const uint8_t* d     = (const uint8_t*)data;
+            v4u32          vByte = vIdx >> 1;
+            v4i32 bytes = { d[vByte[0]], d[vByte[1]], d[vByte[2]], d[vByte[3]] };
+            return (((bytes >> (v4i32)((vIdx & 1) << 2)) & 0x0F) - 8) * 4096;
+        }
+    }
+}
+#endif
+
+// Sample blocks that cross no loop point or end: frame i is simply pos + step * i, so the
+// boundary checks of ADVANCE_SAMPLE_POS drop out and the S3 takes 4 frames per step.
+// 'off' is relative to the frame under pos; the caller keeps step * samples below 2^30.
+static FORCE_INLINE void renderSampleDirect(const Voice* vo, const void* __restrict__ data, uint32_t base, int32_t off, int32_t step, int32_t* __restrict__ mixBuffer, int samples, int32_t currentEnv, int32_t envStep, int32_t volBase, const BitDepth depth) {
+    MIX_PAN(vo);
+#if defined(CONFIG_IDF_TARGET_ESP32S3)
+    v4i32 vOff     = {off, off + step, off + step * 2, off + step * 3};
+    v4i32 vOffStep = {step * 4, step * 4, step * 4, step * 4};
+    MIX_RAMP4(samples);
+    for (int i = 0; i < samples; i += 4) {
+        MIX_ADD4_RAMP(i, wtEntryVec(data, base + (v4u32)(vOff >> 16), depth));
+        vOff += vOffStep;
+    }
+#else
+    MIX_RAMP(samples);
+    #define SAMPLE_DIRECT(j) { \
+        MIX_ADD_RAMP(j, wtEntry(data, base + (off >> 16), depth)); \
+        off += step; }
+    int i = 0;
+    for (; i + 4 <= samples; i += 4) { SAMPLE_DIRECT(i) SAMPLE_DIRECT(i + 1) SAMPLE_DIRECT(i + 2) SAMPLE_DIRECT(i + 3) }
+    for (; i < samples; i++) SAMPLE_DIRECT(i)
+    #undef SAMPLE_DIRECT
+#endif
+}
+
 // Render: PCM Sample
-static FORCE_INLINE IRAM_ATTR void renderBlockSample(Voice* __restrict__ vo, int32_t* __restrict__ mixBuffer, int samples, int32_t startEnv, int32_t envStep) {
+// 'depth' is passed in (see classifyVoiceKernel) so a bucket of same-depth voices folds the switch away.
+static FORCE_INLINE IRAM_ATTR void renderBlockSample(Voice* __restrict__ vo, int32_t* __restrict__ mixBuffer, int samples, int32_t startEnv, int32_t envStep, const BitDepth depth) {
     if (vo->sampleFinished) return;
     const SampleData* sData = &registeredSamples[vo->curSampleId];
     if (!sData->data) return;
@@ -43,18 +183,28 @@ static FORCE_INLINE IRAM_ATTR void renderBlockSample(Voice* __restrict__ vo, int
     const uint32_t lEnd   = (vo->sampleLoopEnd > 0 && vo->sampleLoopEnd <= len) ? vo->sampleLoopEnd : len;
     int32_t        currentEnv = startEnv;
     int32_t        volBase    = ((uint32_t)vo->vol * vo->trmModGain) >> 8;
+    MIX_PAN(vo);
     bool           dir        = vo->sampleDirection;
 
+    uint64_t span = (uint64_t)inc * samples;
+    if (LIKELY(span < 0x40000000ULL && (dir ? ((pos + span) >> 16) < lEnd : (pos >= span && ((pos - span) >> 16) > lStart)))) {
+        // With envStep == 0 the ramp is flat, so one loop serves both cases.
+        renderSampleDirect(vo, sData->data, (uint32_t)(pos >> 16), (int32_t)(pos & 0xFFFF), dir ? (int32_t)inc : -(int32_t)inc,
+                               mixBuffer, samples, currentEnv, envStep, volBase, depth);
+        vo->samplePos1616 = dir ? pos + span : pos - span;
+        return;
+    }
+
     if (envStep == 0) {
         int32_t envSafe  = currentEnv >> 14;
         envSafe         &= ~(envSafe >> 31);
         int32_t finalVol = (int32_t)((envSafe * volBase) >> 14);
 
-        switch (sData->depth) {
+        switch (depth) {
             case BITS_16: {
                 const int16_t* data = (const int16_t*)sData->data;
                 for (int i = 0; i < samples; i++) {
-                    mixBuffer[i] += (data[(uint32_t)(pos >> 16)] * finalVol) >> 16;
+                    MIX_ADD(i, data[(uint32_t)(pos >> 16)], finalVol);
                     ADVANCE_SAMPLE_POS
                 }
                 break;
@@ -62,7 +212,7 @@ static FORCE_INLINE IRAM_ATTR void renderBlockSample(Voice* __restrict__ vo, int
             case BITS_8: {
                 const uint8_t* data = (const uint8_t*)sData->data;
                 for (int i = 0; i < samples; i++) {
-                    mixBuffer[i] += ((((int16_t)data[(uint32_t)(pos >> 16)] - 128) << 8) * finalVol) >> 16;
+                    MIX_ADD(i, (((int16_t)data[(uint32_t)(pos >> 16)] - 128) << 8), finalVol);
                     ADVANCE_SAMPLE_POS
                 }
                 break;
@@ -71,22 +221,19 @@ static FORCE_INLINE IRAM_ATTR void renderBlockSample(Voice* __restrict__ vo, int
                 const uint8_t* data = (const uint8_t*)sData->data;
                 for (int i = 0; i < samples; i++) {
                     uint32_t idx = (uint32_t)(pos >> 16);
-                    mixBuffer[i] += ((((int16_t)((data[idx >> 1] >> ((idx & 1) << 2)) & 0x0F) - 8) * 4096) * finalVol) >> 16;
+                    MIX_ADD(i, (((int16_t)((data[idx >> 1] >> ((idx & 1) << 2)) & 0x0F) - 8) * 4096), finalVol);
                     ADVANCE_SAMPLE_POS
                 }
                 break;
             }
         }
     } else {
-        switch (sData->depth) {
+        MIX_RAMP(samples);
+        switch (depth) {
             case BITS_16: {
                 const int16_t* data = (const int16_t*)sData->data;
                 for (int i = 0; i < samples; i++) {
-                    int32_t envSafe  = currentEnv >> 14;
-                    envSafe         &= ~(envSafe >> 31);
-                    int32_t finalVol = (int32_t)((envSafe * volBase) >> 14);
-                    mixBuffer[i]    += (data[(uint32_t)(pos >> 16)] * finalVol) >> 16;
-                    currentEnv      += envStep;
+                    MIX_ADD_RAMP(i, data[(uint32_t)(pos >> 16)]);
                     ADVANCE_SAMPLE_POS
                 }
                 break;
@@ -94,11 +241,7 @@ static FORCE_INLINE IRAM_ATTR void renderBlockSample(Voice* __restrict__ vo, int
             case BITS_8: {
                 const uint8_t* data = (const uint8_t*)sData->data;
                 for (int i = 0; i < samples; i++) {
-                    int32_t envSafe  = currentEnv >> 14;
-                    envSafe         &= ~(envSafe >> 31);
-                    int32_t finalVol = (int32_t)((envSafe * volBase) >> 14);
-                    mixBuffer[i]    += ((((int16_t)data[(uint32_t)(pos >> 16)] - 128) << 8) * finalVol) >> 16;
-                    currentEnv      += envStep;
+                    MIX_ADD_RAMP(i, (((int16_t)data[(uint32_t)(pos >> 16)] - 128) << 8));
                     ADVANCE_SAMPLE_POS
                 }
                 break;
@@ -106,12 +249,8 @@ static FORCE_INLINE IRAM_ATTR void renderBlockSample(Voice* __restrict__ vo, int
             case BITS_4: {
                 const uint8_t* data = (const uint8_t*)sData->data;
                 for (int i = 0; i < samples; i++) {
-                    int32_t envSafe  = currentEnv >> 14;
-                    envSafe         &= ~(envSafe >> 31);
-                    int32_t finalVol = (int32_t)((envSafe * volBase) >> 14);
-                    uint32_t idx     = (uint32_t)(pos >> 16);
-                    mixBuffer[i]    += ((((int16_t)((data[idx >> 1] >> ((idx & 1) << 2)) & 0x0F) - 8) * 4096) * finalVol) >> 16;
-                    currentEnv      += envStep;
+                    uint32_t idx = (uint32_t)(pos >> 16);
+                    MIX_ADD_RAMP(i, (((int16_t)((data[idx >> 1] >> ((idx & 1) << 2)) & 0x0F) - 8) * 4096));
                     ADVANCE_SAMPLE_POS
                 }
                 break;
@@ -122,12 +261,25 @@ static FORCE_INLINE IRAM_ATTR void renderBlockSample(Voice* __restrict__ vo, int
     vo->sampleDirection = dir;
 }
 
+// Mipmapped wavetables: once per block, point wtData/wtSize at the pyramid level whose
+// top partial ((harmonics >> level) * inc) stays below Nyquist (2^31 in phase units).
+static FORCE_INLINE void wtSelectMip(Voice* __restrict__ vo, uint32_t inc) {
+    const WavetableMip* mip = vo->wtMip;
+    uint64_t top   = (uint64_t)inc * mip->harmonics;
+    int      level = 0;
+    while (top > 0x80000000ULL && level < mip->numLevels - 1) { top >>= 1; level++; }
+    vo->wtData = mip->levels[level];
+    vo->wtSize = mip->sizes[level];
+}
+
 // Render: Wavetable
-static FORCE_INLINE IRAM_ATTR void renderBlockWavetable(Voice* __restrict__ vo, int32_t* __restrict__ mixBuffer, int samples, int32_t startEnv, int32_t envStep) {
+static FORCE_INLINE IRAM_ATTR void renderBlockWavetable(Voice* __restrict__ vo, int32_t* __restrict__ mixBuffer, int samples, int32_t startEnv, int32_t envStep, const BitDepth depth) {
+    if (vo->wtMip) wtSelectMip(vo, vo->phaseInc + vo->vibOffset);
     if (!vo->wtData) return;
 
     int32_t        currentEnv = startEnv;
     int32_t        volBase    = ((uint32_t)vo->vol * vo->trmModGain) >> 8;
+    MIX_PAN(vo);
     uint32_t       ph         = vo->phase;
     uint32_t       inc        = vo->phaseInc + vo->vibOffset;
     const uint32_t size       = vo->wtSize;
@@ -135,10 +287,6 @@ static FORCE_INLINE IRAM_ATTR void renderBlockWavetable(Voice* __restrict__ vo,
 #if defined(CONFIG_IDF_TARGET_ESP32S3)
     v4u32 vInc     = {0, inc, inc * 2, inc * 3};
     v4u32 vIncStep = {inc * 4, inc * 4, inc * 4, inc * 4};
-    v4i32 vEnvStep = {0, envStep, envStep * 2, envStep * 3};
-    v4i32 vEnvStep4 = {envStep * 4, envStep * 4, envStep * 4, envStep * 4};
-    v4i32 vEnv     = {currentEnv, currentEnv, currentEnv, currentEnv};
-    vEnv += vEnvStep;
     v4u32 vPh = {ph, ph, ph, ph};
     vPh += vInc;
 #endif
@@ -149,7 +297,7 @@ static FORCE_INLINE IRAM_ATTR void renderBlockWavetable(Voice* __restrict__ vo,
         int32_t finalVol = (int32_t)((envSafe * volBase) >> 14);
         if (finalVol == 0) { vo->phase += inc * samples; return; }
 
-        switch (vo->depth) {
+        switch (depth) {
             case BITS_16: {
                 const int16_t* data = (const int16_t*)vo->wtData;
 #if defined(CONFIG_IDF_TARGET_ESP32S3)
@@ -157,13 +305,13 @@ static FORCE_INLINE IRAM_ATTR void renderBlockWavetable(Voice* __restrict__ vo,
                 for (int i = 0; i < samples; i += 4) {
                     v4u32 vIdx = ((vPh >> 16) * size) >> 16;
                     v4i32 vals = { data[vIdx[0]], data[vIdx[1]], data[vIdx[2]], data[vIdx[3]] };
-                    *(v4i32*)&mixBuffer[i] += (vals * vVolVec) >> 16;
+                    MIX_ADD4(i, vals, vVolVec);
                     vPh += vIncStep;
                 }
                 ph += inc * samples;
 #else
                 // OPTIMIZATION: Pure 32-bit replacement for 64-bit operations.
-                for (int i = 0; i < samples; i++) { mixBuffer[i] += (data[((ph >> 16) * size) >> 16] * finalVol) >> 16; ph += inc; }
+                for (int i = 0; i < samples; i++) { MIX_ADD(i, data[((ph >> 16) * size) >> 16], finalVol); ph += inc; }
 #endif
                 break;
             }
@@ -175,86 +323,92 @@ static FORCE_INLINE IRAM_ATTR void renderBlockWavetable(Voice* __restrict__ vo,
                     v4u32 vIdx = ((vPh >> 16) * size) >> 16;
                     v4i32 vals = { (int32_t)data[vIdx[0]], (int32_t)data[vIdx[1]], (int32_t)data[vIdx[2]], (int32_t)data[vIdx[3]] };
                     vals = (vals - 128) << 8;
-                    *(v4i32*)&mixBuffer[i] += (vals * vVolVec) >> 16;
+                    MIX_ADD4(i, vals, vVolVec);
                     vPh += vIncStep;
                 }
                 ph += inc * samples;
 #else
-                for (int i = 0; i < samples; i++) { mixBuffer[i] += ((((int16_t)data[((ph >> 16) * size) >> 16] - 128) << 8) * finalVol) >> 16; ph += inc; }
+                for (int i = 0; i < samples; i++) { MIX_ADD(i, (((int16_t)data[((ph >> 16) * size) >> 16] - 128) << 8), finalVol); ph += inc; }
 #endif
                 break;
             }
             case BITS_4: {
                 const uint8_t* data = (const uint8_t*)vo->wtData;
-                for (int i = 0; i < samples; i++) {
-                    uint32_t idx = ((ph >> 16) * size) >> 16;
-                    mixBuffer[i] += ((((int16_t)((data[idx >> 1] >> ((idx & 1) << 2)) & 0x0F) - 8) * 4096) * finalVol) >> 16;
-                    ph += inc;
+#if defined(CONFIG_IDF_TARGET_ESP32S3)
+                v4i32 vVolVec = {finalVol, finalVol, finalVol, finalVol};
+                for (int i = 0; i < samples; i += 4) {
+                    v4u32 vIdx = ((vPh >> 16) * size) >> 16;
+                    MIX_ADD4(i, wtEntryVec(data, vIdx, BITS_4), vVolVec);
+                    vPh += vIncStep;
                 }
+                ph += inc * samples;
+#else
+                // The nibble unpack is the longest dependency chain of any depth; unrolling
+                // lets the next index be computed while the previous byte is still loading.
+                #define WT4_FLAT(j) { MIX_ADD(j, wtEntry(data, ((ph >> 16) * size) >> 16, BITS_4), finalVol); ph += inc; }
+                int i = 0;
+                for (; i + 4 <= samples; i += 4) { WT4_FLAT(i) WT4_FLAT(i + 1) WT4_FLAT(i + 2) WT4_FLAT(i + 3) }
+                for (; i < samples; i++) WT4_FLAT(i)
+                #undef WT4_FLAT
+#endif
                 break;
             }
         }
     } else {
-        switch (vo->depth) {
+        switch (depth) {
             case BITS_16: {
                 const int16_t* data = (const int16_t*)vo->wtData;
 #if defined(CONFIG_IDF_TARGET_ESP32S3)
+                MIX_RAMP4(samples);
                 for (int i = 0; i < samples; i += 4) {
-                    v4i32 vEnvShifted = vEnv >> 14;
-                    vEnvShifted      &= ~(vEnvShifted >> 31);
-                    v4i32 vFinalVol   = (vEnvShifted * (int32_t)volBase) >> 14;
-                    v4u32 vIdx        = ((vPh >> 16) * size) >> 16;
-                    v4i32 vals        = { data[vIdx[0]], data[vIdx[1]], data[vIdx[2]], data[vIdx[3]] };
-                    *(v4i32*)&mixBuffer[i] += (vals * vFinalVol) >> 16;
-                    vPh += vIncStep; vEnv += vEnvStep4;
+                    v4u32 vIdx = ((vPh >> 16) * size) >> 16;
+                    v4i32 vals = { data[vIdx[0]], data[vIdx[1]], data[vIdx[2]], data[vIdx[3]] };
+                    MIX_ADD4_RAMP(i, vals);
+                    vPh += vIncStep;
                 }
                 ph += inc * samples; currentEnv += envStep * samples;
 #else
-                for (int i = 0; i < samples; i++) {
-                    int32_t envSafe  = currentEnv >> 14;
-                    envSafe         &= ~(envSafe >> 31);
-                    int32_t finalVol = (envSafe * volBase) >> 14;
-                    mixBuffer[i]    += (data[((ph >> 16) * size) >> 16] * finalVol) >> 16;
-                    ph += inc; currentEnv += envStep;
-                }
+                MIX_RAMP(samples);
+                for (int i = 0; i < samples; i++) { MIX_ADD_RAMP(i, data[((ph >> 16) * size) >> 16]); ph += inc; }
 #endif
                 break;
             }
             case BITS_8: {
                 const uint8_t* data = (const uint8_t*)vo->wtData;
 #if defined(CONFIG_IDF_TARGET_ESP32S3)
+                MIX_RAMP4(samples);
                 for (int i = 0; i < samples; i += 4) {
-                    v4i32 vEnvShifted = vEnv >> 14;
-                    vEnvShifted      &= ~(vEnvShifted >> 31);
-                    v4i32 vFinalVol   = (vEnvShifted * (int32_t)volBase) >> 14;
-                    v4u32 vIdx        = ((vPh >> 16) * size) >> 16;
-                    v4i32 vals        = { (int32_t)data[vIdx[0]], (int32_t)data[vIdx[1]], (int32_t)data[vIdx[2]], (int32_t)data[vIdx[3]] };
+                    v4u32 vIdx = ((vPh >> 16) * size) >> 16;
+                    v4i32 vals = { (int32_t)data[vIdx[0]], (int32_t)data[vIdx[1]], (int32_t)data[vIdx[2]], (int32_t)data[vIdx[3]] };
                     vals = (vals - 128) << 8;
-                    *(v4i32*)&mixBuffer[i] += (vals * vFinalVol) >> 16;
-                    vPh += vIncStep; vEnv += vEnvStep4;
+                    MIX_ADD4_RAMP(i, vals);
+                    vPh += vIncStep;
                 }
                 ph += inc * samples; currentEnv += envStep * samples;
 #else
-                for (int i = 0; i < samples; i++) {
-                    int32_t envSafe  = currentEnv >> 14;
-                    envSafe         &= ~(envSafe >> 31);
-                    int32_t finalVol = (envSafe * volBase) >> 14;
-                    mixBuffer[i]    += ((((int16_t)data[((ph >> 16) * size) >> 16] - 128) << 8) * finalVol) >> 16;
-                    ph += inc; currentEnv += envStep;
-                }
+                MIX_RAMP(samples);
+                for (int i = 0; i < samples; i++) { MIX_ADD_RAMP(i, (((int16_t)data[((ph >> 16) * size) >> 16] - 128) << 8)); ph += inc; }
 #endif
                 break;
             }
             case BITS_4: {
                 const uint8_t* data = (const uint8_t*)vo->wtData;
-                for (int i = 0; i < samples; i++) {
-                    uint32_t idx     = ((ph >> 16) * size) >> 16;
-                    int32_t envSafe  = currentEnv >> 14;
-                    envSafe         &= ~(envSafe >> 31);
-                    int32_t finalVol = (envSafe * volBase) >> 14;
-                    mixBuffer[i]    += ((((int16_t)((data[idx >> 1] >> ((idx & 1) << 2)) & 0x0F) - 8) * 4096) * finalVol) >> 16;
-                    ph += inc; currentEnv += envStep;
+#if defined(CONFIG_IDF_TARGET_ESP32S3)
+                MIX_RAMP4(samples);
+                for (int i = 0; i < samples; i += 4) {
+                    v4u32 vIdx = ((vPh >> 16) * size) >> 16;
+                    MIX_ADD4_RAMP(i, wtEntryVec(data, vIdx, BITS_4));
+                    vPh += vIncStep;
                 }
+                ph += inc * samples; currentEnv += envStep * samples;
+#else
+                MIX_RAMP(samples);
+                #define WT4_ENV(j) { MIX_ADD_RAMP(j, wtEntry(data, ((ph >> 16) * size) >> 16, BITS_4)); ph += inc; }
+                int i = 0;
+                for (; i + 4 <= samples; i += 4) { WT4_ENV(i) WT4_ENV(i + 1) WT4_ENV(i + 2) WT4_ENV(i + 3) }
+                for (; i < samples; i++) WT4_ENV(i)
+                #undef WT4_ENV
+#endif
                 break;
             }
         }
@@ -262,22 +416,185 @@ static FORCE_INLINE IRAM_ATTR void renderBlockWavetable(Voice* __restrict__ vo,
     vo->phase = ph;
 }
 
+// Render: Wavetable, linearly interpolated
+// Same phase -> index mapping as renderBlockWavetable, but the fractional part of
+// (phase >> 16) * size that the nearest-neighbour kernel drops weights the next entry,
+// so a 256-point table sounds like a 2048-point one read raw, at 1/8 of the memory.
+
+static FORCE_INLINE int32_t wtLerp(const void* data, uint32_t ph, uint32_t size, const BitDepth depth) {
+    uint32_t pos = (ph >> 16) * size; // 16.16 table position
+    uint32_t idx = pos >> 16;
+    uint32_t nxt = (idx + 1 < size) ? idx + 1 : 0;
+    int32_t  s0  = wtEntry(data, idx, depth);
+    int32_t  s1  = wtEntry(data, nxt, depth);
+    return s0 + (((s1 - s0) * (int32_t)((pos & 0xFFFF) >> 1)) >> 15);
+}
+
+static FORCE_INLINE IRAM_ATTR void renderBlockWavetableLerp(Voice* __restrict__ vo, int32_t* __restrict__ mixBuffer, int samples, int32_t startEnv, int32_t envStep, const BitDepth depth) {
+    if (vo->wtMip) wtSelectMip(vo, vo->phaseInc + vo->vibOffset);
+    if (!vo->wtData) return;
+
+    const void*    data       = vo->wtData;
+    int32_t        currentEnv = startEnv;
+    int32_t        volBase    = ((uint32_t)vo->vol * vo->trmModGain) >> 8;
+    MIX_PAN(vo);
+    uint32_t       ph         = vo->phase;
+    uint32_t       inc        = vo->phaseInc + vo->vibOffset;
+    const uint32_t size       = vo->wtSize;
+
+#if defined(CONFIG_IDF_TARGET_ESP32S3)
+    // Index, neighbour and weight are computed four lanes at a time; only the two table
+    // reads per lane stay scalar (there is no gather).
+    v4u32 vPh       = {ph, ph + inc, ph + inc * 2, ph + inc * 3};
+    v4u32 vIncStep  = {inc * 4, inc * 4, inc * 4, inc * 4};
+    v4u32 vSize     = {size, size, size, size};
+
+    #define WT_LERP_VEC(vals) \
+        v4u32 vPos = (vPh >> 16) * vSize; \
+        v4u32 vIdx = vPos >> 16; \
+        v4u32 vNxt = vIdx + 1; \
+        vNxt &= (v4u32)(vNxt < vSize); \
+        v4i32 s0 = { wtEntry(data, vIdx[0], depth), wtEntry(data, vIdx[1], depth), wtEntry(data, vIdx[2], depth), wtEntry(data, vIdx[3], depth) }; \
+        v4i32 s1 = { wtEntry(data, vNxt[0], depth), wtEntry(data, vNxt[1], depth), wtEntry(data, vNxt[2], depth), wtEntry(data, vNxt[3], depth) }; \
+        v4i32 vals = s0 + (((s1 - s0) * (v4i32)((vPos & 0xFFFF) >> 1)) >> 15);
+#endif
+
+    if (envStep == 0) {
+        int32_t envSafe  = currentEnv >> 14;
+        envSafe         &= ~(envSafe >> 31);
+        int32_t finalVol = (int32_t)((envSafe * volBase) >> 14);
+        if (finalVol == 0) { vo->phase += inc * samples; return; }
+
+#if defined(CONFIG_IDF_TARGET_ESP32S3)
+        v4i32 vVolVec = {finalVol, finalVol, finalVol, finalVol};
+        for (int i = 0; i < samples; i += 4) {
+            WT_LERP_VEC(vals)
+            MIX_ADD4(i, vals, vVolVec);
+            vPh += vIncStep;
+        }
+        ph += inc * samples;
+#else
+        // Unrolled by 4 so the LX6 can overlap the table loads of neighbouring samples.
+        int i = 0;
+        for (; i + 4 <= samples; i += 4) {
+            MIX_ADD(i, wtLerp(data, ph,           size, depth), finalVol);
+            MIX_ADD(i + 1, wtLerp(data, ph + inc,     size, depth), finalVol);
+            MIX_ADD(i + 2, wtLerp(data, ph + inc * 2, size, depth), finalVol);
+            MIX_ADD(i + 3, wtLerp(data, ph + inc * 3, size, depth), finalVol);
+            ph += inc * 4;
+        }
+        for (; i < samples; i++) { MIX_ADD(i, wtLerp(data, ph, size, depth), finalVol); ph += inc; }
+#endif
+    } else {
+#if defined(CONFIG_IDF_TARGET_ESP32S3)
+        MIX_RAMP4(samples);
+        for (int i = 0; i < samples; i += 4) {
+            WT_LERP_VEC(vals)
+            MIX_ADD4_RAMP(i, vals);
+            vPh += vIncStep;
+        }
+        ph += inc * samples;
+#else
+        MIX_RAMP(samples);
+        #define WT_LERP_ENV(j) { MIX_ADD_RAMP(j, wtLerp(data, ph, size, depth)); ph += inc; }
+        int i = 0;
+        for (; i + 4 <= samples; i += 4) { WT_LERP_ENV(i) WT_LERP_ENV(i + 1) WT_LERP_ENV(i + 2) WT_LERP_ENV(i + 3) }
+        for (; i < samples; i++) WT_LERP_ENV(i)
+        #undef WT_LERP_ENV
+#endif
+    }
+#if defined(CONFIG_IDF_TARGET_ESP32S3)
+    #undef WT_LERP_VEC
+#endif
+    vo->phase = ph;
+}
+
+// Render: PCM Sample, interpolated (linear or 4-point Hermite)
+// Same position / loop handling as renderBlockSample; the 16-bit fraction of samplePos1616
+// that the plain kernel drops weights the neighbouring frames. Frames past the loop end
+// wrap to the loop start (forward / reverse loops) or mirror (ping-pong) so loop points
+// stay click-free; without a loop the last frame is held.
+static FORCE_INLINE uint32_t sampleNeighbour(const Voice* vo, uint32_t idx, uint32_t lStart, uint32_t lEnd) {
+    if (LIKELY(idx < lEnd)) return idx;
+    uint32_t over = idx - lEnd;
+    switch (vo->sampleLoopMode) {
+        case LOOP_FORWARD:
+        case LOOP_REVERSE:  idx = lStart + over;       break;
+        case LOOP_PINGPONG: idx = lEnd - 1 - over;     break;
+        default:            idx = lEnd - 1;            break;
+    }
+    return (idx < lEnd) ? idx : lEnd - 1;
+}
+
+static FORCE_INLINE int32_t sampleInterpAt(const Voice* vo, const void* data, uint64_t pos, uint32_t lStart, uint32_t lEnd, const BitDepth depth, const SampleInterp mode) {
+    uint32_t idx = (uint32_t)(pos >> 16);
+    int32_t  t   = (int32_t)((pos & 0xFFFF) >> 1); // Q15
+    int32_t  s1  = wtEntry(data, idx, depth);
+    int32_t  s2  = wtEntry(data, sampleNeighbour(vo, idx + 1, lStart, lEnd), depth);
+    if (mode == INTERP_LINEAR) return s1 + (((s2 - s1) * t) >> 15);
+
+    int32_t s0 = wtEntry(data, idx ? idx - 1 : 0, depth);
+    int32_t s3 = wtEntry(data, sampleNeighbour(vo, idx + 2, lStart, lEnd), depth);
+    // Catmull-Rom / Hermite, coefficients doubled to stay integer; Horner in Q15
+    int32_t h1  = s2 - s0;
+    int32_t h2  = 2 * s0 - 5 * s1 + 4 * s2 - s3;
+    int32_t h3  = (s3 - s0) + 3 * (s1 - s2);
+    int32_t acc = (int32_t)(((int64_t)h3 * t) >> 15) + h2;
+    acc         = (int32_t)(((int64_t)acc * t) >> 15) + h1;
+    acc         = (int32_t)(((int64_t)acc * t) >> 16);
+    int32_t out = s1 + acc;
+    // The cubic can overshoot between full-scale frames; keep it in sample range.
+    return (out > 32767) ? 32767 : (out < -32768) ? -32768 : out;
+}
+
+static FORCE_INLINE IRAM_ATTR void renderBlockSampleInterp(Voice* __restrict__ vo, int32_t* __restrict__ mixBuffer, int samples, int32_t startEnv, int32_t envStep, const BitDepth depth, const SampleInterp mode) {
+    if (vo->sampleFinished) return;
+    const SampleData* sData = &registeredSamples[vo->curSampleId];
+    if (!sData->data) return;
+
+    const void*    data   = sData->data;
+    const uint32_t len    = sData->length;
+    uint64_t       pos    = vo->samplePos1616;
+    const uint32_t inc    = vo->sampleInc1616;
+    const uint32_t lStart = vo->sampleLoopStart;
+    const uint32_t lEnd   = (vo->sampleLoopEnd > 0 && vo->sampleLoopEnd <= len) ? vo->sampleLoopEnd : len;
+    int32_t        currentEnv = startEnv;
+    int32_t        volBase    = ((uint32_t)vo->vol * vo->trmModGain) >> 8;
+    MIX_PAN(vo);
+    bool           dir        = vo->sampleDirection;
+
+    if (envStep == 0) {
+        int32_t envSafe  = currentEnv >> 14;
+        envSafe         &= ~(envSafe >> 31);
+        int32_t finalVol = (int32_t)((envSafe * volBase) >> 14);
+        for (int i = 0; i < samples; i++) {
+            MIX_ADD(i, sampleInterpAt(vo, data, pos, lStart, lEnd, depth, mode), finalVol);
+            ADVANCE_SAMPLE_POS
+        }
+    } else {
+        MIX_RAMP(samples);
+        for (int i = 0; i < samples; i++) {
+            MIX_ADD_RAMP(i, sampleInterpAt(vo, data, pos, lStart, lEnd, depth, mode));
+            ADVANCE_SAMPLE_POS
+        }
+    }
+    vo->samplePos1616  = pos;
+    vo->sampleDirection = dir;
+}
+
 // Render: Basic Oscillators (Saw, Sine, Pulse, Triangle)
-static FORCE_INLINE IRAM_ATTR void renderBlockBasic(Voice* __restrict__ vo, int32_t* __restrict__ mixBuffer, int samples, int32_t startEnv, int32_t envStep) {
+// 'type' is the effective waveform (tracker instruments pass their current step's wave).
+static FORCE_INLINE IRAM_ATTR void renderBlockBasic(Voice* __restrict__ vo, int32_t* __restrict__ mixBuffer, int samples, int32_t startEnv, int32_t envStep, const WaveType type) {
     int32_t        currentEnv = startEnv;
     int32_t        volBase    = ((uint32_t)vo->vol * vo->trmModGain) >> 8;
+    MIX_PAN(vo);
     uint32_t       ph         = vo->phase;
     uint32_t       inc        = vo->phaseInc + vo->vibOffset;
-    const WaveType type       = vo->type;
     const uint32_t pw         = vo->pulseWidth;
 
 #if defined(CONFIG_IDF_TARGET_ESP32S3)
     v4u32 vInc      = {0, inc, inc * 2, inc * 3};
     v4u32 vIncStep  = {inc * 4, inc * 4, inc * 4, inc * 4};
-    v4i32 vEnvStep  = {0, envStep, envStep * 2, envStep * 3};
-    v4i32 vEnvStep4 = {envStep * 4, envStep * 4, envStep * 4, envStep * 4};
-    v4i32 vEnv      = {currentEnv, currentEnv, currentEnv, currentEnv};
-    vEnv += vEnvStep;
     v4u32 vPh = {ph, ph, ph, ph};
     vPh += vInc;
 #endif
@@ -296,13 +613,13 @@ static FORCE_INLINE IRAM_ATTR void renderBlockBasic(Voice* __restrict__ vo, int3
                     for (int i = 0; i < samples; i += 4) {
                         v4i32 shifted = (v4i32)(vPh >> 16);
                         shifted = (shifted << 16) >> 16;
-                        *(v4i32*)&mixBuffer[i] += (shifted * vVolVec) >> 16;
+                        MIX_ADD4(i, shifted, vVolVec);
                         vPh += vIncStep;
                     }
                     ph += inc * samples;
                 }
 #else
-                for (int i = 0; i < samples; i++) { mixBuffer[i] += ((int16_t)(ph >> 16) * finalVol) >> 16; ph += inc; }
+                for (int i = 0; i < samples; i++) { MIX_ADD(i, (int16_t)(ph >> 16), finalVol); ph += inc; }
 #endif
                 break;
             case WAVE_SINE:
@@ -311,33 +628,41 @@ static FORCE_INLINE IRAM_ATTR void renderBlockBasic(Voice* __restrict__ vo, int3
                     v4i32 vVolVec = {finalVol, finalVol, finalVol, finalVol};
                     for (int i = 0; i < samples; i += 4) {
                         v4i32 sines = { sineLUT[vPh[0] >> SINE_SHIFT], sineLUT[vPh[1] >> SINE_SHIFT], sineLUT[vPh[2] >> SINE_SHIFT], sineLUT[vPh[3] >> SINE_SHIFT] };
-                        *(v4i32*)&mixBuffer[i] += (sines * vVolVec) >> 16;
+                        MIX_ADD4(i, sines, vVolVec);
                         vPh += vIncStep;
                     }
                     ph += inc * samples;
                 }
 #else
-                for (int i = 0; i < samples; i++) { mixBuffer[i] += (sineLUT[ph >> SINE_SHIFT] * finalVol) >> 16; ph += inc; }
+                for (int i = 0; i < samples; i++) { MIX_ADD(i, sineLUT[ph >> SINE_SHIFT], finalVol); ph += inc; }
 #endif
                 break;
             case WAVE_PULSE:
 #if defined(CONFIG_IDF_TARGET_ESP32S3)
                 {
-                    int32_t sVolPos  = (finalVol * 32767) >> 16;
                     v4u32 vPw        = {pw, pw, pw, pw};
+#if SYNTH_ENABLE_STEREO
+                    v4i32 vVolVec    = {finalVol, finalVol, finalVol, finalVol};
+#else
+                    int32_t sVolPos  = (finalVol * 32767) >> 16;
                     v4i32 vVolNeg    = {-sVolPos, -sVolPos, -sVolPos, -sVolPos};
                     v4i32 vVolPos2   = {sVolPos * 2, sVolPos * 2, sVolPos * 2, sVolPos * 2};
+#endif
 
                     for (int i = 0; i < samples; i += 4) {
                         v4i32 diff = (v4i32)((vPh >> 1) - (vPw >> 1));
                         v4i32 mask = diff >> 31;
+#if SYNTH_ENABLE_STEREO
+                        MIX_ADD4(i, (mask & 65534) - 32767, vVolVec);
+#else
                         *(v4i32*)&mixBuffer[i] += vVolNeg + (mask & vVolPos2);
+#endif
                         vPh += vIncStep;
                     }
                     ph += inc * samples;
                 }
 #else
-                for (int i = 0; i < samples; i++) { mixBuffer[i] += (((ph < pw) ? 32767 : -32767) * finalVol) >> 16; ph += inc; }
+                for (int i = 0; i < samples; i++) { MIX_ADD(i, ((ph < pw) ? 32767 : -32767), finalVol); ph += inc; }
 #endif
                 break;
             case WAVE_TRIANGLE:
@@ -349,7 +674,7 @@ static FORCE_INLINE IRAM_ATTR void renderBlockBasic(Voice* __restrict__ vo, int3
                         saw           = (saw << 16) >> 16;
                         v4i32 sawMask = saw >> 31;
                         v4i32 tri     = (((saw ^ sawMask) * 2) - 32767);
-                        *(v4i32*)&mixBuffer[i] += (tri * vVolVec) >> 16;
+                        MIX_ADD4(i, tri, vVolVec);
                         vPh += vIncStep;
                     }
                     ph += inc * samples;
@@ -357,7 +682,7 @@ static FORCE_INLINE IRAM_ATTR void renderBlockBasic(Voice* __restrict__ vo, int3
 #else
                 for (int i = 0; i < samples; i++) {
                     int16_t saw  = (int16_t)(ph >> 16);
-                    mixBuffer[i] += ((int16_t)(((saw ^ (saw >> 15)) * 2) - 32767) * finalVol) >> 16;
+                    MIX_ADD(i, (int16_t)(((saw ^ (saw >> 15)) * 2) - 32767), finalVol);
                     ph += inc;
                 }
 #endif
@@ -368,44 +693,38 @@ static FORCE_INLINE IRAM_ATTR void renderBlockBasic(Voice* __restrict__ vo, int3
         switch (type) {
             case WAVE_SAW:
 #if defined(CONFIG_IDF_TARGET_ESP32S3)
-                for (int i = 0; i < samples; i += 4) {
-                    v4i32 vEnvShifted = vEnv >> 14;
-                    vEnvShifted      &= ~(vEnvShifted >> 31);
-                    v4i32 vFinalVol   = (vEnvShifted * (int32_t)volBase) >> 14;
-                    v4i32 shifted     = (v4i32)(vPh >> 16);
-                    shifted           = (shifted << 16) >> 16;
-                    *(v4i32*)&mixBuffer[i] += (shifted * vFinalVol) >> 16;
-                    vPh += vIncStep; vEnv += vEnvStep4;
+                {
+                    MIX_RAMP4(samples);
+                    for (int i = 0; i < samples; i += 4) {
+                        v4i32 shifted = (v4i32)(vPh >> 16);
+                        shifted = (shifted << 16) >> 16;
+                        MIX_ADD4_RAMP(i, shifted);
+                        vPh += vIncStep;
+                    }
+                    ph += inc * samples;
                 }
-                ph += inc * samples; currentEnv += envStep * samples;
 #else
-                for (int i = 0; i < samples; i++) {
-                    int32_t envSafe  = currentEnv >> 14;
-                    envSafe         &= ~(envSafe >> 31);
-                    int32_t finalVol = (int32_t)((envSafe * volBase) >> 14);
-                    mixBuffer[i]    += ((int16_t)(ph >> 16) * finalVol) >> 16;
-                    ph += inc; currentEnv += envStep;
+                {
+                    MIX_RAMP(samples);
+                    for (int i = 0; i < samples; i++) { MIX_ADD_RAMP(i, (int16_t)(ph >> 16)); ph += inc; }
                 }
 #endif
                 break;
             case WAVE_SINE:
 #if defined(CONFIG_IDF_TARGET_ESP32S3)
-                for (int i = 0; i < samples; i += 4) {
-                    v4i32 vEnvShifted = vEnv >> 14;
-                    vEnvShifted      &= ~(vEnvShifted >> 31);
-                    v4i32 vFinalVol   = (vEnvShifted * (int32_t)volBase) >> 14;
-                    v4i32 sines       = { sineLUT[vPh[0] >> SINE_SHIFT], sineLUT[vPh[1] >> SINE_SHIFT], sineLUT[vPh[2] >> SINE_SHIFT], sineLUT[vPh[3] >> SINE_SHIFT] };
-                    *(v4i32*)&mixBuffer[i] += (sines * vFinalVol) >> 16;
-                    vPh += vIncStep; vEnv += vEnvStep4;
+                {
+                    MIX_RAMP4(samples);
+                    for (int i = 0; i < samples; i += 4) {
+                        v4i32 sines = { sineLUT[vPh[0] >> SINE_SHIFT], sineLUT[vPh[1] >> SINE_SHIFT], sineLUT[vPh[2] >> SINE_SHIFT], sineLUT[vPh[3] >> SINE_SHIFT] };
+                        MIX_ADD4_RAMP(i, sines);
+                        vPh += vIncStep;
+                    }
+                    ph += inc * samples;
                 }
-                ph += inc * samples; currentEnv += envStep * samples;
 #else
-                for (int i = 0; i < samples; i++) {
-                    int32_t envSafe  = currentEnv >> 14;
-                    envSafe         &= ~(envSafe >> 31);
-                    int32_t finalVol = (int32_t)((envSafe * volBase) >> 14);
-                    mixBuffer[i]    += (sineLUT[ph >> SINE_SHIFT] * finalVol) >> 16;
-                    ph += inc; currentEnv += envStep;
+                {
+                    MIX_RAMP(samples);
+                    for (int i = 0; i < samples; i++) { MIX_ADD_RAMP(i, sineLUT[ph >> SINE_SHIFT]); ph += inc; }
                 }
 #endif
                 break;
@@ -413,53 +732,60 @@ static FORCE_INLINE IRAM_ATTR void renderBlockBasic(Voice* __restrict__ vo, int3
 #if defined(CONFIG_IDF_TARGET_ESP32S3)
                 {
                     v4u32 vPw = {pw, pw, pw, pw};
+#if SYNTH_ENABLE_STEREO
+                    MIX_RAMP4(samples);
+#else
+                    v4i32 vEnv      = {currentEnv, currentEnv + envStep, currentEnv + envStep * 2, currentEnv + envStep * 3};
+                    v4i32 vEnvStep4 = {envStep * 4, envStep * 4, envStep * 4, envStep * 4};
+#endif
                     for (int i = 0; i < samples; i += 4) {
-                        v4i32 vEnvShifted = vEnv >> 14;
-                        vEnvShifted      &= ~(vEnvShifted >> 31);
-                        v4i32 vFinalVol   = (vEnvShifted * (int32_t)volBase) >> 14;
-
                         v4i32 diff   = (v4i32)((vPh >> 1) - (vPw >> 1));
                         v4i32 mask   = diff >> 31;
-                        v4i32 vVolPos = (vFinalVol * 32767) >> 16;
 
+#if SYNTH_ENABLE_STEREO
+                        MIX_ADD4_RAMP(i, (mask & 65534) - 32767);
+#else
+                        v4i32 vEnvShifted = vEnv >> 14;
+                        vEnvShifted      &= ~(vEnvShifted >> 31);
+                        v4i32 vFinalVol   = (vEnvShifted * (int32_t)volBase) >> 14;
+                        v4i32 vVolPos     = (vFinalVol * 32767) >> 16;
                         *(v4i32*)&mixBuffer[i] += (-vVolPos) + (mask & (vVolPos * 2));
+                        vEnv += vEnvStep4;
+#endif
 
-                        vPh += vIncStep; vEnv += vEnvStep4;
+                        vPh += vIncStep;
                     }
-                    ph += inc * samples; currentEnv += envStep * samples;
+                    ph += inc * samples;
                 }
 #else
-                for (int i = 0; i < samples; i++) {
-                    int32_t envSafe  = currentEnv >> 14;
-                    envSafe         &= ~(envSafe >> 31);
-                    int32_t finalVol = (int32_t)((envSafe * volBase) >> 14);
-                    mixBuffer[i]    += (((ph < pw) ? 32767 : -32767) * finalVol) >> 16;
-                    ph += inc; currentEnv += envStep;
+                {
+                    MIX_RAMP(samples);
+                    for (int i = 0; i < samples; i++) { MIX_ADD_RAMP(i, ((ph < pw) ? 32767 : -32767)); ph += inc; }
                 }
 #endif
                 break;
             case WAVE_TRIANGLE:
 #if defined(CONFIG_IDF_TARGET_ESP32S3)
-                for (int i = 0; i < samples; i += 4) {
-                    v4i32 vEnvShifted = vEnv >> 14;
-                    vEnvShifted      &= ~(vEnvShifted >> 31);
-                    v4i32 vFinalVol   = (vEnvShifted * (int32_t)volBase) >> 14;
-                    v4i32 saw         = (v4i32)(vPh >> 16);
-                    saw               = (saw << 16) >> 16;
-                    v4i32 sawMask     = saw >> 31;
-                    v4i32 tri         = (((saw ^ sawMask) * 2) - 32767);
-                    *(v4i32*)&mixBuffer[i] += (tri * vFinalVol) >> 16;
-                    vPh += vIncStep; vEnv += vEnvStep4;
+                {
+                    MIX_RAMP4(samples);
+                    for (int i = 0; i < samples; i += 4) {
+                        v4i32 saw     = (v4i32)(vPh >> 16);
+                        saw           = (saw << 16) >> 16;
+                        v4i32 sawMask = saw >> 31;
+                        v4i32 tri     = (((saw ^ sawMask) * 2) - 32767);
+                        MIX_ADD4_RAMP(i, tri);
+                        vPh += vIncStep;
+                    }
+                    ph += inc * samples;
                 }
-                ph += inc * samples; currentEnv += envStep * samples;
 #else
-                for (int i = 0; i < samples; i++) {
-                    int32_t envSafe  = currentEnv >> 14;
-                    envSafe         &= ~(envSafe >> 31);
-                    int32_t finalVol = (int32_t)((envSafe * volBase) >> 14);
-                    int16_t saw      = (int16_t)(ph >> 16);
-                    mixBuffer[i]    += ((int16_t)(((saw ^ (saw >> 15)) * 2) - 32767) * finalVol) >> 16;
-                    ph += inc; currentEnv += envStep;
+                {
+                    MIX_RAMP(samples);
+                    for (int i = 0; i < samples; i++) {
+                        int16_t saw = (int16_t)(ph >> 16);
+                        MIX_ADD_RAMP(i, (int16_t)(((saw ^ (saw >> 15)) * 2) - 32767));
+                        ph += inc;
+                    }
                 }
 #endif
                 break;
@@ -469,57 +795,364 @@ static FORCE_INLINE IRAM_ATTR void renderBlockBasic(Voice* __restrict__ vo, int3
     vo->phase = ph;
 }
 
+// Render: Band-limited Saw / Pulse (PolyBLEP)
+// The naive waveform plus a polynomial residual on the samples within one phase increment
+// of each discontinuity, which removes most of the aliasing the raw saw/pulse fold back
+// above ~1 kHz. 'rcp' = 2^31 / (inc >> 8) turns a phase distance into a Q15 fraction of inc,
+// so there is no division per sample. Returns the residual of a rising unit step at 'edge'
+// in sample units (+ just before the edge, - just after).
+static FORCE_INLINE int32_t polyBlep(uint32_t ph, uint32_t edge, uint32_t inc, uint32_t rcp) {
+    uint32_t after  = ph - edge;
+    uint32_t before = edge - ph;
+    if (LIKELY(after >= inc && before >= inc)) return 0;
+    bool     isAfter = after < inc;
+    uint32_t dist    = isAfter ? after : before;
+    int32_t  q       = 32768 - (int32_t)(((dist >> 8) * rcp) >> 16);
+    int32_t  r       = (q * q) >> 15;
+    return isAfter ? -r : r;
+}
+
+static FORCE_INLINE int32_t polyBlepSample(uint32_t ph, uint32_t inc, uint32_t rcp, uint32_t pw, const WaveType type) {
+    if (type == WAVE_SAW_BL) return (int16_t)(ph >> 16) - polyBlep(ph, 0x80000000UL, inc, rcp); // Falls at half phase
+    return ((ph < pw) ? 32767 : -32767) + polyBlep(ph, 0, inc, rcp) - polyBlep(ph, pw, inc, rcp);
+}
+
+#if defined(CONFIG_IDF_TARGET_ESP32S3)
+// Branch-free four-lane version: lanes away from an edge get a zero residual through masks.
+static FORCE_INLINE v4i32 polyBlepVec(v4u32 vPh, v4u32 vEdge, v4u32 vInc, v4u32 vRcp) {
+    v4u32 after  = vPh - vEdge;
+    v4u32 before = vEdge - vPh;
+    v4i32 mA     = (v4i32)(after < vInc);
+    v4i32 mB     = (v4i32)(before < vInc) & ~mA;
+    v4u32 dist   = (after & (v4u32)mA) | (before & (v4u32)mB);
+    v4i32 q      = 32768 - (v4i32)(((dist >> 8) * vRcp) >> 16);
+    v4i32 r      = (q * q) >> 15;
+    return (r & mB) - (r & mA);
+}
+
+static FORCE_INLINE v4i32 polyBlepSampleVec(v4u32 vPh, v4u32 vInc, v4u32 vRcp, v4u32 vPw, const WaveType type) {
+    if (type == WAVE_SAW_BL) {
+        v4u32 vHalf = {0x80000000UL, 0x80000000UL, 0x80000000UL, 0x80000000UL};
+        v4i32 saw   = ((v4i32)(vPh >> 16) << 16) >> 16;
+        return saw - polyBlepVec(vPh, vHalf, vInc, vRcp);
+    }
+    v4u32 vZero = {0, 0, 0, 0};
+    v4i32 mask  = (v4i32)((vPh >> 1) - (vPw >> 1)) >> 31;
+    v4i32 pulse = (mask & 65534) - 32767;
+    return pulse + polyBlepVec(vPh, vZero, vInc, vRcp) - polyBlepVec(vPh, vPw, vInc, vRcp);
+}
+#endif
+
+static FORCE_INLINE IRAM_ATTR void renderBlockPolyBlep(Voice* __restrict__ vo, int32_t* __restrict__ mixBuffer, int samples, int32_t startEnv, int32_t envStep, const WaveType type) {
+    int32_t        currentEnv = startEnv;
+    int32_t        volBase    = ((uint32_t)vo->vol * vo->trmModGain) >> 8;
+    MIX_PAN(vo);
+    uint32_t       ph         = vo->phase;
+    uint32_t       inc        = vo->phaseInc + vo->vibOffset;
+    const uint32_t pw         = vo->pulseWidth;
+
+    // Residual window; 0 disables it for near-DC and above-Nyquist increments.
+    const uint32_t blepInc = (inc >= 0x10000 && inc < 0x80000000UL) ? inc : 0;
+    const uint32_t rcp     = blepInc ? 0x80000000UL / (blepInc >> 8) : 0;
+
+#if defined(CONFIG_IDF_TARGET_ESP32S3)
+    v4u32 vPh       = {ph, ph + inc, ph + inc * 2, ph + inc * 3};
+    v4u32 vIncStep  = {inc * 4, inc * 4, inc * 4, inc * 4};
+    v4u32 vBlepInc  = {blepInc, blepInc, blepInc, blepInc};
+    v4u32 vRcp      = {rcp, rcp, rcp, rcp};
+    v4u32 vPw       = {pw, pw, pw, pw};
+#endif
+
+    if (envStep == 0) {
+        int32_t envSafe  = currentEnv >> 14;
+        envSafe         &= ~(envSafe >> 31);
+        int32_t finalVol = (int32_t)((envSafe * volBase) >> 14);
+        if (finalVol == 0) { vo->phase += inc * samples; return; }
+
+#if defined(CONFIG_IDF_TARGET_ESP32S3)
+        v4i32 vVolVec = {finalVol, finalVol, finalVol, finalVol};
+        for (int i = 0; i < samples; i += 4) {
+            MIX_ADD4(i, polyBlepSampleVec(vPh, vBlepInc, vRcp, vPw, type), vVolVec);
+            vPh += vIncStep;
+        }
+        ph += inc * samples;
+#else
+        for (int i = 0; i < samples; i++) { MIX_ADD(i, polyBlepSample(ph, blepInc, rcp, pw, type), finalVol); ph += inc; }
+#endif
+    } else {
+#if defined(CONFIG_IDF_TARGET_ESP32S3)
+        MIX_RAMP4(samples);
+        for (int i = 0; i < samples; i += 4) {
+            MIX_ADD4_RAMP(i, polyBlepSampleVec(vPh, vBlepInc, vRcp, vPw, type));
+            vPh += vIncStep;
+        }
+        ph += inc * samples;
+#else
+        MIX_RAMP(samples);
+        for (int i = 0; i < samples; i++) { MIX_ADD_RAMP(i, polyBlepSample(ph, blepInc, rcp, pw, type)); ph += inc; }
+#endif
+    }
+    vo->phase = ph;
+}
+
 // Render: Noise
+// Sample-and-hold LCG noise: a new value is drawn each time the (16x) phase wraps. The
+// draw is branch-free (the next LCG state is always computed and selected on wrap), since
+// at typical noise pitches the wrap is too frequent for the branch to predict. The S3 path
+// handles 4 samples per step: the wraps are prefix-summed per lane and the LCG is jumped
+// ahead 1..4 states at once (x -> A^k x + C_k), so the lanes do not wait on each other.
+#define NOISE_LCG_A 1664525U
+#define NOISE_LCG_C 1013904223U
+
+#if defined(CONFIG_IDF_TARGET_ESP32S3)
+// A^k and C_k = C (A^(k-1) + ... + 1) for k = 1..4
+#define NOISE_LCG_A2 (NOISE_LCG_A * NOISE_LCG_A)
+#define NOISE_LCG_A3 (NOISE_LCG_A2 * NOISE_LCG_A)
+#define NOISE_LCG_A4 (NOISE_LCG_A3 * NOISE_LCG_A)
+#define NOISE_LCG_C2 (NOISE_LCG_C * NOISE_LCG_A + NOISE_LCG_C)
+#define NOISE_LCG_C3 (NOISE_LCG_C2 * NOISE_LCG_A + NOISE_LCG_C)
+#define NOISE_LCG_C4 (NOISE_LCG_C3 * NOISE_LCG_A + NOISE_LCG_C)
+
+// Per-lane sample values for one 4-sample step; advances rng / cur past the step.
+static FORCE_INLINE v4i32 noiseStepVec(v4u32 vPh, v4u32 vPrev, uint32_t& rng, int16_t& cur) {
+    const v4i32 vZero = {0, 0, 0, 0};
+    v4i32 wrap = (v4i32)(vPh < vPrev); // -1 where the phase wrapped on that sample
+    v4i32 cnt  = -(wrap + __builtin_shuffle(wrap, vZero, (v4i32){4, 0, 1, 2})
+                        + __builtin_shuffle(wrap, vZero, (v4i32){4, 4, 0, 1})
+                        + __builtin_shuffle(wrap, vZero, (v4i32){4, 4, 4, 0}));
+    v4i32 vCur = {cur, cur, cur, cur};
+    int   total = cnt[3];
+    if (total == 0) return vCur;
+
+    const v4u32 vA = {NOISE_LCG_A, NOISE_LCG_A2, NOISE_LCG_A3, NOISE_LCG_A4};
+    const v4u32 vC = {NOISE_LCG_C, NOISE_LCG_C2, NOISE_LCG_C3, NOISE_LCG_C4};
+    v4u32 next = vA * rng + vC;
+    v4i32 vals = (v4i32)(next >> 16);
+    vals       = (vals << 16) >> 16;
+    rng = next[total - 1];
+    cur = (int16_t)vals[total - 1];
+    // Lane draws value cnt - 1, or keeps the previous one (index 7 = vCur) when cnt == 0.
+    return __builtin_shuffle(vals, vCur, (cnt + 7) & 7);
+}
+#endif
+
 static FORCE_INLINE IRAM_ATTR void renderBlockNoise(Voice* __restrict__ vo, int32_t* __restrict__ mixBuffer, int samples, int32_t startEnv, int32_t envStep) {
     int32_t  currentEnv   = startEnv;
     int32_t  volBase      = ((uint32_t)vo->vol * vo->trmModGain) >> 8;
+    MIX_PAN(vo);
     uint32_t rng          = vo->rngState;
     uint32_t ph           = vo->phase;
     uint32_t inc          = (vo->phaseInc + vo->vibOffset) << 4;
     int16_t  currentSample = vo->noiseSample;
 
+#if defined(CONFIG_IDF_TARGET_ESP32S3)
+    v4u32 vPrev    = {ph, ph + inc, ph + inc * 2, ph + inc * 3};
+    v4u32 vPh      = vPrev + inc;
+    v4u32 vIncStep = {inc * 4, inc * 4, inc * 4, inc * 4};
+#else
+    // One draw, selected without a branch when the phase wraps.
+    #define NOISE_STEP { \
+        uint32_t nextPh  = ph + inc; \
+        uint32_t nextRng = (rng * NOISE_LCG_A) + NOISE_LCG_C; \
+        bool     wrapped = nextPh < ph; \
+        rng           = wrapped ? nextRng : rng; \
+        currentSample = wrapped ? (int16_t)(nextRng >> 16) : currentSample; \
+        ph = nextPh; }
+#endif
+
     if (envStep == 0) {
         int32_t envSafe  = currentEnv >> 14;
         envSafe         &= ~(envSafe >> 31);
         int32_t finalVol = (int32_t)((envSafe * volBase) >> 14);
         if (finalVol == 0) { vo->phase += inc * samples; return; }
 
-        for (int i = 0; i < samples; i++) {
-            uint32_t nextPh = ph + inc;
-            if (UNLIKELY(nextPh < ph)) { rng = (rng * 1664525) + 1013904223; currentSample = (int16_t)(rng >> 16); }
-            ph = nextPh;
-            mixBuffer[i] += (currentSample * finalVol) >> 16;
+#if defined(CONFIG_IDF_TARGET_ESP32S3)
+        v4i32 vVolVec = {finalVol, finalVol, finalVol, finalVol};
+        for (int i = 0; i < samples; i += 4) {
+            v4i32 vals = noiseStepVec(vPh, vPrev, rng, currentSample);
+            MIX_ADD4(i, vals, vVolVec);
+            vPh += vIncStep; vPrev += vIncStep;
         }
+        ph += inc * samples;
+#else
+        int i = 0;
+        for (; i + 4 <= samples; i += 4) {
+            NOISE_STEP MIX_ADD(i, currentSample, finalVol);
+            NOISE_STEP MIX_ADD(i + 1, currentSample, finalVol);
+            NOISE_STEP MIX_ADD(i + 2, currentSample, finalVol);
+            NOISE_STEP MIX_ADD(i + 3, currentSample, finalVol);
+        }
+        for (; i < samples; i++) { NOISE_STEP MIX_ADD(i, currentSample, finalVol); }
+#endif
     } else {
-        for (int i = 0; i < samples; i++) {
-            uint32_t nextPh = ph + inc;
-            if (UNLIKELY(nextPh < ph)) { rng = (rng * 1664525) + 1013904223; currentSample = (int16_t)(rng >> 16); }
-            ph = nextPh;
-            int32_t envSafe  = currentEnv >> 14;
-            envSafe         &= ~(envSafe >> 31);
-            int32_t finalVol = (int32_t)((envSafe * volBase) >> 14);
-            mixBuffer[i]    += (currentSample * finalVol) >> 16;
-            currentEnv      += envStep;
+#if defined(CONFIG_IDF_TARGET_ESP32S3)
+        MIX_RAMP4(samples);
+        for (int i = 0; i < samples; i += 4) {
+            v4i32 vals = noiseStepVec(vPh, vPrev, rng, currentSample);
+            MIX_ADD4_RAMP(i, vals);
+            vPh += vIncStep; vPrev += vIncStep;
         }
+        ph += inc * samples;
+#else
+        MIX_RAMP(samples);
+        #define NOISE_ENV(j) { NOISE_STEP MIX_ADD_RAMP(j, currentSample); }
+        int i = 0;
+        for (; i + 4 <= samples; i += 4) { NOISE_ENV(i) NOISE_ENV(i + 1) NOISE_ENV(i + 2) NOISE_ENV(i + 3) }
+        for (; i < samples; i++) NOISE_ENV(i)
+        #undef NOISE_ENV
+#endif
     }
+#if !defined(CONFIG_IDF_TARGET_ESP32S3)
+    #undef NOISE_STEP
+#endif
     vo->rngState    = rng;
     vo->phase       = ph;
     vo->noiseSample = currentSample;
 }
 
 // Render: Stream from RAM Buffer
+// When the ring already holds every frame the block will consume (the normal case, the SD
+// task keeps it topped up) nothing can clamp, so frame i sits at tail + (pos >> 16) with
+// pos = accum + inc * (i + 1): no state is carried from one sample to the next and the
+// loop runs 4-wide on the S3 / 4x unrolled elsewhere. An underrun takes the per-sample
+// loop, which consumes only what is available.
+static FORCE_INLINE int32_t streamFrame(const int16_t* buf, uint32_t tail, uint32_t pos) {
+    uint32_t t    = tail + (pos >> 16);
+    int16_t  val1 = buf[t & STREAM_BUF_MASK];
+    int16_t  val2 = buf[(t + 1) & STREAM_BUF_MASK];
+    return val1 + (((val2 - val1) * (int32_t)((pos & 0xFFFF) >> 1)) >> 15);
+}
+
+static FORCE_INLINE void renderStreamDirect(const Voice* vo, const int16_t* __restrict__ buf, uint32_t tail, uint32_t accum, uint32_t inc, int32_t* __restrict__ mixBuffer, int samples, int32_t currentEnv, int32_t envStep, int32_t volBase) {
+    MIX_PAN(vo);
+#if defined(CONFIG_IDF_TARGET_ESP32S3)
+    v4u32 vPos     = {accum + inc, accum + inc * 2, accum + inc * 3, accum + inc * 4};
+    v4u32 vIncStep = {inc * 4, inc * 4, inc * 4, inc * 4};
+    MIX_RAMP4(samples);
+    for (int i = 0; i < samples; i += 4) {
+        v4u32 t      = tail + (vPos >> 16);
+        v4u32 t1     = (t + 1) & STREAM_BUF_MASK;
+        t           &= STREAM_BUF_MASK;
+        v4i32 val1   = { buf[t[0]],  buf[t[1]],  buf[t[2]],  buf[t[3]] };
+        v4i32 val2   = { buf[t1[0]], buf[t1[1]], buf[t1[2]], buf[t1[3]] };
+        v4i32 interp = val1 + (((val2 - val1) * (v4i32)((vPos & 0xFFFF) >> 1)) >> 15);
+        MIX_ADD4_RAMP(i, interp);
+        vPos += vIncStep;
+    }
+#else
+    uint32_t pos = accum;
+    MIX_RAMP(samples);
+    #define STREAM_DIRECT(j) { pos += inc; MIX_ADD_RAMP(j, streamFrame(buf, tail, pos)); }
+    int i = 0;
+    for (; i + 4 <= samples; i += 4) { STREAM_DIRECT(i) STREAM_DIRECT(i + 1) STREAM_DIRECT(i + 2) STREAM_DIRECT(i + 3) }
+    for (; i < samples; i++) STREAM_DIRECT(i)
+    #undef STREAM_DIRECT
+#endif
+}
+
+#if SYNTH_ENABLE_STEREO
+// Stereo track: the L and R rings share head / tail, so both channels are read at the same
+// frame position and written to the bus in one pass, balanced by the voice's pan.
+static FORCE_INLINE void renderStreamDirectLR(const Voice* vo, const int16_t* __restrict__ bufL, const int16_t* __restrict__ bufR, uint32_t tail, uint32_t accum, uint32_t inc, int32_t* __restrict__ mixBuffer, int samples, int32_t currentEnv, int32_t envStep, int32_t volBase) {
+    MIX_BALANCE(vo);
+#if defined(CONFIG_IDF_TARGET_ESP32S3)
+    v4u32 vPos     = {accum + inc, accum + inc * 2, accum + inc * 3, accum + inc * 4};
+    v4u32 vIncStep = {inc * 4, inc * 4, inc * 4, inc * 4};
+    MIX_RAMP4(samples);
+    for (int i = 0; i < samples; i += 4) {
+        v4u32 t           = tail + (vPos >> 16);
+        v4u32 t1          = (t + 1) & STREAM_BUF_MASK;
+        t                &= STREAM_BUF_MASK;
+        v4i32 frac        = (v4i32)((vPos & 0xFFFF) >> 1);
+        v4i32 l1          = { bufL[t[0]],  bufL[t[1]],  bufL[t[2]],  bufL[t[3]] };
+        v4i32 l2          = { bufL[t1[0]], bufL[t1[1]], bufL[t1[2]], bufL[t1[3]] };
+        v4i32 r1          = { bufR[t[0]],  bufR[t[1]],  bufR[t[2]],  bufR[t[3]] };
+        v4i32 r2          = { bufR[t1[0]], bufR[t1[1]], bufR[t1[2]], bufR[t1[3]] };
+        v4i32 interpL     = l1 + (((l2 - l1) * frac) >> 15);
+        v4i32 interpR     = r1 + (((r2 - r1) * frac) >> 15);
+        MIX_ADD4_RAMP_LR(i, interpL, interpR);
+        vPos += vIncStep;
+    }
+#else
+    uint32_t pos = accum;
+    MIX_RAMP(samples);
+    #define STREAM_DIRECT_LR(j) { pos += inc; MIX_ADD_RAMP_LR(j, streamFrame(bufL, tail, pos), streamFrame(bufR, tail, pos)); }
+    int i = 0;
+    for (; i + 4 <= samples; i += 4) { STREAM_DIRECT_LR(i) STREAM_DIRECT_LR(i + 1) STREAM_DIRECT_LR(i + 2) STREAM_DIRECT_LR(i + 3) }
+    for (; i < samples; i++) STREAM_DIRECT_LR(i)
+    #undef STREAM_DIRECT_LR
+#endif
+}
+
+static FORCE_INLINE IRAM_ATTR void renderBlockStreamLR(Voice* __restrict__ vo, StreamTrack* __restrict__ trk, int32_t* __restrict__ mixBuffer, int samples, int32_t startEnv, int32_t envStep) {
+    int32_t  currentEnv = startEnv;
+    int32_t  volBase    = ((uint32_t)vo->vol * vo->trmModGain) >> 8;
+    uint32_t inc        = vo->sampleInc1616;
+    uint32_t accum      = vo->streamFracAccum;
+    uint16_t tail       = trk->tail;
+    uint16_t head       = trk->head;
+
+    uint64_t end       = accum + (uint64_t)inc * samples;
+    uint16_t buffered  = (STREAM_BUF_SAMPLES + head - tail) & STREAM_BUF_MASK;
+    if (LIKELY(end <= 0xFFFFFFFFULL && (end >> 16) <= buffered)) {
+        renderStreamDirectLR(vo, trk->buffer, trk->bufferR, tail, accum, inc, mixBuffer, samples, currentEnv, envStep, volBase);
+        uint32_t consumed   = (uint32_t)(end >> 16);
+        vo->streamFracAccum = (uint32_t)end & 0xFFFF;
+        trk->tail           = (tail + consumed) & STREAM_BUF_MASK;
+        trk->samplesPlayed += consumed;
+        return;
+    }
+
+    // Underrun: consume only what the ring holds (rare, so one loop serves both env cases).
+    MIX_BALANCE(vo);
+    MIX_RAMP(samples);
+    for (int i = 0; i < samples; i++) {
+        accum += inc;
+        uint32_t stepsToConsume = accum >> 16;
+        accum &= 0xFFFF;
+
+        if (stepsToConsume > 0) {
+            uint16_t available = (STREAM_BUF_SAMPLES + head - tail) & STREAM_BUF_MASK;
+            if (stepsToConsume > available) stepsToConsume = available;
+            tail             = (tail + stepsToConsume) & STREAM_BUF_MASK;
+            trk->samplesPlayed += stepsToConsume;
+        }
+
+        MIX_ADD_RAMP_LR(i, streamFrame(trk->buffer, tail, accum), streamFrame(trk->bufferR, tail, accum));
+    }
+    vo->streamFracAccum = accum;
+    trk->tail           = tail;
+}
+#endif
+
 static FORCE_INLINE IRAM_ATTR void renderBlockStream(Voice* __restrict__ vo, StreamTrack* __restrict__ streamsArr, int32_t* __restrict__ mixBuffer, int samples, int32_t startEnv, int32_t envStep) {
     if (vo->streamTrackId < 0 || vo->streamTrackId >= MAX_STREAMS) return;
     StreamTrack* trk = &streamsArr[vo->streamTrackId];
     if (!trk->playing) return;
+#if SYNTH_ENABLE_STEREO
+    if (trk->numChannels == 2) { renderBlockStreamLR(vo, trk, mixBuffer, samples, startEnv, envStep); return; }
+#endif
 
     int32_t  currentEnv = startEnv;
     int32_t  volBase    = ((uint32_t)vo->vol * vo->trmModGain) >> 8;
+    MIX_PAN(vo);
     uint32_t inc        = vo->sampleInc1616;
     uint32_t accum      = vo->streamFracAccum;
     uint16_t tail       = trk->tail;
     uint16_t head       = trk->head;
 
+    uint64_t end       = accum + (uint64_t)inc * samples;
+    uint16_t buffered  = (STREAM_BUF_SAMPLES + head - tail) & STREAM_BUF_MASK;
+    if (LIKELY(end <= 0xFFFFFFFFULL && (end >> 16) <= buffered)) {
+        // With envStep == 0 the ramp is flat, so one loop serves both cases.
+        renderStreamDirect(vo, trk->buffer, tail, accum, inc, mixBuffer, samples, currentEnv, envStep, volBase);
+        uint32_t consumed   = (uint32_t)(end >> 16);
+        vo->streamFracAccum = (uint32_t)end & 0xFFFF;
+        trk->tail           = (tail + consumed) & STREAM_BUF_MASK;
+        trk->samplesPlayed += consumed;
+        return;
+    }
+
     if (envStep == 0) {
         int32_t envSafe  = currentEnv >> 14;
         envSafe         &= ~(envSafe >> 31);
@@ -539,9 +1172,10 @@ static FORCE_INLINE IRAM_ATTR void renderBlockStream(Voice* __restrict__ vo, Str
             int16_t val1   = trk->buffer[tail];
             int16_t val2   = trk->buffer[(tail + 1) & STREAM_BUF_MASK];
             int32_t interp = val1 + (((val2 - val1) * (int32_t)(accum >> 1)) >> 15);
-            mixBuffer[i]  += (interp * finalVol) >> 16;
+            MIX_ADD(i, interp, finalVol);
         }
     } else {
+        MIX_RAMP(samples);
         for (int i = 0; i < samples; i++) {
             accum += inc;
             uint32_t stepsToConsume = accum >> 16;
@@ -557,27 +1191,205 @@ static FORCE_INLINE IRAM_ATTR void renderBlockStream(Voice* __restrict__ vo, Str
             int16_t val1   = trk->buffer[tail];
             int16_t val2   = trk->buffer[(tail + 1) & STREAM_BUF_MASK];
             int32_t interp = val1 + (((val2 - val1) * (int32_t)(accum >> 1)) >> 15);
-
-            int32_t envSafe  = currentEnv >> 14;
-            envSafe         &= ~(envSafe >> 31);
-            int32_t finalVol = (int32_t)((envSafe * volBase) >> 14);
-            mixBuffer[i]    += (interp * finalVol) >> 16;
-            currentEnv      += envStep;
+            MIX_ADD_RAMP(i, interp);
         }
     }
     vo->streamFracAccum = accum;
     trk->tail           = tail;
 }
 
-// Classic ADSR Envelope Logic (Optimized)
-static FORCE_INLINE IRAM_ATTR void updateAdsrBlock(Voice* vo, int samples, int32_t& startEnv, int32_t& envStep) {
+// Render: Custom (user callback)
+// The callback contract is a mono int32 buffer. Stereo builds run it in short chunks on a
+// scratch buffer (its envelope ramp restarted at each chunk offset) and spread the result
+// with the voice's pan gains.
+#define CUSTOM_CHUNK 64
+
+static FORCE_INLINE IRAM_ATTR void renderBlockCustom(Voice* __restrict__ vo, int32_t* __restrict__ mixBuffer, int samples, int32_t startEnv, int32_t envStep) {
+#if SYNTH_ENABLE_STEREO
+    MIX_PAN(vo);
+    int32_t scratch[CUSTOM_CHUNK] __attribute__((aligned(16)));
+    for (int pos = 0; pos < samples; pos += CUSTOM_CHUNK) {
+        int n = (samples - pos < CUSTOM_CHUNK) ? samples - pos : CUSTOM_CHUNK;
+        memset(scratch, 0, n * sizeof(int32_t));
+        vo->customWaveFunc(vo, scratch, n, startEnv + envStep * pos, envStep);
+        int32_t* out = mixBuffer + pos * 2;
+        for (int j = 0; j < n; j++) {
+            out[j * 2]     += (int32_t)(((int64_t)scratch[j] * panL) >> 15);
+            out[j * 2 + 1] += (int32_t)(((int64_t)scratch[j] * panR) >> 15);
+        }
+    }
+#else
+    vo->customWaveFunc(vo, mixBuffer, samples, startEnv, envStep);
+#endif
+}
+
+// ====================================================================================
+//    KERNEL CLASSIFICATION
+// ====================================================================================
+// render() buckets the sounding voices by the kernel they will actually run, then renders
+// each bucket in one tight loop with the waveform / bit depth as a compile-time constant.
+// Voices of one kind stay together, so IRAM fetches stop bouncing between the big inlined
+// kernels and the per-voice type switch disappears from the hot loop. RenderKernel itself
+// lives in ESP32Synth.h because the bucket bookkeeping is sized by it.
+static FORCE_INLINE uint8_t kernelOfBasic(int8_t type) {
+    switch (type) {
+        case WAVE_SINE:     return RK_SINE;
+        case WAVE_TRIANGLE: return RK_TRIANGLE;
+        case WAVE_SAW:      return RK_SAW;
+        case WAVE_PULSE:    return RK_PULSE;
+        case WAVE_NOISE:    return RK_NOISE;
+        case WAVE_SAW_BL:   return RK_SAW_BL;
+        case WAVE_PULSE_BL: return RK_PULSE_BL;
+        default:            return RK_SKIP;
+    }
+}
+
+static FORCE_INLINE uint8_t kernelOfDepth(uint8_t depth, uint8_t k16) {
+    // k16, k16 + 1, k16 + 2 are the 16, 8 and 4-bit variants
+    switch (depth) {
+        case BITS_16: return k16;
+        case BITS_8:  return k16 + 1;
+        case BITS_4:  return k16 + 2;
+        default:      return RK_SKIP;
+    }
+}
+
+static FORCE_INLINE IRAM_ATTR uint8_t classifyVoiceKernel(const Voice* vo) {
     if (vo->inst) {
+        if (vo->currWaveIsBasic) return kernelOfBasic(vo->currWaveType);
+        return vo->wtData ? kernelOfDepth(vo->depth, vo->wtInterp ? RK_WAVETABLE_LERP_16 : RK_WAVETABLE_16) : RK_SKIP;
+    }
+    switch (vo->type) {
+        case WAVE_SAMPLE: {
+            if (vo->sampleFinished) return RK_SKIP;
+            const SampleData* sData = &registeredSamples[vo->curSampleId];
+            if (!sData->data) return RK_SKIP;
+            return kernelOfDepth(sData->depth, vo->sampleInterp == INTERP_HERMITE ? RK_SAMPLE_HERMITE_16 :
+                                               vo->sampleInterp == INTERP_LINEAR  ? RK_SAMPLE_LERP_16 : RK_SAMPLE_16);
+        }
+        case WAVE_STREAM:    return RK_STREAM;
+        case WAVE_WAVETABLE: return vo->wtData ? kernelOfDepth(vo->depth, vo->wtInterp ? RK_WAVETABLE_LERP_16 : RK_WAVETABLE_16) : RK_SKIP;
+        case WAVE_CUSTOM:    return vo->customWaveFunc ? RK_CUSTOM : RK_SKIP;
+        default:             return kernelOfBasic(vo->type);
+    }
+}
+
+// Curved / Multi-Stage Envelope
+// A segment takes the level from envFrom to envTarget while envPos runs 0 -> ENV_MAX at
+// envPosRate. The curve is only evaluated at the block's start and end (two LUT reads);
+// the kernels get the usual linear ramp in between, so the per-sample cost is unchanged.
+
+// Share of the way still to go at progress 'pos', Q15
+static FORCE_INLINE uint32_t envCurveRemaining(uint8_t curve, uint32_t pos) {
+    if (curve == ENV_CURVE_LINEAR) return (ENV_MAX - pos) >> 13;
+    uint32_t x    = (curve == ENV_CURVE_EXP) ? ENV_MAX - pos : pos;
+    uint32_t idx  = x >> (28 - ENV_CURVE_LUT_BITS);
+    uint32_t frac = (x >> (28 - ENV_CURVE_LUT_BITS - 15)) & 0x7FFF;
+    uint32_t g    = (idx >= ENV_CURVE_LUT_SIZE) ? envCurveLUT[ENV_CURVE_LUT_SIZE]
+                  : envCurveLUT[idx] + (((envCurveLUT[idx + 1] - envCurveLUT[idx]) * frac) >> 15);
+    return (curve == ENV_CURVE_EXP) ? g : 32768 - g;
+}
+
+static FORCE_INLINE void envStartSegment(Voice* vo, uint32_t target, uint8_t curve, uint32_t samples) {
+    vo->envFrom     = vo->currEnvVal;
+    vo->envTarget   = target;
+    vo->envCurve    = curve;
+    vo->envPos      = 0;
+    vo->envPosRate  = (samples == 0) ? ENV_MAX : (samples >= ENV_MAX) ? 1 : ENV_MAX / samples;
+    vo->envSegState = vo->envState;
+}
+
+// ADSR stage of setEnv(): same rates as the linear envelope, so the same durations.
+static FORCE_INLINE void envStartAdsrSegment(Voice* vo) {
+    uint32_t target, rate;
+    uint8_t  curve;
+    switch (vo->envState) {
+        case ENV_ATTACK: target = ENV_MAX;          rate = vo->rateAttack;  curve = vo->envCurves & 3;        break;
+        case ENV_DECAY:  target = vo->levelSustain; rate = vo->rateDecay;   curve = (vo->envCurves >> 2) & 3; break;
+        default:         target = 0;                rate = vo->rateRelease; curve = (vo->envCurves >> 4) & 3; break;
+    }
+    uint32_t from = vo->currEnvVal;
+    uint32_t dist = (from > target) ? from - target : target - from;
+    if (rate == 0) rate = 1;
+    envStartSegment(vo, target, curve, (rate >= ENV_MAX) ? 0 : (dist + rate - 1) / rate);
+}
+
+static FORCE_INLINE void envStartTableSegment(Voice* vo, uint32_t sampleRate) {
+    const EnvSegment* sg = &vo->envTable->segs[vo->envSeg];
+    envStartSegment(vo, sg->level * (ENV_MAX / 255), sg->curve, (uint32_t)(((uint64_t)sg->timeMs * sampleRate) / 1000));
+}
+
+static FORCE_INLINE IRAM_ATTR void updateShapedEnvBlock(Voice* vo, int samples, int32_t& startEnv, int32_t& envStep, uint32_t sampleRate) {
+    const SynthEnvelope* env = vo->envTable;
+    startEnv = vo->currEnvVal;
+    envStep  = 0;
+
+    uint8_t state = vo->envState;
+    if (state == ENV_IDLE || state == ENV_SUSTAIN) return;
+
+    if (vo->envSegState != state) {
+        if (UNLIKELY(vo->stealFade)) { // noteOnAuto() steal: SYNTH_STEAL_FADE_SAMPLES from full scale
+            envStartSegment(vo, 0, ENV_CURVE_LINEAR, (uint32_t)(((uint64_t)vo->currEnvVal * SYNTH_STEAL_FADE_SAMPLES) >> 28));
+        } else if (!env) {
+            envStartAdsrSegment(vo);
+        } else if (vo->envSegState == ENV_SEG_NEXT) {
+            envStartTableSegment(vo, sampleRate);
+        } else if (state != ENV_RELEASE) { // noteOn(): from the first stage
+            vo->envState = ENV_ATTACK;
+            vo->envSeg   = 0;
+            envStartTableSegment(vo, sampleRate);
+        } else if (env->sustainSeg >= env->numSegs) { // One-shot: noteOff() does not cut it short
+            vo->envSegState = state;
+        } else if (env->sustainSeg + 1 < env->numSegs) {
+            vo->envSeg = env->sustainSeg + 1;
+            envStartTableSegment(vo, sampleRate);
+        } else { // No stage after the sustain one: setEnv()'s release
+            vo->envSeg = env->numSegs;
+            envStartAdsrSegment(vo);
+        }
+    }
+
+    uint64_t next = vo->envPos + (uint64_t)vo->envPosRate * samples;
+    uint32_t pos  = (next >= ENV_MAX) ? ENV_MAX : (uint32_t)next;
+    int64_t  end  = (int64_t)vo->envTarget + ((((int64_t)vo->envFrom - vo->envTarget) * envCurveRemaining(vo->envCurve, pos)) >> 15);
+    envStep        = (int32_t)((end - startEnv) / samples);
+    vo->envPos     = pos;
+    vo->currEnvVal = (uint32_t)end;
+    if (pos < ENV_MAX) return;
+
+    // Segment done, the next block starts the following one.
+    if (!env || vo->stealFade || vo->envSeg >= env->numSegs) {
+        vo->envState = (state == ENV_ATTACK) ? ENV_DECAY : (state == ENV_DECAY) ? ENV_SUSTAIN : ENV_IDLE;
+    } else if (state == ENV_ATTACK && vo->envSeg == env->sustainSeg) {
+        vo->envState = ENV_SUSTAIN;
+    } else if (vo->envSeg + 1 >= env->numSegs) {
+        vo->envState = ENV_IDLE;
+    } else {
+        vo->envSeg++;
+        vo->envSegState = ENV_SEG_NEXT;
+    }
+
+    if (vo->envState == ENV_IDLE) {
+        vo->currEnvVal = 0;
+        vo->active     = false;
+    }
+}
+
+// Classic ADSR Envelope Logic (Optimized)
+static FORCE_INLINE IRAM_ATTR void updateAdsrBlock(Voice* vo, int samples, int32_t& startEnv, int32_t& envStep, uint32_t sampleRate) {
+    // A tracker instrument holds the envelope at full scale, except while a steal fades it out.
+    if (vo->inst && !vo->stealFade) {
         startEnv       = ENV_MAX;
         vo->currEnvVal = ENV_MAX;
         envStep        = 0;
         return;
     }
 
+    if (UNLIKELY(vo->envShaped)) {
+        updateShapedEnvBlock(vo, samples, startEnv, envStep, sampleRate);
+        return;
+    }
+
     startEnv = vo->currEnvVal;
 
     if (vo->envState == ENV_IDLE || vo->envState == ENV_SUSTAIN) {
@@ -625,21 +1437,25 @@ static FORCE_INLINE IRAM_ATTR void updateAdsrBlock(Voice* vo, int samples, int32
         }
         break;
 
-    case ENV_RELEASE:
-        if (vo->rateRelease >= ENV_MAX) {
+    case ENV_RELEASE: {
+        // A stolen voice (noteOnAuto) releases in SYNTH_STEAL_FADE_SAMPLES at the most.
+        uint32_t rate = vo->rateRelease;
+        if (UNLIKELY(vo->stealFade) && rate < ENV_MAX / SYNTH_STEAL_FADE_SAMPLES) rate = ENV_MAX / SYNTH_STEAL_FADE_SAMPLES;
+        if (rate >= ENV_MAX) {
             startEnv       = 0;
             envStep        = 0;
             vo->envState   = ENV_IDLE;
         } else {
-            uint64_t totalChange = (uint64_t)vo->rateRelease * steps;
+            uint64_t totalChange = (uint64_t)rate * steps;
             if (target > totalChange) {
-                envStep = -((int32_t)vo->rateRelease);
+                envStep = -((int32_t)rate);
             } else {
                 envStep      = -((int32_t)target / (int32_t)steps);
                 vo->envState = ENV_IDLE;
             }
         }
         break;
+    }
     default:
         envStep = 0;
         break;
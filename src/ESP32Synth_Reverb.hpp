@@ -0,0 +1,212 @@
+#pragma once
+#include "ESP32Synth.h"
+
+// ====================================================================================
+//    FDN REVERB
+// ====================================================================================
+// A feedback delay network. Each sample, every line's output goes through its damping
+// low-pass, the N outputs are mixed by an unnormalised Hadamard matrix (a fast Walsh-
+// Hadamard transform: N log2 N adds, no multiplies), scaled by the line's decay gain and
+// written back with the input added. The matrix is orthogonal, so the per-line gains alone
+// set the decay, and the tail falls evenly (RT60) whatever the line lengths.
+//
+// Memory: each line is an int16 ring of its delay plus REV_MARGIN samples, all in one
+// allocation (PSRAM first). With the ring exactly that long, a slice's reads, modulation
+// margin included, start at the write index: processSlice() copies n + REV_MARGIN samples
+// of every line into _rd with at most two memcpy, runs the network out of internal RAM into
+// _wr and copies _wr back. A line is longer than a slice, so nothing written in a slice is
+// read in the same slice, and the inner loops never wrap an index.
+//
+// Budget: per frame and line, an interpolated read, a one-pole filter, log2 N matrix adds, a
+// gain and a saturating write. Counted on the ESP32 / ESP32-S3 that is about 300 cycles a
+// frame at 8 lines and 160 at 4, i.e. 6% / 3% of one 240 MHz core at 48 kHz, plus ~2 cycles
+// for the PSRAM block copies. getCyclesPerSample() shows the live figure, and the stage
+// sleeps (costs nothing) once the tail has died away.
+
+#define REV_MARGIN    (2 * SYNTH_REVERB_MOD_MAX + 1) // Extra ring samples for the modulated tap
+#define REV_IN_SHIFT  3                             // Mix -> line headroom
+#define REV_OUT_SHIFT 8                             // Q8 wet gain; the line sum undoes REV_IN_SHIFT
+
+#if SYNTH_REVERB_LINES == 8
+static const uint16_t revDelays48k[8] = {1153, 1399, 1627, 1873, 2083, 2339, 2593, 2861};
+#define REV_LOG2_LINES 3
+#elif SYNTH_REVERB_LINES == 4
+static const uint16_t revDelays48k[4] = {1399, 1873, 2339, 2861};
+#define REV_LOG2_LINES 2
+#else
+#error "SYNTH_REVERB_LINES must be 4 or 8"
+#endif
+
+// Ring -> cache / cache -> ring, 'n' samples from index 'at' of a ring of 'len'
+static FORCE_INLINE void revRingRead(int16_t* dst, const int16_t* ring, uint32_t len, uint32_t at, uint32_t n) {
+    uint32_t first = (at + n <= len) ? n : len - at;
+    memcpy(dst, ring + at, first * sizeof(int16_t));
+    if (first < n) memcpy(dst + first, ring, (n - first) * sizeof(int16_t));
+}
+
+static FORCE_INLINE void revRingWrite(int16_t* ring, const int16_t* src, uint32_t len, uint32_t at, uint32_t n) {
+    uint32_t first = (at + n <= len) ? n : len - at;
+    memcpy(ring + at, src, first * sizeof(int16_t));
+    if (first < n) memcpy(ring, src + first, (n - first) * sizeof(int16_t));
+}
+
+SynthReverb::~SynthReverb() {
+    end();
+}
+
+bool SynthReverb::begin(uint32_t sampleRate, uint8_t size) {
+    end();
+    if (sampleRate == 0) return false;
+    if (size < 25) size = 25;
+    if (size > 200) size = 200;
+    _sampleRate = sampleRate;
+
+    uint32_t total = 0;
+    for (int i = 0; i < SYNTH_REVERB_LINES; i++) {
+        uint32_t d = (uint32_t)(((uint64_t)revDelays48k[i] * sampleRate * size) / (48000ULL * 100));
+        if (d < SYNTH_FX_BLOCK) d = SYNTH_FX_BLOCK;
+        if (d > 65535 - REV_MARGIN) d = 65535 - REV_MARGIN;
+        _base[i] = total;
+        _len[i]  = (uint16_t)(d + REV_MARGIN);
+        total   += _len[i];
+    }
+
+    _mem = (int16_t*)synthDelayAlloc(total * sizeof(int16_t), _psram);
+    if (!_mem) return false;
+
+    reset();
+    setDecay(_rt60Ms);
+    setDamping(_dampCentiHz);
+    setModulation(_modRateCentiHz, (uint8_t)_modDepth);
+    return true;
+}
+
+void SynthReverb::end() {
+    if (_mem) heap_caps_free(_mem);
+    _mem   = nullptr;
+    _psram = false;
+    _tail  = 0;
+}
+
+void SynthReverb::reset() {
+    if (!_mem) return;
+    memset(_mem, 0, (_base[SYNTH_REVERB_LINES - 1] + _len[SYNTH_REVERB_LINES - 1]) * sizeof(int16_t));
+    for (int i = 0; i < SYNTH_REVERB_LINES; i++) { _pos[i] = 0; _lp[i] = 0; }
+}
+
+// g = 10^(-3 * delay / (rt60 * fs)) per line: every pass round a line costs the same dB per
+// second. The 1 / sqrt(N) of the matrix is folded in (Q14).
+void SynthReverb::setDecay(uint16_t rt60Ms) {
+    if (rt60Ms < 50) rt60Ms = 50;
+    _rt60Ms = rt60Ms;
+    if (!_mem) return;
+    const float perSample = -3.0f / (rt60Ms * 0.001f * _sampleRate);
+    uint32_t longest = 0;
+    for (int i = 0; i < SYNTH_REVERB_LINES; i++) {
+        const float d = (float)(_len[i] - REV_MARGIN) + _modDepth;
+        _gain[i] = (int32_t)(powf(10.0f, perSample * d) * 16384.0f / sqrtf((float)SYNTH_REVERB_LINES) + 0.5f);
+        if (_len[i] > longest) longest = _len[i];
+    }
+    _tail = (uint32_t)(((uint64_t)rt60Ms * _sampleRate) / 1000) + longest;
+}
+
+void SynthReverb::setDamping(uint32_t cutoffCentiHz) {
+    _dampCentiHz = cutoffCentiHz;
+    _dampA       = fxOnePoleQ15(cutoffCentiHz, _sampleRate);
+}
+
+void SynthReverb::setMix(uint8_t wet, uint8_t dry) {
+    _wet = fxGainQ8(wet);
+    _dry = fxGainQ8(dry);
+}
+
+void SynthReverb::setModulation(uint16_t rateCentiHz, uint8_t depth) {
+    if (depth > SYNTH_REVERB_MOD_MAX) depth = SYNTH_REVERB_MOD_MAX;
+    _modRateCentiHz = rateCentiHz;
+    _modDepth       = depth;
+    _lfoInc         = (uint32_t)(((uint64_t)rateCentiHz << 32) / ((uint64_t)_sampleRate * 100));
+}
+
+uint32_t SynthReverb::tailSamples() {
+    return _tail;
+}
+
+void IRAM_ATTR SynthReverb::process(int32_t* mix, int frames) {
+    if (!_mem) return;
+    for (int pos = 0; pos < frames; pos += SYNTH_FX_BLOCK) {
+        const int n = (frames - pos < SYNTH_FX_BLOCK) ? frames - pos : SYNTH_FX_BLOCK;
+        processSlice(mix + pos * SYNTH_MIX_CHANNELS, n);
+    }
+}
+
+void IRAM_ATTR SynthReverb::processSlice(int32_t* mix, int n) {
+    constexpr int N = SYNTH_REVERB_LINES;
+
+    // 1. Per line: fetch the slice and read the modulated tap. The tap for frame j sits at
+    // _rd[j + REV_MARGIN - m] with m <= REV_MARGIN - 1, at or after j, so it can overwrite
+    // _rd[j] in place.
+    const uint32_t phaseEnd = _lfoPhase + _lfoInc * (uint32_t)n;
+    for (int i = 0; i < N; i++) {
+        int16_t* rd = _rd[i];
+        revRingRead(rd, _mem + _base[i], _len[i], _pos[i], (uint32_t)n + REV_MARGIN);
+
+        const uint32_t offset = (uint32_t)i << (32 - REV_LOG2_LINES); // Spread the tap LFOs
+        const int32_t  m0     = (_modDepth << 16) + _modDepth * sineLUT[(_lfoPhase + offset) >> SINE_SHIFT] * 2;
+        const int32_t  m1     = (_modDepth << 16) + _modDepth * sineLUT[(phaseEnd + offset) >> SINE_SHIFT] * 2;
+        const int32_t  step   = (m1 - m0) / n;
+        int32_t m = m0;
+        for (int j = 0; j < n; j++) {
+            const int c = j + REV_MARGIN - (m >> 16);
+            rd[j] = (int16_t)(rd[c] + (((rd[c - 1] - rd[c]) * ((m & 0xFFFF) >> 1)) >> 15));
+            m    += step;
+        }
+    }
+    _lfoPhase = phaseEnd;
+
+    // 2. Per frame: damp the taps (N independent filters side by side), mix them through
+    // the matrix and feed back with the input.
+    int32_t lp[N], g[N];
+    for (int i = 0; i < N; i++) { lp[i] = _lp[i]; g[i] = _gain[i]; }
+    const int32_t a = _dampA, wet = _wet, dry = _dry;
+    for (int j = 0; j < n; j++) {
+        int32_t v[N];
+        for (int i = 0; i < N; i++) {
+            lp[i] += ((_rd[i][j] - lp[i]) * a + 16384) >> 15;
+            v[i]   = lp[i];
+        }
+
+        int32_t outL = 0, outR = 0;
+        for (int i = 0; i < N; i += 2) { outL += v[i]; outR += v[i + 1]; }
+
+        for (int h = 1; h < N; h <<= 1) {
+            for (int i = 0; i < N; i += h << 1) {
+                for (int k = i; k < i + h; k++) {
+                    const int32_t p = v[k], q = v[k + h];
+                    v[k] = p + q; v[k + h] = p - q;
+                }
+            }
+        }
+
+        const int32_t in = masterMono(mix, j) >> REV_IN_SHIFT;
+        for (int i = 0; i < N; i++) {
+            const int32_t fb = ((v[i] * g[i] + 8192) >> 14) + ((i & 1) ? -in : in);
+            _wr[i][j] = (int16_t)masterClamp16(fb);
+        }
+
+#if SYNTH_ENABLE_STEREO
+        mix[j * 2]     = (int32_t)(((int64_t)mix[j * 2] * dry) >> 8) + ((outL * wet) >> (REV_OUT_SHIFT - REV_IN_SHIFT + REV_LOG2_LINES - 1));
+        mix[j * 2 + 1] = (int32_t)(((int64_t)mix[j * 2 + 1] * dry) >> 8) + ((outR * wet) >> (REV_OUT_SHIFT - REV_IN_SHIFT + REV_LOG2_LINES - 1));
+#else
+        mix[j] = (int32_t)(((int64_t)mix[j] * dry) >> 8) + (((outL + outR) * wet) >> (REV_OUT_SHIFT - REV_IN_SHIFT + REV_LOG2_LINES));
+#endif
+    }
+
+    for (int i = 0; i < N; i++) _lp[i] = lp[i];
+
+    // 3. Write the slice back and move on.
+    for (int i = 0; i < N; i++) {
+        revRingWrite(_mem + _base[i], _wr[i], _len[i], _pos[i], (uint32_t)n);
+        uint32_t p = _pos[i] + (uint32_t)n;
+        _pos[i] = (uint16_t)((p >= _len[i]) ? p - _len[i] : p);
+    }
+}
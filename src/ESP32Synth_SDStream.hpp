@@ -1,6 +1,10 @@
 #pragma once
 #include "ESP32Synth.h"
 
+// The file and the stream slot are handled on the caller's task; every change a voice or
+// the render path can see goes through the command queue.
+#define STREAM_SYNC_TICKS 50 // Longest wait for the audio task to let go of a track
+
 #ifdef ARDUINO
 int8_t ESP32Synth::setupStream(uint16_t voice, fs::FS &fs, const char* path, uint32_t rootFreqCentiHz, bool loop) {
 #else
@@ -14,9 +18,7 @@ int8_t ESP32Synth::setupStream(uint16_t voice, const char* path, uint32_t rootFr
     }
 
     // Clear existing stream on this voice
-    if (voices[voice].streamTrackId >= 0) {
-        stopStream(voice);
-    }
+    stopStream(voice);
 
     // Find free stream slot
     int8_t streamId = -1;
@@ -51,16 +53,42 @@ int8_t ESP32Synth::setupStream(uint16_t voice, const char* path, uint32_t rootFr
     trk->loopStartBytes = dPos;
     trk->loopEndBytes   = dPos + dSize;
     trk->rootFreqCentiHz = rootFreqCentiHz;
+    trk->voice          = voice;
     trk->active         = true;
 
+    startStream(voice, streamId, 0, false);
+    return streamId;
+}
+
+// Attaches a set-up track to its voice and, with 'play', starts the envelope.
+void ESP32Synth::startStream(uint16_t voice, int8_t streamId, uint16_t volume, bool play) {
+    if (queueCommand(play ? CMD_PLAY_STREAM : CMD_SETUP_STREAM, voice, (uint32_t)streamId, volume)) return;
+
     Voice* vo           = &voices[voice];
     vo->type            = WAVE_STREAM;
     vo->streamTrackId   = streamId;
     vo->active          = false;
     vo->envState        = ENV_IDLE;
+    clearVoiceActive(voice);
     vo->currEnvVal      = 0;
+    if (!play) return;
 
-    return streamId;
+    StreamTrack* trk = &streams[streamId];
+    vo->vol          = volume << _volShift;
+
+    if (vo->freqVal == 0) vo->freqVal = trk->rootFreqCentiHz;
+    uint64_t ratio1616 = ((uint64_t)vo->freqVal << 16) / trk->rootFreqCentiHz;
+    vo->sampleInc1616  = (uint32_t)((ratio1616 * trk->sampleRate) / _sampleRate);
+
+    // Start ADSR envelope
+    if (vo->rateAttack >= ENV_MAX) {
+        vo->currEnvVal = ENV_MAX;
+        vo->envState   = ENV_DECAY;
+    } else {
+        vo->currEnvVal = 0;
+        vo->envState   = ENV_ATTACK;
+    }
+    markVoiceActive(voice);
 }
 
 #ifdef ARDUINO
@@ -88,51 +116,52 @@ int8_t ESP32Synth::playStream(uint16_t voice, const char* path, uint16_t volume,
         timeout--;
     }
 
-    Voice* vo = &voices[voice];
-    vo->vol   = volume << _volShift;
-
-    if (vo->freqVal == 0) vo->freqVal = rootFreqCentiHz;
-    uint64_t ratio1616 = ((uint64_t)vo->freqVal << 16) / rootFreqCentiHz;
-    vo->sampleInc1616  = (uint32_t)((ratio1616 * trk->sampleRate) / _sampleRate);
-
-    // Start ADSR envelope
-    if (vo->rateAttack >= ENV_MAX) {
-        vo->currEnvVal = ENV_MAX;
-        vo->envState   = ENV_DECAY;
-    } else {
-        vo->currEnvVal = 0;
-        vo->envState   = ENV_ATTACK;
-    }
-    vo->active = true;
-
+    startStream(voice, streamId, volume, true);
     return streamId;
 }
 
 void ESP32Synth::pauseStream(uint16_t voice) {
+    if (queueCommand(CMD_PAUSE_STREAM, voice)) return;
     if (voice < MAX_VOICES && voices[voice].streamTrackId >= 0) {
         streams[voices[voice].streamTrackId].playing = false;
     }
 }
 
 void ESP32Synth::resumeStream(uint16_t voice) {
+    if (queueCommand(CMD_RESUME_STREAM, voice)) return;
     if (voice < MAX_VOICES && voices[voice].streamTrackId >= 0) {
         streams[voices[voice].streamTrackId].playing = true;
     }
 }
 
+// The track is found through its own 'voice' rather than the voice's streamTrackId, which
+// may still wait in the queue. The audio task lets go of it at its next block, and the
+// file is closed here once it has (or in place, when no block comes to do it).
 void ESP32Synth::stopStream(uint16_t voice) {
-    if (voice < MAX_VOICES && voices[voice].streamTrackId >= 0) {
-        StreamTrack* trk = &streams[voices[voice].streamTrackId];
+    if (voice >= MAX_VOICES) return;
+    for (int i = 0; i < MAX_STREAMS; i++) {
+        StreamTrack* trk = &streams[i];
+        if (!trk->active || trk->voice != voice) continue;
 
-        trk->playing = false;
-        trk->active  = false;
+        if (queueCommand(CMD_STOP_STREAM, voice, (uint32_t)i)) {
+            for (int t = 0; t < STREAM_SYNC_TICKS && !trk->detached; t++) vTaskDelay(1);
+        }
+        if (!trk->detached) detachStream(voice, i);
 
+        trk->active = false;
         SYNTH_FILE_CLOSE(trk->file);
-        voices[voice].streamTrackId = -1;
     }
 }
 
+void ESP32Synth::detachStream(uint16_t voice, int8_t streamId) {
+    StreamTrack* trk = &streams[streamId];
+    trk->playing     = false;
+    if (voices[voice].streamTrackId == streamId) voices[voice].streamTrackId = -1;
+    trk->detached    = true;
+}
+
 void ESP32Synth::seekStreamMs(uint16_t voice, uint32_t ms) {
+    if (queueCommand(CMD_SEEK_STREAM, voice, ms)) return;
     if (voice < MAX_VOICES && voices[voice].streamTrackId >= 0) {
         StreamTrack* trk    = &streams[voices[voice].streamTrackId];
         uint32_t sampleTarget = (uint32_t)(((uint64_t)ms * trk->sampleRate) / 1000ULL);
@@ -141,6 +170,7 @@ void ESP32Synth::seekStreamMs(uint16_t voice, uint32_t ms) {
 }
 
 void ESP32Synth::setStreamLoopPointsMs(uint16_t voice, uint32_t startMs, uint32_t endMs) {
+    if (queueCommand(CMD_SET_STREAM_LOOP, voice, startMs, endMs)) return;
     if (voice >= MAX_VOICES || voices[voice].streamTrackId < 0) return;
     StreamTrack* trk = &streams[voices[voice].streamTrackId];
 
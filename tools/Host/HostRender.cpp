@@ -0,0 +1,422 @@
+// HostRender.cpp - Runs the real ESP32Synth engine on a desktop host.
+//
+// Renders a reproducible polyphonic patch through beginCustom() + generateSamples()
+// (pull mode) or through one of the shimmed hardware outputs, prints timing figures
+// and optionally writes the result to a 16-bit WAV file (stereo with SYNTH_HOST_STEREO).
+//
+//   ./HostRender --voices 80 --seconds 10 --wave mix --out render.wav
+//   ./HostRender --voices 300 --seconds 30 --wave saw            (benchmark, no file)
+//   ./HostRender --mode i2s --seconds 2                          (real-time shimmed I2S)
+//
+// Built by tools/Host/CMakeLists.txt. The "cycles" reported by the shim are nanoseconds
+// of a nominal 1000 MHz core, so every figure below is wall-clock time on this machine.
+
+#include "ESP32Synth.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+
+static ESP32Synth synth;
+
+// ====================================================================================
+//    Test material (generated, so the host build needs no data files)
+// ====================================================================================
+
+#define HOST_WT_SIZE     2048
+#define HOST_WT_SMALL    256  // For the interpolated-wavetable comparison
+#define HOST_SAMPLE_LEN  24000
+#define HOST_MIP_HARM    64   // Mipmapped saw: 64 harmonics at level 0, halved per level
+#define HOST_MIP_LEVELS  7
+
+static int16_t hostWavetable16[HOST_WT_SIZE];
+static uint8_t hostWavetable8[HOST_WT_SIZE];
+static uint8_t hostWavetable4[HOST_WT_SIZE / 2];
+static int16_t hostWavetableSmall[HOST_WT_SMALL];
+static int16_t hostSample16[HOST_SAMPLE_LEN];
+static int16_t hostMipData[HOST_MIP_LEVELS][4 * HOST_MIP_HARM];
+static const void* hostMipLevels[HOST_MIP_LEVELS];
+static uint32_t hostMipSizes[HOST_MIP_LEVELS];
+static WavetableMip hostMip;
+
+static void buildTestMaterial() {
+    // Wavetable: first 8 harmonics of a saw
+    for (int i = 0; i < HOST_WT_SIZE; i++) {
+        double x = (2.0 * M_PI * i) / HOST_WT_SIZE;
+        double v = 0.0;
+        for (int h = 1; h <= 8; h++) v += sin(x * h) / h;
+        int16_t s = (int16_t)(v * 0.55 * 32767.0);
+        hostWavetable16[i] = s;
+        hostWavetable8[i]  = (uint8_t)((s >> 8) + 128);
+        uint8_t nib = (uint8_t)(((s >> 12) + 8) & 0x0F);
+        if (i & 1) hostWavetable4[i >> 1] |= (uint8_t)(nib << 4);
+        else       hostWavetable4[i >> 1]  = nib;
+        if (i % (HOST_WT_SIZE / HOST_WT_SMALL) == 0) hostWavetableSmall[i / (HOST_WT_SIZE / HOST_WT_SMALL)] = s;
+    }
+
+    // Mipmap: level L keeps HOST_MIP_HARM >> L harmonics in >= 4 entries per top-harmonic cycle
+    for (int l = 0; l < HOST_MIP_LEVELS; l++) {
+        int harm = HOST_MIP_HARM >> l;
+        int size = (4 * harm > 64) ? 4 * harm : 64;
+        for (int i = 0; i < size; i++) {
+            double x = (2.0 * M_PI * i) / size;
+            double v = 0.0;
+            for (int h = 1; h <= harm; h++) v += sin(x * h) / h;
+            hostMipData[l][i] = (int16_t)(v * 0.5 * 32767.0);
+        }
+        hostMipLevels[l] = hostMipData[l];
+        hostMipSizes[l]  = size;
+    }
+    hostMip = { hostMipLevels, hostMipSizes, HOST_MIP_HARM, HOST_MIP_LEVELS, BITS_16 };
+
+    // Sample: half a second of a decaying, slightly inharmonic pluck at 440 Hz / 48 kHz
+    for (int i = 0; i < HOST_SAMPLE_LEN; i++) {
+        double t   = (double)i / 48000.0;
+        double env = exp(-t * 6.0);
+        double v   = sin(2.0 * M_PI * 440.0 * t) + 0.3 * sin(2.0 * M_PI * 883.0 * t);
+        hostSample16[i] = (int16_t)(v * env * 0.7 * 32767.0);
+    }
+}
+
+// ====================================================================================
+//    Patch
+// ====================================================================================
+
+static const char* WAVE_NAMES[] = { "sine", "triangle", "saw", "pulse", "noise", "wavetable", "wavetable8", "wavetable4", "sample",
+                                    "wavetable256", "wavetable256i", "sawbl", "pulsebl", "sawtable", "sawtablemip", "samplelin", "samplehermite" };
+static const int   NUM_WAVES    = sizeof(WAVE_NAMES) / sizeof(WAVE_NAMES[0]);
+// "mix" keeps cycling through the original nine, so its renders stay comparable across versions.
+static const int   NUM_MIX_WAVES = 9;
+
+static void setupVoice(uint16_t v, int waveIdx) {
+    switch (waveIdx) {
+        case 0: synth.setWave(v, WAVE_SINE);     break;
+        case 1: synth.setWave(v, WAVE_TRIANGLE); break;
+        case 2: synth.setWave(v, WAVE_SAW);      break;
+        case 3: synth.setWave(v, WAVE_PULSE); synth.setPulseWidth(v, 64 + (v % 128)); break;
+        case 4: synth.setWave(v, WAVE_NOISE);    break;
+        case 5: synth.setWave(v, WAVE_WAVETABLE); synth.setWavetable(v, hostWavetable16, HOST_WT_SIZE, BITS_16); break;
+        case 6: synth.setWave(v, WAVE_WAVETABLE); synth.setWavetable(v, hostWavetable8,  HOST_WT_SIZE, BITS_8);  break;
+        case 7: synth.setWave(v, WAVE_WAVETABLE); synth.setWavetable(v, hostWavetable4,  HOST_WT_SIZE, BITS_4);  break;
+        case 8: synth.setSample(v, 0, LOOP_FORWARD, 12000, HOST_SAMPLE_LEN); break;
+        case 9:  synth.setWave(v, WAVE_WAVETABLE); synth.setWavetable(v, hostWavetableSmall, HOST_WT_SMALL, BITS_16);       break;
+        case 10: synth.setWave(v, WAVE_WAVETABLE); synth.setWavetable(v, hostWavetableSmall, HOST_WT_SMALL, BITS_16, true); break;
+        case 11: synth.setWave(v, WAVE_SAW_BL);   break;
+        case 12: synth.setWave(v, WAVE_PULSE_BL); synth.setPulseWidth(v, 64 + (v % 128)); break;
+        case 13: synth.setWave(v, WAVE_WAVETABLE); synth.setWavetable(v, hostMipLevels[0], hostMipSizes[0], BITS_16, true); break;
+        case 14: synth.setWave(v, WAVE_WAVETABLE); synth.setWavetableMip(v, &hostMip, true); break;
+        case 15: synth.setSample(v, 0, LOOP_FORWARD, 12000, HOST_SAMPLE_LEN); synth.setSampleInterp(v, INTERP_LINEAR);  break;
+        case 16: synth.setSample(v, 0, LOOP_FORWARD, 12000, HOST_SAMPLE_LEN); synth.setSampleInterp(v, INTERP_HERMITE); break;
+    }
+    synth.setEnv(v, 5 + (v % 20), 200, 180, 150 + (v % 7) * 50);
+    if (v % 5 == 0) synth.setVibrato(v, 550, 800);
+    if (v % 7 == 0) synth.setTremolo(v, 400, 60);
+#if SYNTH_ENABLE_STEREO
+    synth.setPan(v, (int8_t)((v * 53) % 255 - 127)); // Spread the voices over the stereo field
+#endif
+}
+
+static uint32_t voiceFreq(uint16_t v, uint32_t step) {
+    // Walk a pentatonic scale over ~4 octaves so voices cover the whole table/pitch range.
+    static const uint32_t scale[] = { c3, d3, e3, g3, a3, c4, d4, e4, g4, a4, c5, d5, e5, g5, a5, c6 };
+    return scale[(v * 7 + step * 3) % (sizeof(scale) / sizeof(scale[0]))];
+}
+
+// ====================================================================================
+//    WAV output
+// ====================================================================================
+
+static void putLE(FILE* f, uint32_t v, int bytes) {
+    for (int i = 0; i < bytes; i++) fputc((v >> (8 * i)) & 0xFF, f);
+}
+
+static bool writeWav(const char* path, const std::vector<int16_t>& pcm, uint32_t sampleRate, int channels) {
+    FILE* f = fopen(path, "wb");
+    if (!f) return false;
+    uint32_t dataBytes = (uint32_t)(pcm.size() * sizeof(int16_t));
+    fwrite("RIFF", 1, 4, f); putLE(f, 36 + dataBytes, 4); fwrite("WAVE", 1, 4, f);
+    fwrite("fmt ", 1, 4, f); putLE(f, 16, 4); putLE(f, 1, 2); putLE(f, channels, 2);
+    putLE(f, sampleRate, 4); putLE(f, sampleRate * 2 * channels, 4); putLE(f, 2 * channels, 2); putLE(f, 16, 2);
+    fwrite("data", 1, 4, f); putLE(f, dataBytes, 4);
+    for (size_t i = 0; i < pcm.size(); i++) putLE(f, (uint16_t)pcm[i], 2);
+    fclose(f);
+    return true;
+}
+
+// ====================================================================================
+//    Profile report (needs a build with -DSYNTH_HOST_PROFILER=ON)
+// ====================================================================================
+
+static void printProfile(const SynthRenderProfile& p) {
+    static const char* STAGES[]  = { "control", "voices", "dsp", "master", "output", "total" };
+    static const char* KERNELS[] = { "sine", "triangle", "saw", "pulse", "noise", "saw-bl", "pulse-bl", "wavetable", "wt-lerp", "sample", "sample-int", "stream", "custom" };
+
+    if (!p.enabled) {
+        printf("profile       : compiled out (configure with -DSYNTH_HOST_PROFILER=ON)\n");
+        return;
+    }
+    printf("profile       : window #%u, %u blocks x %u samples, budget %u cycles/block, load avg %.2f%% peak %.2f%%\n",
+           (unsigned)p.windowId, (unsigned)p.blocks, (unsigned)p.samplesPerBlock, (unsigned)p.budgetCycles, p.avgLoad, p.peakLoad);
+    printf("  %-10s %12s %12s %12s\n", "stage", "min", "avg", "max");
+    for (int s = 0; s < PROF_NUM_STAGES; s++) {
+        printf("  %-10s %12u %12u %12u\n", STAGES[s], (unsigned)p.stage[s].minCycles, (unsigned)p.stage[s].avgCycles, (unsigned)p.stage[s].maxCycles);
+    }
+    printf("  %-10s %8s %12s %10s %10s %10s %10s\n", "kernel", "voices", "cyc/block", "min/voice", "avg/voice", "max/voice", "cyc/v/smp");
+    for (int k = 0; k < PROF_NUM_KERNELS; k++) {
+        const SynthKernelStat& ks = p.kernel[k];
+        if (ks.voiceRenders == 0) continue;
+        printf("  %-10s %8u %12u %10u %10u %10u %10.2f\n", KERNELS[k], (unsigned)ks.avgVoices, (unsigned)ks.avgCyclesPerBlock,
+               (unsigned)ks.perVoice.minCycles, (unsigned)ks.perVoice.avgCycles, (unsigned)ks.perVoice.maxCycles,
+               (double)ks.perVoice.avgCycles / (double)(p.samplesPerBlock ? p.samplesPerBlock : 1));
+    }
+}
+
+// ====================================================================================
+//    Main
+// ====================================================================================
+
+static void usage() {
+    printf("usage: HostRender [--voices N] [--seconds S] [--rate HZ] [--block N] [--wave NAME]\n"
+           "                  [--mode pull|i2s|i2s32|pdm|pwm|dac] [--latency playback|balanced|live] [--render-block N]\n"
+           "                  [--out FILE.wav] [--dual] [--queue] [--timed] [--filter] [--reverb] [--buses] [--profile] [--quiet]\n"
+           "  waves: mix");
+    for (int i = 0; i < NUM_WAVES; i++) printf(", %s", WAVE_NAMES[i]);
+    printf("\n  MAX_VOICES in this build: %d\n", MAX_VOICES);
+}
+
+int main(int argc, char** argv) {
+    int         voices  = 32;
+    double      seconds = 10.0;
+    uint32_t    rate    = 48000;
+    int         block   = SYNTH_DMA_BUF_LEN;
+    int         waveIdx = -1; // -1 = mix
+    const char* mode    = "pull";
+    const char* outPath = nullptr;
+    bool        quiet   = false;
+    bool        profile = false;
+    bool        dual    = false;
+    bool        queue   = false;
+    bool        timed   = false;
+    bool        filter  = false;
+    bool        reverb  = false;
+    bool        buses   = false;
+    const char* latency = nullptr;
+    int         subBlock = 0;
+
+    for (int i = 1; i < argc; i++) {
+        const char* a   = argv[i];
+        const char* val = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if      (!strcmp(a, "--voices")  && val) { voices  = atoi(val); i++; }
+        else if (!strcmp(a, "--seconds") && val) { seconds = atof(val); i++; }
+        else if (!strcmp(a, "--rate")    && val) { rate    = (uint32_t)atoi(val); i++; }
+        else if (!strcmp(a, "--block")   && val) { block   = atoi(val); i++; }
+        else if (!strcmp(a, "--mode")    && val) { mode    = val; i++; }
+        else if (!strcmp(a, "--latency") && val) { latency = val; i++; }
+        else if (!strcmp(a, "--render-block") && val) { subBlock = atoi(val); i++; }
+        else if (!strcmp(a, "--out")     && val) { outPath = val; i++; }
+        else if (!strcmp(a, "--quiet"))          { quiet   = true; }
+        else if (!strcmp(a, "--profile"))        { profile = true; }
+        else if (!strcmp(a, "--dual"))           { dual    = true; }
+        else if (!strcmp(a, "--queue"))          { queue   = true; }
+        else if (!strcmp(a, "--timed"))          { timed   = true; }
+        else if (!strcmp(a, "--filter"))         { filter  = true; }
+        else if (!strcmp(a, "--reverb"))         { reverb  = true; }
+        else if (!strcmp(a, "--buses"))          { buses   = true; }
+        else if (!strcmp(a, "--wave")    && val) {
+            waveIdx = -2;
+            if (!strcmp(val, "mix")) waveIdx = -1;
+            for (int w = 0; w < NUM_WAVES; w++) if (!strcmp(val, WAVE_NAMES[w])) waveIdx = w;
+            if (waveIdx == -2) { usage(); return 1; }
+            i++;
+        } else { usage(); return (!strcmp(a, "--help") || !strcmp(a, "-h")) ? 0 : 1; }
+    }
+
+    if (voices < 1) voices = 1;
+    if (voices > MAX_VOICES) {
+        fprintf(stderr, "warning: --voices %d exceeds MAX_VOICES (%d), clamping. Rebuild with -DSYNTH_HOST_MAX_VOICES=N.\n", voices, MAX_VOICES);
+        voices = MAX_VOICES;
+    }
+    if (block < 4) block = 4;
+
+    buildTestMaterial();
+    synth.registerSample(0, hostSample16, HOST_SAMPLE_LEN, 48000, 44000, BITS_16);
+
+    // Hardware modes only: pull mode renders whatever --block asks for.
+    if (latency || subBlock) {
+        SynthLatencyProfile lp = LATENCY_PLAYBACK;
+        if      (!latency)                     {}
+        else if (!strcmp(latency, "balanced")) lp = LATENCY_BALANCED;
+        else if (!strcmp(latency, "live"))     lp = LATENCY_LIVE;
+        else if (strcmp(latency, "playback"))  { usage(); return 1; }
+        synth.setLatencyProfile(lp);
+        if (subBlock) {
+            static const uint16_t LEN[] = { 512, 256, 128 };
+            static const uint8_t  CNT[] = { 6, 4, 2 };
+            synth.setLatency(LEN[lp], CNT[lp], (uint16_t)subBlock);
+        }
+    }
+
+    bool ok;
+    bool pull = !strcmp(mode, "pull");
+    if      (pull)                    ok = synth.beginCustom(rate, nullptr);
+    else if (!strcmp(mode, "i2s"))    ok = synth.begin(4, 15, 2, I2S_16BIT);
+    else if (!strcmp(mode, "i2s32"))  ok = synth.begin(4, 15, 2, I2S_32BIT);
+    else if (!strcmp(mode, "pdm"))    ok = synth.begin(2, SMODE_PDM, 4, -1, I2S_16BIT);
+    else if (!strcmp(mode, "pwm"))    ok = synth.begin(25, SMODE_PWM, -1, -1, I2S_16BIT);
+    else if (!strcmp(mode, "dac"))    ok = synth.begin(25);
+    else { usage(); return 1; }
+
+    if (!ok) {
+        fprintf(stderr, "error: begin() failed for mode '%s' on target %s\n", mode, synth.getChipModel());
+        return 1;
+    }
+    rate = (uint32_t)synth.getSampleRate();
+    if (dual && !synth.setDualCore(true)) {
+        fprintf(stderr, "error: dual-core rendering is not available in this build\n");
+        return 1;
+    }
+    if (queue && !synth.setCommandQueue(true)) {
+        fprintf(stderr, "error: cannot allocate the command queue\n");
+        return 1;
+    }
+    if (filter && !SYNTH_ENABLE_FILTER) {
+        fprintf(stderr, "error: the filter is not compiled in; configure with -DSYNTH_HOST_FILTER=ON\n");
+        return 1;
+    }
+
+    // The FDN reverb over the whole mix, or with --buses on the return bus, fed by the odd
+    // voices on bus 1 only
+    static SynthReverb room;
+    if (reverb) {
+        if (!room.begin(rate)) {
+            fprintf(stderr, "error: cannot allocate the reverb delay lines\n");
+            return 1;
+        }
+        room.setMix(buses ? 255 : 96, buses ? 0 : 255);
+        if (buses ? !synth.addBusEffect(SYNTH_BUS_RETURN, &room) : !synth.addEffect(&room)) {
+            fprintf(stderr, "error: cannot add the reverb\n");
+            return 1;
+        }
+    }
+    if (buses) synth.setBusSend(1, 96);
+
+    for (int v = 0; v < voices; v++) {
+        setupVoice((uint16_t)v, (waveIdx < 0) ? (v % NUM_MIX_WAVES) : waveIdx);
+        if (buses) synth.setVoiceBus((uint16_t)v, (uint8_t)(v & 1));
+        if (filter) { // Every voice through its own resonant SVF, swept by the filter envelope
+            synth.setFilter((uint16_t)v, (FilterType)(FILTER_LP + v % 3), 40000 + (v % 11) * 15000, (uint8_t)((v * 37) % 200));
+            synth.setFilterEnv((uint16_t)v, 10, 300, 80, 200, 2400);
+            synth.setFilterKeyTrack((uint16_t)v, 128);
+        }
+        synth.noteOn((uint16_t)v, voiceFreq((uint16_t)v, 0), 255 / (1 + voices / 16));
+    }
+
+    // Every 250 ms a rotating quarter of the voices is released and re-triggered a step
+    // later, so envelopes, control-rate work and retriggers are all part of the profile.
+    const uint32_t totalSamples = (uint32_t)(seconds * rate);
+    const uint32_t eventEvery   = rate / 4;
+    uint32_t       step         = 0;
+
+    std::vector<int16_t> pcm;
+    if (outPath && pull) pcm.resize(totalSamples * SYNTH_MIX_CHANNELS);
+
+    double   loadSum    = 0.0;
+    float    loadPeak   = 0.0f;
+    uint32_t loadCount  = 0;
+    int64_t  t0         = esp_timer_get_time();
+
+    if (pull) {
+        std::vector<int16_t> chunk(block * SYNTH_MIX_CHANNELS);
+        for (uint32_t pos = 0; pos < totalSamples; pos += block) {
+            if (pos / eventEvery != (pos + block) / eventEvery) {
+                step++;
+                // --timed lands the events on the exact sample instead of this block's start.
+                uint32_t at = synth.getSampleTime() + (step * eventEvery - pos);
+                synth.beginBatch();
+                for (int v = (int)(step % 4); v < voices; v += 4) {
+                    if (timed) {
+                        if (step & 1) synth.noteOffAt((uint16_t)v, at);
+                        else          synth.noteOnAt((uint16_t)v, voiceFreq((uint16_t)v, step), 255 / (1 + voices / 16), at);
+                    } else {
+                        if (step & 1) synth.noteOff((uint16_t)v);
+                        else          synth.noteOn((uint16_t)v, voiceFreq((uint16_t)v, step), 255 / (1 + voices / 16));
+                    }
+                }
+                synth.commitBatch();
+            }
+            int n = (int)((totalSamples - pos < (uint32_t)block) ? (totalSamples - pos) : (uint32_t)block);
+#if SYNTH_ENABLE_STEREO
+            synth.generateSamplesStereo(chunk.data(), n);
+#else
+            synth.generateSamples(chunk.data(), n);
+#endif
+            if (!pcm.empty()) memcpy(&pcm[pos * SYNTH_MIX_CHANNELS], chunk.data(), n * SYNTH_MIX_CHANNELS * sizeof(int16_t));
+
+            float load = synth.getCPULoad();
+            loadSum += load; loadCount++;
+            if (load > loadPeak) loadPeak = load;
+        }
+    } else {
+        // Hardware modes run in real time on the shimmed drivers; just sample the load meter.
+        int64_t endUs = t0 + (int64_t)(seconds * 1000000.0);
+        int64_t nextEventUs = t0 + 250000;
+        while (esp_timer_get_time() < endUs) {
+            vTaskDelay(pdMS_TO_TICKS(10));
+            if (esp_timer_get_time() >= nextEventUs) {
+                nextEventUs += 250000;
+                step++;
+                synth.beginBatch();
+                for (int v = (int)(step % 4); v < voices; v += 4) {
+                    if (step & 1) synth.noteOff((uint16_t)v);
+                    else          synth.noteOn((uint16_t)v, voiceFreq((uint16_t)v, step), 255 / (1 + voices / 16));
+                }
+                synth.commitBatch();
+            }
+            float load = synth.getCPULoad();
+            loadSum += load; loadCount++;
+            if (load > loadPeak) loadPeak = load;
+        }
+    }
+
+    int64_t wallUs = esp_timer_get_time() - t0;
+    SynthRenderProfile prof = synth.getRenderProfile();
+    bool  dualActive = synth.isDualCore();
+    float reverbCps  = room.getCyclesPerSample();
+    synth.end();
+
+    double audioSec  = (double)totalSamples / rate;
+    double nsPerSmp  = (wallUs * 1000.0) / (double)totalSamples;
+    if (!quiet) {
+        printf("target        : %s (host)\n", synth.getChipModel());
+        if (pull) printf("mode          : %s @ %u Hz, block %d\n", mode, (unsigned)rate, block);
+        else      printf("mode          : %s @ %u Hz, DMA latency %.2f ms\n", mode, (unsigned)rate, synth.getLatencyUs() / 1000.0);
+        printf("voices        : %d (%s), MAX_VOICES %d%s\n", voices, (waveIdx < 0) ? "mix" : WAVE_NAMES[waveIdx], MAX_VOICES,
+               dualActive ? ", dual-core" : "");
+        printf("audio         : %.2f s\n", audioSec);
+        printf("wall          : %.2f ms\n", wallUs / 1000.0);
+    }
+    if (pull) {
+        printf("realtime      : %.1fx\n", (audioSec * 1e6) / (double)wallUs);
+        printf("ns/sample     : %.1f\n", nsPerSmp);
+        printf("ns/voice/smp  : %.2f\n", nsPerSmp / voices);
+    }
+    printf("cpu load      : avg %.2f%%  peak %.2f%%  (of a %lu MHz host core)\n",
+           loadCount ? loadSum / loadCount : 0.0, loadPeak, SYNTH_HOST_CPU_FREQ_HZ / 1000000UL);
+    if (reverb) printf("reverb        : %.1f cycles/sample\n", reverbCps);
+
+    if (profile) printProfile(prof);
+
+    if (outPath) {
+        if (!pull) {
+            fprintf(stderr, "warning: --out is only supported in pull mode\n");
+        } else if (!writeWav(outPath, pcm, rate, SYNTH_MIX_CHANNELS)) {
+            fprintf(stderr, "error: cannot write %s\n", outPath);
+            return 1;
+        } else if (!quiet) {
+            printf("wrote         : %s\n", outPath);
+        }
+    }
+    return 0;
+}
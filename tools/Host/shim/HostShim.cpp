@@ -0,0 +1,425 @@
+// HostShim.cpp - pthread / libc implementation of the ESP-IDF surface declared in HostShim.h.
+
+#include "HostShim.h"
+
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <errno.h>
+#include <atomic>
+
+// ====================================================================================
+//    Time
+// ====================================================================================
+
+static uint64_t hostNowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void hostSleepNs(uint64_t ns) {
+    struct timespec ts;
+    ts.tv_sec  = (time_t)(ns / 1000000000ULL);
+    ts.tv_nsec = (long)(ns % 1000000000ULL);
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) { }
+}
+
+int64_t esp_timer_get_time() {
+    return (int64_t)(hostNowNs() / 1000ULL);
+}
+
+void esp_rom_delay_us(uint32_t us) {
+    hostSleepNs((uint64_t)us * 1000ULL);
+}
+
+uint32_t esp_cpu_get_cycle_count() {
+    // Wraps every ~4.29 s exactly like the 32-bit CCOUNT register; only deltas are meaningful.
+    return (uint32_t)hostNowNs();
+}
+
+int esp_clk_cpu_freq() {
+    return (int)SYNTH_HOST_CPU_FREQ_HZ;
+}
+
+// ====================================================================================
+//    Tasks & Semaphores
+// ====================================================================================
+
+struct SynthHostTask {
+    pthread_t      thread;
+    TaskFunction_t fn;
+    void*          param;
+};
+
+static thread_local SynthHostTask* hostCurrentTask = nullptr;
+
+static void* hostTaskEntry(void* arg) {
+    SynthHostTask* task = (SynthHostTask*)arg;
+    hostCurrentTask = task;
+    task->fn(task->param);
+    delete task;
+    return nullptr;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stackDepth, void* param,
+                                   UBaseType_t priority, TaskHandle_t* outHandle, BaseType_t coreId) {
+    (void)name; (void)stackDepth; (void)priority; (void)coreId;
+
+    SynthHostTask* task = new SynthHostTask();
+    task->fn    = fn;
+    task->param = param;
+
+    // The handle must be visible before the task body runs, as on FreeRTOS.
+    if (outHandle) *outHandle = task;
+
+    if (pthread_create(&task->thread, nullptr, hostTaskEntry, task) != 0) {
+        if (outHandle) *outHandle = nullptr;
+        delete task;
+        return pdFAIL;
+    }
+    pthread_detach(task->thread);
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    // The engine only ever deletes itself (vTaskDelete(NULL)) at the end of a task body.
+    (void)task;
+    delete hostCurrentTask;
+    hostCurrentTask = nullptr;
+    pthread_exit(nullptr);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+    // Threads not started through xTaskCreatePinnedToCore (e.g. main) still get a unique handle.
+    static thread_local SynthHostTask foreignTask = {};
+    return hostCurrentTask ? hostCurrentTask : &foreignTask;
+}
+
+void vTaskDelay(TickType_t ticks) {
+    hostSleepNs((uint64_t)ticks * (1000000000ULL / configTICK_RATE_HZ));
+}
+
+struct SynthHostSemaphore {
+    pthread_mutex_t mutex;
+    pthread_cond_t  cond;
+    bool            given;
+};
+
+SemaphoreHandle_t xSemaphoreCreateBinary() {
+    SynthHostSemaphore* sem = new SynthHostSemaphore();
+    pthread_mutex_init(&sem->mutex, nullptr);
+    pthread_cond_init(&sem->cond, nullptr);
+    sem->given = false;
+    return sem;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem) {
+    if (!sem) return;
+    pthread_cond_destroy(&sem->cond);
+    pthread_mutex_destroy(&sem->mutex);
+    delete sem;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) {
+    if (!sem) return pdFALSE;
+    pthread_mutex_lock(&sem->mutex);
+    bool wasGiven = sem->given;
+    sem->given = true;
+    pthread_cond_signal(&sem->cond);
+    pthread_mutex_unlock(&sem->mutex);
+    return wasGiven ? pdFALSE : pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t sem, BaseType_t* higherPriorityTaskWoken) {
+    if (higherPriorityTaskWoken) *higherPriorityTaskWoken = pdFALSE;
+    return xSemaphoreGive(sem);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks) {
+    if (!sem) return pdFALSE;
+    pthread_mutex_lock(&sem->mutex);
+    if (ticks == portMAX_DELAY) {
+        while (!sem->given) pthread_cond_wait(&sem->cond, &sem->mutex);
+    } else {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        uint64_t ns = (uint64_t)deadline.tv_nsec + (uint64_t)ticks * (1000000000ULL / configTICK_RATE_HZ);
+        deadline.tv_sec  += (time_t)(ns / 1000000000ULL);
+        deadline.tv_nsec  = (long)(ns % 1000000000ULL);
+        while (!sem->given) {
+            if (pthread_cond_timedwait(&sem->cond, &sem->mutex, &deadline) == ETIMEDOUT) break;
+        }
+    }
+    bool taken = sem->given;
+    sem->given = false;
+    pthread_mutex_unlock(&sem->mutex);
+    return taken ? pdTRUE : pdFALSE;
+}
+
+// ====================================================================================
+//    Heap
+// ====================================================================================
+
+void* heap_caps_malloc(size_t size, uint32_t caps) {
+    (void)caps;
+    return malloc(size);
+}
+
+void* heap_caps_calloc(size_t n, size_t size, uint32_t caps) {
+    (void)caps;
+    return calloc(n, size);
+}
+
+void* heap_caps_aligned_alloc(size_t alignment, size_t size, uint32_t caps) {
+    (void)caps;
+    void* ptr = nullptr;
+    if (alignment < sizeof(void*)) alignment = sizeof(void*);
+    if (posix_memalign(&ptr, alignment, size) != 0) return nullptr;
+    return ptr;
+}
+
+void heap_caps_free(void* ptr) {
+    free(ptr);
+}
+
+size_t heap_caps_get_free_size(uint32_t caps) {
+    (void)caps;
+    return (size_t)256 * 1024 * 1024;
+}
+
+// ====================================================================================
+//    GPIO
+// ====================================================================================
+
+esp_err_t gpio_reset_pin(gpio_num_t gpio) {
+    (void)gpio;
+    return ESP_OK;
+}
+
+// ====================================================================================
+//    Paced sink shared by the I2S and DAC stand-ins
+// ====================================================================================
+// Behaves like a DMA ring that drains at the configured frame rate: a write returns as
+// soon as it fits in the ring and blocks once the ring is full, just like the hardware.
+
+struct SynthHostSink {
+    uint32_t bytesPerSecond;
+    uint64_t ringBytes;
+    uint64_t startNs;
+    uint64_t bytesQueued;
+    bool     enabled;
+};
+
+static void hostSinkStart(SynthHostSink* sink) {
+    sink->startNs     = hostNowNs();
+    sink->bytesQueued = 0;
+    sink->enabled     = true;
+}
+
+static esp_err_t hostSinkWrite(SynthHostSink* sink, size_t size, size_t* written) {
+    if (written) *written = 0;
+    if (!sink->enabled || sink->bytesPerSecond == 0) return ESP_FAIL;
+
+    sink->bytesQueued += size;
+    uint64_t drained = ((hostNowNs() - sink->startNs) * sink->bytesPerSecond) / 1000000000ULL;
+    if (drained > sink->bytesQueued) { // Underrun: the ring ran dry, restart the clock.
+        sink->startNs     = hostNowNs();
+        sink->bytesQueued = size;
+        drained           = 0;
+    }
+    uint64_t pending = sink->bytesQueued - drained;
+    if (pending > sink->ringBytes) {
+        hostSleepNs(((pending - sink->ringBytes) * 1000000000ULL) / sink->bytesPerSecond);
+    }
+    if (written) *written = size;
+    return ESP_OK;
+}
+
+// ====================================================================================
+//    I2S
+// ====================================================================================
+
+struct SynthHostI2SChan {
+    SynthHostSink sink;
+    uint32_t      descNum;
+    uint32_t      frameNum;
+};
+
+esp_err_t i2s_new_channel(const i2s_chan_config_t* cfg, i2s_chan_handle_t* txHandle, i2s_chan_handle_t* rxHandle) {
+    if (!cfg || !txHandle) return ESP_FAIL;
+    SynthHostI2SChan* ch = new SynthHostI2SChan();
+    ch->descNum  = cfg->dma_desc_num;
+    ch->frameNum = cfg->dma_frame_num;
+    *txHandle = ch;
+    if (rxHandle) *rxHandle = nullptr;
+    return ESP_OK;
+}
+
+esp_err_t i2s_del_channel(i2s_chan_handle_t handle) {
+    delete handle;
+    return ESP_OK;
+}
+
+esp_err_t i2s_channel_init_std_mode(i2s_chan_handle_t handle, const i2s_std_config_t* cfg) {
+    if (!handle || !cfg) return ESP_FAIL;
+    uint32_t frameBytes = ((uint32_t)cfg->slot_cfg.data_bit_width / 8) * 2; // STD is always two slots on the wire
+    handle->sink.bytesPerSecond = cfg->clk_cfg.sample_rate_hz * frameBytes;
+    handle->sink.ringBytes      = (uint64_t)handle->descNum * handle->frameNum * frameBytes;
+    return ESP_OK;
+}
+
+esp_err_t i2s_channel_init_pdm_tx_mode(i2s_chan_handle_t handle, const i2s_pdm_tx_config_t* cfg) {
+    if (!handle || !cfg) return ESP_FAIL;
+    uint32_t frameBytes = ((uint32_t)cfg->slot_cfg.data_bit_width / 8) * (uint32_t)cfg->slot_cfg.slot_mode;
+    handle->sink.bytesPerSecond = cfg->clk_cfg.sample_rate_hz * frameBytes;
+    handle->sink.ringBytes      = (uint64_t)handle->descNum * handle->frameNum * frameBytes;
+    return ESP_OK;
+}
+
+esp_err_t i2s_channel_enable(i2s_chan_handle_t handle) {
+    if (!handle) return ESP_FAIL;
+    hostSinkStart(&handle->sink);
+    return ESP_OK;
+}
+
+esp_err_t i2s_channel_disable(i2s_chan_handle_t handle) {
+    if (!handle) return ESP_FAIL;
+    handle->sink.enabled = false;
+    return ESP_OK;
+}
+
+esp_err_t i2s_channel_write(i2s_chan_handle_t handle, const void* src, size_t size, size_t* bytesWritten, uint32_t timeoutMs) {
+    (void)src; (void)timeoutMs;
+    if (!handle) return ESP_FAIL;
+    return hostSinkWrite(&handle->sink, size, bytesWritten);
+}
+
+// ====================================================================================
+//    DAC
+// ====================================================================================
+
+struct SynthHostDac {
+    SynthHostSink sink;
+};
+
+esp_err_t dac_continuous_new_channels(const dac_continuous_config_t* cfg, dac_continuous_handle_t* handle) {
+    if (!cfg || !handle) return ESP_FAIL;
+    SynthHostDac* dac = new SynthHostDac();
+    dac->sink.bytesPerSecond = cfg->freq_hz; // One byte per conversion
+    dac->sink.ringBytes      = (uint64_t)cfg->desc_num * cfg->buf_size;
+    *handle = dac;
+    return ESP_OK;
+}
+
+esp_err_t dac_continuous_del_channels(dac_continuous_handle_t handle) {
+    delete handle;
+    return ESP_OK;
+}
+
+esp_err_t dac_continuous_enable(dac_continuous_handle_t handle) {
+    if (!handle) return ESP_FAIL;
+    hostSinkStart(&handle->sink);
+    return ESP_OK;
+}
+
+esp_err_t dac_continuous_disable(dac_continuous_handle_t handle) {
+    if (!handle) return ESP_FAIL;
+    handle->sink.enabled = false;
+    return ESP_OK;
+}
+
+esp_err_t dac_continuous_write(dac_continuous_handle_t handle, uint8_t* buf, size_t size, size_t* bytesLoaded, int timeoutMs) {
+    (void)buf; (void)timeoutMs;
+    if (!handle) return ESP_FAIL;
+    return hostSinkWrite(&handle->sink, size, bytesLoaded);
+}
+
+// ====================================================================================
+//    LEDC registers & overflow interrupt
+// ====================================================================================
+
+static std::atomic<uint32_t> hostLedcRegs[128];
+static uint32_t              hostLedcFreqHz = 0;
+
+static std::atomic<uint32_t>* hostLedcReg(uint32_t addr) {
+    return &hostLedcRegs[((addr - SYNTH_HOST_LEDC_BASE) >> 2) & 127];
+}
+
+uint32_t synth_host_reg_read(uint32_t addr) {
+    return hostLedcReg(addr)->load();
+}
+
+void synth_host_reg_write(uint32_t addr, uint32_t val) {
+    if (addr == LEDC_INT_CLR_REG) {
+        hostLedcReg(LEDC_INT_ST_REG)->fetch_and(~val);
+    } else {
+        hostLedcReg(addr)->store(val);
+    }
+}
+
+esp_err_t ledc_timer_config(const ledc_timer_config_t* cfg) {
+    if (!cfg || cfg->freq_hz == 0) return ESP_FAIL;
+    hostLedcFreqHz = cfg->freq_hz;
+    return ESP_OK;
+}
+
+esp_err_t ledc_channel_config(const ledc_channel_config_t* cfg) {
+    return cfg ? ESP_OK : ESP_FAIL;
+}
+
+struct SynthHostIntr {
+    pthread_t          thread;
+    intr_handler_t     handler;
+    void*              arg;
+    std::atomic<bool>  alive;
+};
+
+// Fires the overflow "interrupt" once per PWM period, in 1 ms bursts.
+static void* hostLedcTimerThread(void* param) {
+    SynthHostIntr* intr = (SynthHostIntr*)param;
+    const uint32_t overflowBits = LEDC_HSTIMER0_OVF_INT_ST | LEDC_LSTIMER0_OVF_INT_ST;
+    uint64_t next  = hostNowNs();
+    uint64_t fired = 0;
+    uint64_t start = next;
+
+    while (intr->alive.load()) {
+        uint64_t due = ((hostNowNs() - start) * hostLedcFreqHz) / 1000000000ULL;
+        while (fired < due && intr->alive.load()) {
+            uint32_t enabled = synth_host_reg_read(LEDC_INT_ENA_REG) & overflowBits;
+            if (enabled) {
+                hostLedcReg(LEDC_INT_ST_REG)->fetch_or(enabled);
+                intr->handler(intr->arg);
+            }
+            fired++;
+        }
+        next += 1000000ULL;
+        uint64_t now = hostNowNs();
+        if (next > now) hostSleepNs(next - now);
+    }
+    return nullptr;
+}
+
+esp_err_t esp_intr_alloc(int source, int flags, intr_handler_t handler, void* arg, intr_handle_t* retHandle) {
+    (void)flags;
+    if (source != ETS_LEDC_INTR_SOURCE || !handler || hostLedcFreqHz == 0) return ESP_FAIL;
+
+    SynthHostIntr* intr = new SynthHostIntr();
+    intr->handler = handler;
+    intr->arg     = arg;
+    intr->alive.store(true);
+    if (pthread_create(&intr->thread, nullptr, hostLedcTimerThread, intr) != 0) {
+        delete intr;
+        return ESP_FAIL;
+    }
+    if (retHandle) *retHandle = intr;
+    return ESP_OK;
+}
+
+esp_err_t esp_intr_free(intr_handle_t handle) {
+    if (!handle) return ESP_FAIL;
+    handle->alive.store(false);
+    pthread_join(handle->thread, nullptr);
+    delete handle;
+    return ESP_OK;
+}
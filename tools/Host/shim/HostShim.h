@@ -0,0 +1,252 @@
+// HostShim.h - Thin ESP-IDF / FreeRTOS stand-in for building ESP32Synth on a desktop host.
+//
+// Only the small surface ESP32Synth actually touches is provided: tasks and binary
+// semaphores on pthreads, a nanosecond "cycle counter", heap_caps_* on the libc heap,
+// and I2S / DAC / LEDC drivers that behave like a real-time sink (writes are paced
+// to the configured sample rate, the LEDC overflow ISR is fired from a timer thread).
+// Nothing in here is meant to be fast or complete - it is meant to be boring and correct.
+
+#pragma once
+#ifndef ESP32_SYNTH_HOST_SHIM_H
+#define ESP32_SYNTH_HOST_SHIM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ====================================================================================
+//    esp_err.h / esp_attr.h
+// ====================================================================================
+typedef int esp_err_t;
+#define ESP_OK   0
+#define ESP_FAIL -1
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define EXT_RAM_BSS_ATTR
+
+#ifndef BIT
+#define BIT(n) (1UL << (n))
+#endif
+
+// ====================================================================================
+//    FreeRTOS
+// ====================================================================================
+typedef int32_t  BaseType_t;
+typedef uint32_t UBaseType_t;
+typedef uint32_t TickType_t;
+typedef void (*TaskFunction_t)(void*);
+typedef struct SynthHostTask*      TaskHandle_t;
+typedef struct SynthHostSemaphore* SemaphoreHandle_t;
+
+#define pdFALSE              0
+#define pdTRUE               1
+#define pdPASS               pdTRUE
+#define pdFAIL               pdFALSE
+#define portMAX_DELAY        0xFFFFFFFFUL
+#define configTICK_RATE_HZ   1000
+#define configMAX_PRIORITIES 25
+#define portNUM_PROCESSORS   2
+#define pdMS_TO_TICKS(ms)    ((TickType_t)(ms))
+#define portYIELD_FROM_ISR() do { } while (0)
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stackDepth, void* param,
+                                   UBaseType_t priority, TaskHandle_t* outHandle, BaseType_t coreId);
+void       vTaskDelete(TaskHandle_t task);
+TaskHandle_t xTaskGetCurrentTaskHandle();
+void       vTaskDelay(TickType_t ticks);
+
+SemaphoreHandle_t xSemaphoreCreateBinary();
+void              vSemaphoreDelete(SemaphoreHandle_t sem);
+BaseType_t        xSemaphoreGive(SemaphoreHandle_t sem);
+BaseType_t        xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks);
+BaseType_t        xSemaphoreGiveFromISR(SemaphoreHandle_t sem, BaseType_t* higherPriorityTaskWoken);
+
+// ====================================================================================
+//    esp_timer / esp_rom / esp_cpu / esp_clk
+// ====================================================================================
+// The host "CPU" is a 1000 MHz core whose cycle counter is the monotonic clock in ns.
+// Every load figure the engine derives from it is therefore real wall-clock time.
+#define SYNTH_HOST_CPU_FREQ_HZ 1000000000UL
+
+int64_t  esp_timer_get_time();
+void     esp_rom_delay_us(uint32_t us);
+uint32_t esp_cpu_get_cycle_count();
+int      esp_clk_cpu_freq();
+
+// ====================================================================================
+//    esp_heap_caps.h
+// ====================================================================================
+#define MALLOC_CAP_EXEC     BIT(0)
+#define MALLOC_CAP_32BIT    BIT(1)
+#define MALLOC_CAP_8BIT     BIT(2)
+#define MALLOC_CAP_DMA      BIT(3)
+#define MALLOC_CAP_SPIRAM   BIT(10)
+#define MALLOC_CAP_INTERNAL BIT(11)
+#define MALLOC_CAP_DEFAULT  BIT(12)
+
+void*  heap_caps_malloc(size_t size, uint32_t caps);
+void*  heap_caps_calloc(size_t n, size_t size, uint32_t caps);
+void*  heap_caps_aligned_alloc(size_t alignment, size_t size, uint32_t caps);
+void   heap_caps_free(void* ptr);
+size_t heap_caps_get_free_size(uint32_t caps);
+
+// ====================================================================================
+//    driver/gpio.h
+// ====================================================================================
+typedef enum {
+    GPIO_NUM_NC  = -1,
+    GPIO_NUM_0   = 0,
+    GPIO_NUM_MAX = 49,
+} gpio_num_t;
+
+esp_err_t gpio_reset_pin(gpio_num_t gpio);
+
+// ====================================================================================
+//    driver/i2s_std.h / driver/i2s_pdm.h
+// ====================================================================================
+typedef struct SynthHostI2SChan* i2s_chan_handle_t;
+
+typedef enum { I2S_NUM_0 = 0, I2S_NUM_1 = 1, I2S_NUM_AUTO = 2 } i2s_port_t;
+typedef enum { I2S_ROLE_MASTER, I2S_ROLE_SLAVE } i2s_role_t;
+typedef enum { I2S_DATA_BIT_WIDTH_8BIT = 8, I2S_DATA_BIT_WIDTH_16BIT = 16, I2S_DATA_BIT_WIDTH_24BIT = 24, I2S_DATA_BIT_WIDTH_32BIT = 32 } i2s_data_bit_width_t;
+typedef enum { I2S_SLOT_MODE_MONO = 1, I2S_SLOT_MODE_STEREO = 2 } i2s_slot_mode_t;
+
+#define I2S_GPIO_UNUSED GPIO_NUM_NC
+
+typedef struct {
+    i2s_port_t id;
+    i2s_role_t role;
+    uint32_t   dma_desc_num;
+    uint32_t   dma_frame_num;
+    bool       auto_clear;
+} i2s_chan_config_t;
+
+#define I2S_CHANNEL_DEFAULT_CONFIG(i2s_num, i2s_role) { .id = (i2s_num), .role = (i2s_role), .dma_desc_num = 6, .dma_frame_num = 240, .auto_clear = false }
+
+typedef struct { uint32_t sample_rate_hz; } i2s_std_clk_config_t;
+typedef struct { i2s_data_bit_width_t data_bit_width; i2s_slot_mode_t slot_mode; } i2s_std_slot_config_t;
+typedef struct { gpio_num_t mclk; gpio_num_t bclk; gpio_num_t ws; gpio_num_t dout; gpio_num_t din; } i2s_std_gpio_config_t;
+typedef struct {
+    i2s_std_clk_config_t  clk_cfg;
+    i2s_std_slot_config_t slot_cfg;
+    i2s_std_gpio_config_t gpio_cfg;
+} i2s_std_config_t;
+
+typedef struct { uint32_t sample_rate_hz; } i2s_pdm_tx_clk_config_t;
+typedef struct { i2s_data_bit_width_t data_bit_width; i2s_slot_mode_t slot_mode; } i2s_pdm_tx_slot_config_t;
+typedef struct { gpio_num_t clk; gpio_num_t dout; } i2s_pdm_tx_gpio_config_t;
+typedef struct {
+    i2s_pdm_tx_clk_config_t  clk_cfg;
+    i2s_pdm_tx_slot_config_t slot_cfg;
+    i2s_pdm_tx_gpio_config_t gpio_cfg;
+} i2s_pdm_tx_config_t;
+
+#define I2S_STD_CLK_DEFAULT_CONFIG(rate)                 { .sample_rate_hz = (rate) }
+#define I2S_STD_PHILIPS_SLOT_DEFAULT_CONFIG(bits, mode)  { .data_bit_width = (bits), .slot_mode = (mode) }
+#define I2S_PDM_TX_CLK_DEFAULT_CONFIG(rate)              { .sample_rate_hz = (rate) }
+#define I2S_PDM_TX_SLOT_DEFAULT_CONFIG(bits, mode)       { .data_bit_width = (bits), .slot_mode = (mode) }
+
+esp_err_t i2s_new_channel(const i2s_chan_config_t* cfg, i2s_chan_handle_t* txHandle, i2s_chan_handle_t* rxHandle);
+esp_err_t i2s_del_channel(i2s_chan_handle_t handle);
+esp_err_t i2s_channel_init_std_mode(i2s_chan_handle_t handle, const i2s_std_config_t* cfg);
+esp_err_t i2s_channel_init_pdm_tx_mode(i2s_chan_handle_t handle, const i2s_pdm_tx_config_t* cfg);
+esp_err_t i2s_channel_enable(i2s_chan_handle_t handle);
+esp_err_t i2s_channel_disable(i2s_chan_handle_t handle);
+esp_err_t i2s_channel_write(i2s_chan_handle_t handle, const void* src, size_t size, size_t* bytesWritten, uint32_t timeoutMs);
+
+// ====================================================================================
+//    driver/dac_continuous.h (classic ESP32 / S2 only)
+// ====================================================================================
+typedef struct SynthHostDac* dac_continuous_handle_t;
+
+typedef enum { DAC_CHANNEL_MASK_CH0 = BIT(0), DAC_CHANNEL_MASK_CH1 = BIT(1), DAC_CHANNEL_MASK_ALL = BIT(0) | BIT(1) } dac_channel_mask_t;
+typedef enum { DAC_DIGI_CLK_SRC_DEFAULT = 0 } dac_continuous_digi_clk_src_t;
+typedef enum { DAC_CHANNEL_MODE_SIMUL, DAC_CHANNEL_MODE_ALTER } dac_continuous_channel_mode_t;
+
+typedef struct {
+    dac_channel_mask_t             chan_mask;
+    uint32_t                       desc_num;
+    size_t                         buf_size;
+    uint32_t                       freq_hz;
+    int8_t                         offset;
+    dac_continuous_digi_clk_src_t  clk_src;
+    dac_continuous_channel_mode_t  chan_mode;
+} dac_continuous_config_t;
+
+esp_err_t dac_continuous_new_channels(const dac_continuous_config_t* cfg, dac_continuous_handle_t* handle);
+esp_err_t dac_continuous_del_channels(dac_continuous_handle_t handle);
+esp_err_t dac_continuous_enable(dac_continuous_handle_t handle);
+esp_err_t dac_continuous_disable(dac_continuous_handle_t handle);
+esp_err_t dac_continuous_write(dac_continuous_handle_t handle, uint8_t* buf, size_t size, size_t* bytesLoaded, int timeoutMs);
+
+// ====================================================================================
+//    driver/ledc.h
+// ====================================================================================
+typedef enum { LEDC_HIGH_SPEED_MODE = 0, LEDC_LOW_SPEED_MODE = 1 } ledc_mode_t;
+typedef enum { LEDC_TIMER_10_BIT = 10 } ledc_timer_bit_t;
+typedef enum { LEDC_TIMER_0 = 0, LEDC_TIMER_1, LEDC_TIMER_2, LEDC_TIMER_3 } ledc_timer_t;
+typedef enum { LEDC_AUTO_CLK = 0, LEDC_USE_APB_CLK } ledc_clk_cfg_t;
+typedef enum { LEDC_CHANNEL_0 = 0 } ledc_channel_t;
+typedef enum { LEDC_INTR_DISABLE = 0, LEDC_INTR_FADE_END } ledc_intr_type_t;
+
+typedef struct {
+    ledc_mode_t      speed_mode;
+    ledc_timer_bit_t duty_resolution;
+    ledc_timer_t     timer_num;
+    uint32_t         freq_hz;
+    ledc_clk_cfg_t   clk_cfg;
+} ledc_timer_config_t;
+
+typedef struct {
+    int              gpio_num;
+    ledc_mode_t      speed_mode;
+    ledc_channel_t   channel;
+    ledc_intr_type_t intr_type;
+    ledc_timer_t     timer_sel;
+    uint32_t         duty;
+    int              hpoint;
+} ledc_channel_config_t;
+
+esp_err_t ledc_timer_config(const ledc_timer_config_t* cfg);
+esp_err_t ledc_channel_config(const ledc_channel_config_t* cfg);
+
+// ====================================================================================
+//    soc/ledc_reg.h - a tiny fake register file, enough for the PWM overflow ISR
+// ====================================================================================
+#define SYNTH_HOST_LEDC_BASE         0x3FF59000UL
+#define LEDC_HSCH0_CONF1_REG         (SYNTH_HOST_LEDC_BASE + 0x0C)
+#define LEDC_HSCH0_DUTY_REG          (SYNTH_HOST_LEDC_BASE + 0x08)
+#define LEDC_LSCH0_CONF0_REG         (SYNTH_HOST_LEDC_BASE + 0xA0)
+#define LEDC_LSCH0_DUTY_REG          (SYNTH_HOST_LEDC_BASE + 0xA8)
+#define LEDC_INT_ST_REG              (SYNTH_HOST_LEDC_BASE + 0x184)
+#define LEDC_INT_ENA_REG             (SYNTH_HOST_LEDC_BASE + 0x188)
+#define LEDC_INT_CLR_REG             (SYNTH_HOST_LEDC_BASE + 0x18C)
+
+#define LEDC_HSTIMER0_OVF_INT_ST     BIT(0)
+#define LEDC_HSTIMER0_OVF_INT_ENA    BIT(0)
+#define LEDC_HSTIMER0_OVF_INT_CLR    BIT(0)
+#define LEDC_LSTIMER0_OVF_INT_ST     BIT(4)
+#define LEDC_LSTIMER0_OVF_INT_ENA    BIT(4)
+#define LEDC_LSTIMER0_OVF_INT_CLR    BIT(4)
+
+uint32_t synth_host_reg_read(uint32_t addr);
+void     synth_host_reg_write(uint32_t addr, uint32_t val);
+
+#define REG_READ(addr)       synth_host_reg_read((uint32_t)(addr))
+#define REG_WRITE(addr, val) synth_host_reg_write((uint32_t)(addr), (uint32_t)(val))
+
+// ====================================================================================
+//    esp_intr_alloc.h / soc/interrupts.h
+// ====================================================================================
+typedef struct SynthHostIntr* intr_handle_t;
+typedef void (*intr_handler_t)(void* arg);
+
+#define ETS_LEDC_INTR_SOURCE 43
+#define ESP_INTR_FLAG_IRAM   BIT(10)
+
+esp_err_t esp_intr_alloc(int source, int flags, intr_handler_t handler, void* arg, intr_handle_t* retHandle);
+esp_err_t esp_intr_free(intr_handle_t handle);
+
+#endif // ESP32_SYNTH_HOST_SHIM_H
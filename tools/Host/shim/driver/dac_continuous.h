@@ -0,0 +1,3 @@
+// Host build stand-in for <driver/dac_continuous.h>. See HostShim.h.
+#pragma once
+#include "../HostShim.h"
@@ -0,0 +1,3 @@
+// Host build stand-in for <driver/i2s_pdm.h>. See HostShim.h.
+#pragma once
+#include "../HostShim.h"
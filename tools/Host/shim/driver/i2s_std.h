@@ -0,0 +1,3 @@
+// Host build stand-in for <driver/i2s_std.h>. See HostShim.h.
+#pragma once
+#include "../HostShim.h"
@@ -0,0 +1,3 @@
+// Host build stand-in for <esp_intr_alloc.h>. See HostShim.h.
+#pragma once
+#include "HostShim.h"
@@ -650,7 +650,7 @@ class MainWindow(QMainWindow):
         inst_str += "};\n\n"
 
         inst_str += f"Instrument_Sample inst_{var_name} = {{\n"
-        inst_str += f"    zonas_{var_name}, 1, {loop_mode_enum}, {loop_start_val}, {loop_end_val}\n"
+        inst_str += f"    zonas_{var_name}, 1, {loop_mode_enum}, {loop_start_val}, {loop_end_val}, INTERP_HERMITE\n"
         inst_str += "};\n\n"
         inst_str += f"// O último argumento define os bits para o ESP32Synth descomprimir instantaneamente!\n"
         inst_str += f"// synth.registerSample(0, {var_name}_data, {var_name}_len, {var_name}_rate, c4, {enum_type});\n"
@@ -25,6 +25,7 @@ TRANSLATIONS = {
         "bits_8": "8-bit (Padrão)",
         "bits_16": "16-bit (Hi-Fi)",
         "bits_4": "4-bit (Glitch/Lo-Fi)",
+        "mip_chk": "Mipmap (anti-aliasing)",
         "tab_formula": "Fórmula",
         "tab_additive": "Aditiva",
         "tab_fm": "Síntese FM",
@@ -86,6 +87,7 @@ TRANSLATIONS = {
         "bits_8": "8-bit (Standard)",
         "bits_16": "16-bit (Hi-Fi)",
         "bits_4": "4-bit (Glitch/Lo-Fi)",
+        "mip_chk": "Mipmap (anti-aliasing)",
         "tab_formula": "Formula",
         "tab_additive": "Additive",
         "tab_fm": "FM Synthesis",
@@ -560,6 +562,9 @@ class MainWindow(QMainWindow):
         self.cb_bits.addItems(["8-bit", "16-bit", "4-bit"])
         self.cb_bits.currentIndexChanged.connect(self.change_bits)
         h_layout.addWidget(self.cb_bits)
+        self.chk_mipmap = QCheckBox("Mipmap")
+        self.chk_mipmap.toggled.connect(self.update_code)
+        h_layout.addWidget(self.chk_mipmap)
         self.group_config.setLayout(h_layout)
         layout.addWidget(self.group_config)
 
@@ -913,6 +918,7 @@ class MainWindow(QMainWindow):
         self.cb_bits.setItemText(1, t["bits_16"])
         self.cb_bits.setItemText(2, t["bits_4"])
         self.cb_bits.setCurrentIndex(idx)
+        self.chk_mipmap.setText(t["mip_chk"])
         
         self.tabs.setTabText(0, t["tab_formula"])
         self.tabs.setTabText(1, t["tab_additive"])
@@ -1253,7 +1259,10 @@ class MainWindow(QMainWindow):
 
         if not is_anim_export:
             # --- LÓGICA ORIGINAL PARA EXPORTAR UMA ÚNICA ONDA ---
-            self.export_single_wavetable(name, self.processed_data, t)
+            if self.chk_mipmap.isChecked():
+                self.export_mipmap_wavetable(name, self.processed_data, t)
+            else:
+                self.export_single_wavetable(name, self.processed_data, t)
         else:
             # --- NOVA LÓGICA PARA EXPORTAR ANIMAÇÃO ---
             if self.radio_export_block.isChecked():
@@ -1335,6 +1344,60 @@ class MainWindow(QMainWindow):
         
         self.code_viewer.setPlainText(code)
 
+    def build_mip_levels(self, data_float, min_size=64):
+        """Pirâmide band-limited: cada nível guarda metade dos harmônicos do anterior (uma oitava
+        a menos) e encolhe a tabela enquanto ela tiver >= 4 amostras por ciclo do harmônico mais alto."""
+        sz = len(data_float)
+        spectrum = np.fft.rfft(data_float)
+        mags = np.abs(spectrum[1:])
+        present = np.nonzero(mags > mags.max() * 1e-4)[0] if mags.max() > 0 else []
+        harmonics = int(present[-1]) + 1 if len(present) else 1
+
+        levels = []
+        kept = harmonics
+        while True:
+            lvl_size = sz
+            while lvl_size // 2 >= max(min_size, 4 * kept):
+                lvl_size //= 2
+            spec = np.zeros(lvl_size // 2 + 1, dtype=complex)
+            spec[:kept + 1] = spectrum[:kept + 1]
+            levels.append(np.fft.irfft(spec, n=lvl_size) * (lvl_size / sz))
+            if kept <= 1:
+                break
+            kept //= 2
+
+        # Remover harmônicos gera overshoot (Gibbs): escala todos os níveis juntos para manter o volume igual.
+        peak = max(np.abs(l).max() for l in levels)
+        if peak > 1.0:
+            levels = [l / peak for l in levels]
+        return levels, harmonics
+
+    def export_mipmap_wavetable(self, name, data_to_export, t):
+        """Gera o código C++ de uma WavetableMip (uma tabela por oitava) para setWavetableMip()."""
+        bit_depth = self.current_bit_depth
+        levels, harmonics = self.build_mip_levels(np.asarray(data_to_export, dtype=float))
+
+        cpp_type = "const int16_t" if bit_depth == 16 else "const uint8_t"
+        step_type = f"BITS_{bit_depth}"
+        total = sum(len(l) for l in levels) * (2 if bit_depth == 16 else 1) // (2 if bit_depth == 4 else 1)
+
+        code = f"// Wavetable mipmap: {name}\n"
+        code += f"// Levels: {len(levels)} | Harmonics: {harmonics} | Bit Depth: {bit_depth}-bit | {total} bytes\n"
+        for i, lvl in enumerate(levels):
+            code += f"{cpp_type} wt_{name}_l{i}[] = {{\n"
+            code += self.format_cpp_array(self.quantize_frame(lvl, bit_depth), bit_depth)
+            code += "\n};\n"
+
+        code += f"\nconst void* const wt_{name}_levels[] = {{ " + ", ".join(f"wt_{name}_l{i}" for i in range(len(levels))) + " };\n"
+        code += f"const uint32_t wt_{name}_sizes[] = {{ " + ", ".join(str(len(l)) for l in levels) + " };\n"
+        code += f"const WavetableMip wt_{name}_mip = {{ wt_{name}_levels, wt_{name}_sizes, {harmonics}, {len(levels)}, {step_type} }};\n\n"
+
+        code += t["code_setup"]
+        code += f"synth.setWave(0, WAVE_WAVETABLE);\n"
+        code += f"synth.setWavetableMip(0, &wt_{name}_mip, true); // Interpolated: the smaller levels rely on it\n"
+
+        self.code_viewer.setPlainText(code)
+
     def export_animation_big_block(self, name, t):
         """Gera o código C++ para uma animação em um único array."""
         bit_depth = self.current_bit_depth